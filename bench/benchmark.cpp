@@ -0,0 +1,548 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Benchmark suite over the bundled image sets, with JSON results and a baseline comparison (make bench)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <opencv2/aruco.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "../include/aruco_tracker.h"
+#include "../include/chessboard_tracker.h"
+#include "../include/frame_source.h"
+#include "../include/harris_keypoints.h"
+#include "../include/pose_estimator.h"
+
+using namespace std;
+using namespace cv;
+
+// Same board and flags as the interactive and batch chessboard calibration
+static const Size benchChessboardPattern(9, 6);
+static const float benchChessboardSquareSize = 25; // in mm
+static const int benchCalibrationFlags =
+    CALIB_FIX_ASPECT_RATIO + CALIB_FIX_K3 + CALIB_ZERO_TANGENT_DIST + CALIB_FIX_PRINCIPAL_POINT;
+
+// operator new calls made while benchCountAllocations is set; OpenCV's own Mat buffers go through fastMalloc and
+// are not seen here
+static atomic<bool> benchCountAllocations(false);
+static atomic<long long> benchAllocations(0);
+
+void *operator new(size_t size)
+{
+    if (benchCountAllocations.load(memory_order_relaxed))
+    {
+        benchAllocations.fetch_add(1, memory_order_relaxed);
+    }
+    void *memory = malloc(size ? size : 1);
+    if (!memory)
+    {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+/**
+ * @brief Number of operator new calls made by one call of body
+ */
+static long long countAllocations(const function<void()> &body)
+{
+    benchAllocations.store(0);
+    benchCountAllocations.store(true);
+    body();
+    benchCountAllocations.store(false);
+    return benchAllocations.load();
+}
+
+/**
+ * @brief Settings of one benchmark run
+ *
+ * imageRoot - the repo's img directory
+ * threads   - OpenCV worker threads, pinned for every benchmark so runs are comparable
+ * repeats   - timed runs per benchmark; warmup runs are done first and discarded
+ * tolerance - a benchmark regresses when its median is this fraction slower than the baseline's
+ * filter    - only run benchmarks whose name contains this
+ * machine   - where the run was measured, written to the results and shown when they are used as a baseline
+ * allowMissingBaseline - warn about a missing baseline file instead of failing
+ */
+struct BenchmarkOptions
+{
+    string imageRoot;
+    int threads;
+    int repeats;
+    int warmup;
+    string output;
+    string baseline;
+    double tolerance;
+    string filter;
+    string machine;
+    bool allowMissingBaseline;
+
+    BenchmarkOptions()
+        : imageRoot("img"), threads(1), repeats(10), warmup(2), tolerance(0.10), allowMissingBaseline(false)
+    {
+    }
+};
+
+/**
+ * @brief Timings of one benchmark; items is the number of images (or views) one run processes
+ */
+struct BenchmarkResult
+{
+    string name;
+    int items;
+    vector<double> runsMs;
+    double medianMs;
+    double meanMs;
+    double minMs;
+    double maxMs;
+    double stddevMs;
+
+    BenchmarkResult() : items(0), medianMs(0), meanMs(0), minMs(0), maxMs(0), stddevMs(0)
+    {
+    }
+};
+
+/**
+ * @brief Decodes the images of a directory whose file name contains pattern (every image for "")
+ */
+static vector<Mat> loadBenchmarkImages(const string &directory, const string &pattern = "")
+{
+    ImageDirectoryFrameSource listing(directory);
+    vector<Mat> images;
+    for (size_t i = 0; i < listing.files().size(); i++)
+    {
+        const string &file = listing.files()[i];
+        if (!pattern.empty() && file.find(pattern) == string::npos)
+        {
+            continue;
+        }
+        Mat image = imread(file, IMREAD_COLOR);
+        if (!image.empty())
+        {
+            images.push_back(image);
+        }
+    }
+    return images;
+}
+
+/**
+ * @brief Runs body warmup times untimed, then repeats times timed
+ */
+static BenchmarkResult runBenchmark(const string &name, int items, const BenchmarkOptions &options,
+                                    const function<void()> &body)
+{
+    BenchmarkResult result;
+    result.name = name;
+    result.items = items;
+    for (int i = 0; i < options.warmup; i++)
+    {
+        body();
+    }
+    for (int i = 0; i < options.repeats; i++)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        body();
+        result.runsMs.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+    }
+
+    vector<double> sorted = result.runsMs;
+    sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    result.medianMs = n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+    result.minMs = sorted.front();
+    result.maxMs = sorted.back();
+    double sum = 0, sumSquared = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        sum += sorted[i];
+        sumSquared += sorted[i] * sorted[i];
+    }
+    result.meanMs = sum / n;
+    result.stddevMs = sqrt(max(0.0, sumSquared / n - result.meanMs * result.meanMs));
+
+    cout << "  " << left << setw(22) << name << right << fixed << setprecision(3) << setw(11) << result.medianMs
+         << " ms median" << setw(11) << result.minMs << " min" << setw(11) << result.maxMs << " max  ("
+         << items << " items, " << result.medianMs / max(1, items) << " ms each)" << endl;
+    cout.unsetf(ios::floatfield);
+    return result;
+}
+
+static bool selected(const BenchmarkOptions &options, const string &name)
+{
+    return options.filter.empty() || name.find(options.filter) != string::npos;
+}
+
+/**
+ * @brief Runs every workload
+ */
+static vector<BenchmarkResult> runBenchmarks(const BenchmarkOptions &options)
+{
+    vector<BenchmarkResult> results;
+    string calibrationDirectory = options.imageRoot + "/CameraCalibration";
+    vector<Mat> arucoImages = loadBenchmarkImages(calibrationDirectory, "_calibration_image");
+    vector<Mat> task3Images =
+        loadBenchmarkImages(options.imageRoot + "/task_3/second_attempt", "_calibration_image");
+    arucoImages.insert(arucoImages.end(), task3Images.begin(), task3Images.end());
+    vector<Mat> chessboardImages = loadBenchmarkImages(calibrationDirectory, "_chessboard_");
+    vector<Mat> allImages = loadBenchmarkImages(calibrationDirectory);
+
+    vector<Mat> chessboardGray(chessboardImages.size()), allGray(allImages.size());
+    for (size_t i = 0; i < chessboardImages.size(); i++)
+    {
+        cvtColor(chessboardImages[i], chessboardGray[i], COLOR_BGR2GRAY);
+    }
+    for (size_t i = 0; i < allImages.size(); i++)
+    {
+        cvtColor(allImages[i], allGray[i], COLOR_BGR2GRAY);
+    }
+    cout << "Images: " << arucoImages.size() << " ArUco, " << chessboardImages.size() << " chessboard, "
+         << allImages.size() << " in " << calibrationDirectory << endl;
+
+    // Views for the pose and calibration benchmarks, found once outside the timed runs
+    vector<vector<Point3f>> viewObjectPoints;
+    vector<vector<Point2f>> viewImagePoints;
+    Size viewImageSize;
+
+    if (!arucoImages.empty() && selected(options, "aruco_detect"))
+    {
+        ArucoTracker tracker;
+        function<void()> detectAll = [&]() {
+            for (size_t i = 0; i < arucoImages.size(); i++)
+            {
+                tracker.detect(arucoImages[i]);
+            }
+        };
+        results.push_back(runBenchmark("aruco_detect", (int)arucoImages.size(), options, detectAll));
+
+        // One more pass over images the tracker has already seen, so this is the steady state
+        long long allocations = countAllocations(detectAll);
+        cout << "  aruco_detect steady state: " << (double)allocations / arucoImages.size()
+             << " operator new calls per frame, " << tracker.bufferReallocations() << " of " << tracker.frames()
+             << " frames reallocated tracker buffers" << endl;
+    }
+
+    if (!chessboardGray.empty())
+    {
+        vector<Point3f> boardPoints;
+        for (int i = 0; i < benchChessboardPattern.height; i++)
+        {
+            for (int j = 0; j < benchChessboardPattern.width; j++)
+            {
+                boardPoints.push_back(Point3f(j * benchChessboardSquareSize, i * benchChessboardSquareSize, 0));
+            }
+        }
+        vector<Point2f> corners;
+        for (size_t i = 0; i < chessboardGray.size(); i++)
+        {
+            if (findChessboardCornersMultiScale(chessboardGray[i], benchChessboardPattern, corners))
+            {
+                viewObjectPoints.push_back(boardPoints);
+                viewImagePoints.push_back(corners);
+                viewImageSize = chessboardGray[i].size();
+            }
+        }
+
+        if (selected(options, "chessboard_detect"))
+        {
+            // findChessboardCorners plus cornerSubPix, as the stream loop runs it
+            results.push_back(runBenchmark("chessboard_detect", (int)chessboardGray.size(), options, [&]() {
+                for (size_t i = 0; i < chessboardGray.size(); i++)
+                {
+                    findChessboardCornersMultiScale(chessboardGray[i], benchChessboardPattern, corners);
+                }
+            }));
+        }
+    }
+
+    if (!allGray.empty() && selected(options, "harris"))
+    {
+        HarrisKeypointExtractor extractor;
+        vector<KeyPoint> keypoints;
+        results.push_back(runBenchmark("harris", (int)allGray.size(), options, [&]() {
+            for (size_t i = 0; i < allGray.size(); i++)
+            {
+                extractor.detect(allGray[i], keypoints);
+            }
+        }));
+    }
+
+    if (viewObjectPoints.size() < 3)
+    {
+        cerr << "Only " << viewObjectPoints.size() << " chessboard views found, skipping pose and calibration"
+             << endl;
+        return results;
+    }
+
+    Mat cameraMatrix, distCoeffs;
+    vector<Mat> rvecs, tvecs;
+    double rms = calibrateCamera(viewObjectPoints, viewImagePoints, viewImageSize, cameraMatrix, distCoeffs, rvecs,
+                                 tvecs, benchCalibrationFlags);
+    cout << "Calibrated from " << viewObjectPoints.size() << " views, reprojection error " << rms << endl;
+
+    if (selected(options, "solvepnp"))
+    {
+        Mat rvec, tvec;
+        results.push_back(runBenchmark("solvepnp", (int)viewObjectPoints.size(), options, [&]() {
+            for (size_t i = 0; i < viewObjectPoints.size(); i++)
+            {
+                solvePnP(viewObjectPoints[i], viewImagePoints[i], cameraMatrix, distCoeffs, rvec, tvec);
+            }
+        }));
+    }
+
+    if (selected(options, "pose_estimator"))
+    {
+        // Every view twice in a row: the second solve of each is warm-started, as in a stream of steady frames
+        PoseEstimator estimator;
+        Mat rvec, tvec;
+        results.push_back(runBenchmark("pose_estimator", (int)viewObjectPoints.size() * 2, options, [&]() {
+            for (size_t i = 0; i < viewObjectPoints.size(); i++)
+            {
+                estimator.reset();
+                for (int pass = 0; pass < 2; pass++)
+                {
+                    estimator.estimate(viewObjectPoints[i], viewImagePoints[i], cameraMatrix, distCoeffs, rvec, tvec);
+                }
+            }
+        }));
+    }
+
+    if (selected(options, "calibrate"))
+    {
+        results.push_back(runBenchmark("calibrate", (int)viewObjectPoints.size(), options, [&]() {
+            Mat solvedMatrix, solvedDistortion;
+            vector<Mat> solvedRvecs, solvedTvecs;
+            calibrateCamera(viewObjectPoints, viewImagePoints, viewImageSize, solvedMatrix, solvedDistortion,
+                            solvedRvecs, solvedTvecs, benchCalibrationFlags);
+        }));
+    }
+    return results;
+}
+
+/**
+ * @brief Writes the results as JSON
+ */
+static bool writeBenchmarkResults(const string &filename, const vector<BenchmarkResult> &results,
+                                  const BenchmarkOptions &options)
+{
+    FileStorage fs(filename, FileStorage::WRITE | FileStorage::FORMAT_JSON);
+    if (!fs.isOpened())
+    {
+        cerr << "Could not write " << filename << endl;
+        return false;
+    }
+    fs << "opencv_version" << CV_VERSION;
+    fs << "machine" << options.machine;
+    fs << "threads" << options.threads;
+    fs << "repeats" << options.repeats;
+    fs << "warmup" << options.warmup;
+    fs << "benchmarks"
+       << "[";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchmarkResult &r = results[i];
+        fs << "{"
+           << "name" << r.name << "items" << r.items << "median_ms" << r.medianMs << "mean_ms" << r.meanMs << "min_ms"
+           << r.minMs << "max_ms" << r.maxMs << "stddev_ms" << r.stddevMs << "runs_ms" << r.runsMs << "}";
+    }
+    fs << "]";
+    cout << "Results written to " << filename << endl;
+    return true;
+}
+
+/**
+ * @brief Compares the medians against a baseline file written by an earlier run
+ *
+ * @return the number of regressions, or -1 if the baseline cannot be used
+ */
+static int compareWithBaseline(const string &filename, const vector<BenchmarkResult> &results,
+                               const BenchmarkOptions &options)
+{
+    FileStorage fs;
+    try
+    {
+        fs.open(filename, FileStorage::READ | FileStorage::FORMAT_JSON);
+    }
+    catch (const Exception &e)
+    {
+        cerr << "Could not parse baseline " << filename << ": " << e.what() << endl;
+        return -1;
+    }
+    if (!fs.isOpened())
+    {
+        // A silently skipped comparison would let every regression through, so this is at least a loud warning
+        if (options.allowMissingBaseline)
+        {
+            cerr << "WARNING: no baseline at " << filename << ", nothing was compared. Record one on the reference "
+                 << "machine with make bench-baseline and commit it." << endl;
+            return 0;
+        }
+        cerr << "No baseline at " << filename << " (record one with make bench-baseline, or pass "
+             << "--allow-missing-baseline)" << endl;
+        return -1;
+    }
+    if ((int)fs["threads"] != options.threads)
+    {
+        cerr << "Baseline " << filename << " was recorded with " << (int)fs["threads"] << " threads, this run used "
+             << options.threads << "; not comparable" << endl;
+        return -1;
+    }
+
+    string machine = (string)fs["machine"];
+    if (machine.empty())
+    {
+        machine = "an unnamed machine";
+    }
+    cout << "Compared with " << filename << " (recorded on " << machine << ", regression above +"
+         << options.tolerance * 100 << "%):" << endl;
+    int regressions = 0;
+    FileNode benchmarks = fs["benchmarks"];
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        double baselineMs = -1;
+        for (FileNodeIterator it = benchmarks.begin(); it != benchmarks.end(); ++it)
+        {
+            if ((string)(*it)["name"] == results[i].name)
+            {
+                baselineMs = (double)(*it)["median_ms"];
+            }
+        }
+        cout << "  " << left << setw(22) << results[i].name << right;
+        if (baselineMs <= 0)
+        {
+            cout << "  not in baseline" << endl;
+            continue;
+        }
+        double change = results[i].medianMs / baselineMs - 1;
+        bool regressed = change > options.tolerance;
+        regressions += regressed ? 1 : 0;
+        cout << fixed << setprecision(3) << setw(11) << baselineMs << " -> " << setw(11) << results[i].medianMs
+             << " ms  " << showpos << setprecision(1) << change * 100 << "%" << noshowpos
+             << (regressed ? "  REGRESSION" : "") << endl;
+        cout.unsetf(ios::floatfield);
+    }
+    return regressions;
+}
+
+static void printBenchmarkUsage()
+{
+    cout << "Usage: benchmark.exe [options]\n"
+         << "  --img <dir>\t\tThe repo's img directory (default: img)\n"
+         << "  --threads <n>\t\tOpenCV threads for every benchmark (default: 1)\n"
+         << "  --repeats <n>\t\tTimed runs per benchmark (default: 10)\n"
+         << "  --warmup <n>\t\tUntimed runs before timing (default: 2)\n"
+         << "  --filter <text>\tOnly run benchmarks whose name contains text\n"
+         << "  --output <file.json>\tWrite the results\n"
+         << "  --baseline <file.json>\tCompare medians against an earlier run; exits 1 on a regression or when the\n"
+         << "\t\t\tfile is missing\n"
+         << "  --allow-missing-baseline\tOnly warn when the --baseline file does not exist yet\n"
+         << "  --machine <text>\tWhere this run was measured, stored in the results\n"
+         << "  --tolerance <f>\tAllowed slowdown before a benchmark counts as a regression (default: 0.10)\n"
+         << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "-h" || arg == "--help")
+        {
+            printBenchmarkUsage();
+            return 0;
+        }
+        if (arg == "--allow-missing-baseline")
+        {
+            options.allowMissingBaseline = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            cout << "Missing value for " << arg << endl;
+            printBenchmarkUsage();
+            return -1;
+        }
+        string value = argv[++i];
+        if (arg == "--img")
+        {
+            options.imageRoot = value;
+        }
+        else if (arg == "--threads")
+        {
+            options.threads = max(1, atoi(value.c_str()));
+        }
+        else if (arg == "--repeats")
+        {
+            options.repeats = max(1, atoi(value.c_str()));
+        }
+        else if (arg == "--warmup")
+        {
+            options.warmup = max(0, atoi(value.c_str()));
+        }
+        else if (arg == "--filter")
+        {
+            options.filter = value;
+        }
+        else if (arg == "--output")
+        {
+            options.output = value;
+        }
+        else if (arg == "--baseline")
+        {
+            options.baseline = value;
+        }
+        else if (arg == "--machine")
+        {
+            options.machine = value;
+        }
+        else if (arg == "--tolerance")
+        {
+            options.tolerance = atof(value.c_str());
+        }
+        else
+        {
+            cout << "Unknown option " << arg << endl;
+            printBenchmarkUsage();
+            return -1;
+        }
+    }
+
+    setNumThreads(options.threads);
+    cout << "Benchmarking with " << options.threads << " thread(s), " << options.warmup << " warmup and "
+         << options.repeats << " timed runs each" << endl;
+
+    vector<BenchmarkResult> results = runBenchmarks(options);
+    if (results.empty())
+    {
+        cerr << "No benchmarks ran; check --img" << endl;
+        return -1;
+    }
+    if (!options.output.empty() && !writeBenchmarkResults(options.output, results, options))
+    {
+        return -1;
+    }
+    if (!options.baseline.empty())
+    {
+        int regressions = compareWithBaseline(options.baseline, results, options);
+        if (regressions != 0)
+        {
+            cerr << (regressions > 0 ? to_string(regressions) + " regression(s)" : string("Baseline not usable"))
+                 << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
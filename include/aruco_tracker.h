@@ -0,0 +1,183 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Persistent Aruco board tracker that reuses its dictionary, board, detector and result buffers
+
+#ifndef ARUCO_TRACKER_H
+#define ARUCO_TRACKER_H
+
+#include <opencv2/aruco.hpp>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Counters for the region-of-interest tracking mode
+ *
+ * roiFrames  - frames where detection ran only inside the predicted regions
+ * roiHits    - ROI frames that found at least as many markers as the previous frame (no full search needed)
+ * fullFrames - frames that searched the full image (cadence, lost markers, or tracking disabled)
+ */
+struct RoiTrackingStats
+{
+    long long roiFrames;
+    long long roiHits;
+    long long fullFrames;
+    double roiMs;
+    double fullMs;
+
+    RoiTrackingStats() : roiFrames(0), roiHits(0), fullFrames(0), roiMs(0), fullMs(0)
+    {
+    }
+
+    double hitRate() const
+    {
+        return roiFrames > 0 ? (double)roiHits / roiFrames : 0.0;
+    }
+
+    void report() const;
+};
+
+/**
+ * @brief Detects the Aruco grid board frame after frame.
+ *
+ * The dictionary, board and detector are built once in the constructor and the corner/id buffers are reserved up
+ * front, so the tracker's own output storage is reused from frame to frame. bufferReallocations() counts the frames
+ * on which any of those buffers moved; it should stop growing once the marker count has been seen at its maximum.
+ * It says nothing about the heap as a whole: detectMarkers still allocates its own temporaries every frame (make
+ * bench prints the operator new count per frame next to aruco_detect).
+ *
+ * Holds no global state, so any number of trackers can live in one process (one per thread or per stream).
+ *
+ * With ROI tracking enabled, a frame only searches the regions around the markers found in the previous frame
+ * (grown by a motion margin). The full image is searched every fullSearchInterval frames, whenever the previous frame
+ * had no markers, and whenever the regions find fewer markers than the previous frame did.
+ */
+class ArucoTracker
+{
+  public:
+    ArucoTracker(cv::aruco::PredefinedDictionaryType dictionaryId = cv::aruco::DICT_6X6_250,
+                 cv::Size gridSize = cv::Size(5, 7), float markerLength = 10, float markerSeparation = 10,
+                 const cv::aruco::DetectorParameters &detectorParams = cv::aruco::DetectorParameters());
+
+    /**
+     * @brief Detects markers in image. Results stay valid until the next call.
+     *
+     * @return number of markers detected
+     */
+    int detect(const cv::Mat &image);
+
+    /**
+     * @brief Draws the last detection onto image
+     */
+    void draw(cv::Mat &image, bool showRejected = false) const;
+
+    const std::vector<std::vector<cv::Point2f>> &corners() const
+    {
+        return markerCorners;
+    }
+
+    const std::vector<int> &ids() const
+    {
+        return markerIds;
+    }
+
+    const std::vector<std::vector<cv::Point2f>> &rejected() const
+    {
+        return rejectedCandidates;
+    }
+
+    cv::Ptr<cv::aruco::Board> board() const
+    {
+        return arucoBoard;
+    }
+
+    const cv::aruco::Dictionary &dictionary() const
+    {
+        return dict;
+    }
+
+    void setDetectorParameters(const cv::aruco::DetectorParameters &detectorParams);
+
+    /**
+     * @brief Turns region-of-interest tracking on or off
+     *
+     * @param enabled true to search only around the previous markers
+     * @param fullSearchInterval search the full image at least once every this many frames
+     * @param motionMargin how far each marker's box is grown, as a fraction of its size
+     */
+    void setRoiTracking(bool enabled, int fullSearchInterval = 30, float motionMargin = 0.5f);
+
+    const RoiTrackingStats &roiStats() const
+    {
+        return roiTrackingStats;
+    }
+
+    /**
+     * @brief Regions searched on the last ROI frame (empty after a full search)
+     */
+    const std::vector<cv::Rect> &searchRegions() const
+    {
+        return regions;
+    }
+
+    long long frames() const
+    {
+        return frameCount;
+    }
+
+    long long bufferReallocations() const
+    {
+        return reallocationCount;
+    }
+
+  private:
+    /**
+     * @brief Remembers where every owned buffer currently lives
+     */
+    void snapshotBuffers();
+
+    /**
+     * @brief True if any owned buffer moved since the last snapshot
+     */
+    bool buffersMoved() const;
+
+    /**
+     * @brief Builds the merged, grown boxes around the current markers
+     */
+    void predictRegions(const cv::Size &imageSize);
+
+    /**
+     * @brief Runs the detector inside each predicted region and gathers the results in image coordinates
+     */
+    void detectInRegions(const cv::Mat &image);
+
+    cv::aruco::Dictionary dict;
+    cv::Ptr<cv::aruco::Board> arucoBoard;
+    cv::aruco::ArucoDetector detector;
+
+    std::vector<std::vector<cv::Point2f>> markerCorners;
+    std::vector<std::vector<cv::Point2f>> rejectedCandidates;
+    std::vector<int> markerIds;
+
+    // Buffer locations recorded before each detection
+    std::vector<const cv::Point2f *> cornerStorage;
+    std::vector<const cv::Point2f *> rejectedStorage;
+    const void *cornerOuterStorage;
+    const void *rejectedOuterStorage;
+    const int *idStorage;
+
+    long long frameCount;
+    long long reallocationCount;
+
+    // ROI tracking
+    bool roiTracking;
+    int fullSearchInterval;
+    float motionMargin;
+    int framesSinceFullSearch;
+    std::vector<cv::Rect> regions;
+    std::vector<std::vector<cv::Point2f>> regionCorners;
+    std::vector<std::vector<cv::Point2f>> regionRejected;
+    std::vector<int> regionIds;
+    RoiTrackingStats roiTrackingStats;
+};
+
+#endif
@@ -5,6 +5,8 @@
 #ifndef ARUCO_UTILS_H
 #define ARUCO_UTILS_H
 
+#include "frame_source.h"
+
 /**
  * @brief Creates a new Aruco marker and saves it to a file
  *
@@ -13,7 +15,7 @@
  */
 void createArucoMarker(int markerId = 23);
 
-int videoStreaming(std::string cameraCalibrationFile = "");
+int videoStreaming(std::string cameraCalibrationFile = "", const StreamOptions &options = StreamOptions());
 
 void createArucoBoard();
 
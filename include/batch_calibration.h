@@ -0,0 +1,118 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Offline camera calibration from a directory of recorded images, decoded and detected on all cores
+
+#ifndef BATCH_CALIBRATION_H
+#define BATCH_CALIBRATION_H
+
+#include <opencv2/aruco.hpp>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+#include "view_selection.h"
+
+enum CalibrationPattern
+{
+    PATTERN_CHESSBOARD,
+    PATTERN_ARUCO,
+    PATTERN_CHARUCO
+};
+
+/**
+ * @brief Parses "chessboard", "aruco" or "charuco"
+ *
+ * @return false for anything else
+ */
+bool parseCalibrationPattern(const std::string &name, CalibrationPattern &pattern);
+
+/**
+ * @brief Per-stage timing of a batch calibration
+ *
+ * decodeMs and detectMs are summed over every image (CPU time across workers), detectWallMs is the wall-clock time of
+ * the whole parallel decode + detect stage.
+ */
+struct BatchCalibrationTiming
+{
+    double listMs;
+    double decodeMs;
+    double detectMs;
+    double detectWallMs;
+    double selectMs;
+    double calibrateMs;
+    double writeMs;
+    int threads;
+
+    BatchCalibrationTiming()
+        : listMs(0), decodeMs(0), detectMs(0), detectWallMs(0), selectMs(0), calibrateMs(0), writeMs(0), threads(0)
+    {
+    }
+
+    void report(size_t images) const;
+};
+
+/**
+ * @brief Board points found in one image
+ *
+ * cornerIds - ChArUco corner id of every image point (ChArUco views only)
+ */
+struct CalibrationView
+{
+    std::string file;
+    cv::Size imageSize;
+    std::vector<cv::Point3f> objectPoints;
+    std::vector<cv::Point2f> imagePoints;
+    std::vector<int> cornerIds;
+};
+
+struct BatchCalibrationResult
+{
+    cv::Mat cameraMatrix;
+    cv::Mat distCoeffs;
+    std::vector<cv::Mat> rvecs;
+    std::vector<cv::Mat> tvecs;
+    double reprojectionError;
+    cv::Size imageSize;
+    std::vector<CalibrationView> views;
+    std::vector<int> selectedViews;
+    std::vector<std::string> skippedFiles;
+    BatchCalibrationTiming timing;
+
+    BatchCalibrationResult() : reprojectionError(0)
+    {
+    }
+};
+
+/**
+ * @brief Decodes every image of a directory and finds the board in it, one image per task on a work-stealing pool.
+ * Images where the board is not found (or whose size differs from the first usable image) are skipped.
+ *
+ * @param directory folder of calibration images
+ * @param pattern board to look for
+ * @param threads worker threads, 0 for one per hardware thread
+ * @param result views and skipped files are filled in, along with the list/decode/detect timing
+ * @param detectorParams marker detection settings for PATTERN_ARUCO
+ * @return number of usable views
+ */
+int detectCalibrationViews(const std::string &directory, CalibrationPattern pattern, int threads,
+                           BatchCalibrationResult &result,
+                           const cv::aruco::DetectorParameters &detectorParams = cv::aruco::DetectorParameters());
+
+/**
+ * @brief Detects the board in every image of a directory, keeps the maxViews most diverse views, calibrates, and
+ * writes the results file
+ *
+ * @param directory folder of calibration images
+ * @param pattern board to look for
+ * @param outputFile results file (same layout as the interactive chessboard calibration)
+ * @param threads worker threads, 0 for one per hardware thread
+ * @param maxViews views used in the solve, 0 for all of them
+ * @param detectorParamsFile Aruco detector parameters written by the tuner, used for PATTERN_ARUCO ("" for OpenCV's
+ *            defaults)
+ * @return 0 on success, -1 if nothing could be calibrated or the parameters file cannot be read
+ */
+int batchCalibrate(const std::string &directory, CalibrationPattern pattern, const std::string &outputFile,
+                   int threads = 0, int maxViews = defaultMaxCalibrationViews,
+                   const std::string &detectorParamsFile = "");
+
+#endif
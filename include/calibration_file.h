@@ -0,0 +1,154 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Calibration files: one loader for every XML layout the app writes, and a memory-mapped binary format
+
+#ifndef CALIBRATION_FILE_H
+#define CALIBRATION_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+const uint32_t calibrationFileVersion = 1;
+
+// Largest distortion model OpenCV uses (k1..k6, p1, p2, s1..s4, tx, ty)
+const int maxDistortionCoefficients = 14;
+
+/**
+ * @brief Fixed header at the start of a binary calibration file.
+ *
+ * Everything is stored in the writer's native byte order (little-endian on every platform we build for). The pose
+ * blocks follow at headerBytes: poseCount rotation vectors (3 floats each), then poseCount translation vectors.
+ * Readers use headerBytes rather than sizeof, so later versions can append header fields.
+ */
+struct CalibrationFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerBytes;
+    int32_t imageWidth;
+    int32_t imageHeight;
+    uint32_t distortionCount;
+    uint32_t poseCount;
+    double cameraMatrix[9];
+    double distortion[maxDistortionCoefficients];
+    double reprojectionError;
+};
+
+/**
+ * @brief Calibration results, whatever file they came from
+ *
+ * cameraMatrix is 3x3 CV_64F, distCoeffs is Nx1 CV_64F. rvecs/tvecs are the board poses of the calibration views,
+ * empty when the file has none.
+ */
+struct CalibrationData
+{
+    cv::Mat cameraMatrix;
+    cv::Mat distCoeffs;
+    cv::Size imageSize;
+    double reprojectionError;
+    std::vector<cv::Vec3f> rvecs;
+    std::vector<cv::Vec3f> tvecs;
+
+    CalibrationData() : reprojectionError(0)
+    {
+    }
+};
+
+/**
+ * @brief Read-only memory mapping of a binary calibration file. The header and pose blocks are used in place, nothing
+ * is parsed or copied.
+ */
+class MappedCalibrationFile
+{
+  public:
+    MappedCalibrationFile();
+    ~MappedCalibrationFile();
+
+    /**
+     * @brief Maps filename and validates the header and size
+     *
+     * @return false if the file cannot be opened or is not a binary calibration file
+     */
+    bool open(const std::string &filename);
+    void close();
+
+    bool isOpen() const
+    {
+        return data != 0;
+    }
+
+    const CalibrationFileHeader &header() const
+    {
+        return *(const CalibrationFileHeader *)data;
+    }
+
+    /**
+     * @brief poseCount() rotation vectors, 3 floats each
+     */
+    const float *rotations() const;
+
+    /**
+     * @brief poseCount() translation vectors, 3 floats each
+     */
+    const float *translations() const;
+
+    int poseCount() const
+    {
+        return isOpen() ? (int)header().poseCount : 0;
+    }
+
+  private:
+    MappedCalibrationFile(const MappedCalibrationFile &);
+    MappedCalibrationFile &operator=(const MappedCalibrationFile &);
+
+    const unsigned char *data;
+    size_t bytes;
+    std::vector<unsigned char> buffer;
+};
+
+/**
+ * @brief True when filename starts with the binary calibration magic
+ */
+bool isBinaryCalibrationFile(const std::string &filename);
+
+/**
+ * @brief Loads a calibration file of any supported kind:
+ *
+ * - the binary format (memory-mapped)
+ * - chessboard results (camera_matrix, dist_coeffs, frame_width, rotation_vectors, ...)
+ * - Aruco results (cameraMatrix, distCoeffs) and calibration variables (camera_matrix, aspect_ratio, ...)
+ * - OpenCV calibration sample output (distortion_coefficients, image_width, extrinsic_parameters, ...)
+ *
+ * XML, YAML and JSON are all read through FileStorage.
+ *
+ * @return false if the file cannot be read or has no camera matrix
+ */
+bool loadCalibration(const std::string &filename, CalibrationData &calibration);
+
+/**
+ * @brief Writes the binary format
+ */
+bool saveCalibrationBinary(const std::string &filename, const CalibrationData &calibration);
+
+/**
+ * @brief Writes the chessboard results layout (camera_matrix, dist_coeffs, frame_width, ...) through FileStorage
+ */
+bool saveCalibrationXml(const std::string &filename, const CalibrationData &calibration);
+
+/**
+ * @brief Writes the binary format for a .bin filename and XML/YAML through FileStorage otherwise
+ */
+bool saveCalibration(const std::string &filename, const CalibrationData &calibration);
+
+/**
+ * @brief Converts between any supported input and the format chosen by the output extension, and reports how long
+ * each file takes to load
+ *
+ * @return 0 on success
+ */
+int convertCalibrationFile(const std::string &inputFile, const std::string &outputFile);
+
+#endif
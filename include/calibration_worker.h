@@ -0,0 +1,120 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Background camera calibration that re-solves as views arrive and publishes results without locking
+
+#ifndef CALIBRATION_WORKER_H
+#define CALIBRATION_WORKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <thread>
+#include <vector>
+
+#include "view_selection.h"
+
+/**
+ * @brief One calibration result. Published snapshots are never modified, so readers can keep using one while the
+ * worker produces the next.
+ */
+struct CalibrationSnapshot
+{
+    cv::Mat cameraMatrix;
+    cv::Mat distCoeffs;
+    std::vector<cv::Mat> rvecs;
+    std::vector<cv::Mat> tvecs;
+    cv::Size imageSize;
+    double reprojectionError;
+    int views;
+    int usedViews;
+    int version;
+    double solveMs;
+
+    CalibrationSnapshot() : reprojectionError(0), views(0), usedViews(0), version(0), solveMs(0)
+    {
+    }
+};
+
+/**
+ * @brief Runs calibrateCamera on its own thread so the video loop never waits for it.
+ *
+ * Views can be added at any time. Once start() has been called and at least minViews views are stored, the worker
+ * solves; whenever more views have arrived by the time a solve finishes, it solves again with the previous intrinsics
+ * as the initial guess (CALIB_USE_INTRINSIC_GUESS), so later solves converge in a few iterations. Only the maxViews
+ * most diverse views (selectDiverseViews) go into a solve, so its cost stays flat however many frames are saved.
+ * Each result is
+ * published with an atomic shared_ptr store; the video loop polls latest() once per frame and never blocks.
+ */
+class CalibrationWorker
+{
+  public:
+    /**
+     * @param flags calibrateCamera flags for every solve (CALIB_USE_INTRINSIC_GUESS is added after the first one)
+     * @param minViews views needed before the first solve
+     * @param maxViews views used per solve, 0 for all of them
+     */
+    CalibrationWorker(int flags = 0, int minViews = 5, int maxViews = defaultMaxCalibrationViews);
+    ~CalibrationWorker();
+
+    /**
+     * @brief Stores one view (its points only, never the image). Views whose point counts do not match, or whose
+     * image size differs from the first view, are ignored.
+     *
+     * @return false if the view was ignored
+     */
+    bool addView(const std::vector<cv::Point3f> &objectPoints, const std::vector<cv::Point2f> &imagePoints,
+                 const cv::Size &imageSize);
+
+    /**
+     * @brief Starts solving: now with the views stored so far, and again whenever new views arrive
+     */
+    void start();
+
+    bool started() const;
+
+    /**
+     * @brief True while calibrateCamera is running
+     */
+    bool solving() const
+    {
+        return busy.load();
+    }
+
+    int views() const;
+
+    /**
+     * @brief Copy of the image points of every stored view, in the order they were added (for debug dumps)
+     */
+    std::vector<std::vector<cv::Point2f>> viewImagePoints() const;
+
+    /**
+     * @brief Latest published result, null until the first solve finishes
+     */
+    std::shared_ptr<const CalibrationSnapshot> latest() const
+    {
+        return std::atomic_load(&published);
+    }
+
+  private:
+    void run();
+
+    int flags;
+    int minViews;
+    int maxViews;
+    std::vector<std::vector<cv::Point3f>> objectPoints;
+    std::vector<std::vector<cv::Point2f>> imagePoints;
+    // Bytes of stored views, reported to the session memory accounting
+    long long viewBytes;
+    cv::Size imageSize;
+    bool enabled;
+    bool stopping;
+    std::atomic<bool> busy;
+    std::shared_ptr<const CalibrationSnapshot> published;
+    std::thread worker;
+    mutable std::mutex lock;
+    std::condition_variable wakeUp;
+};
+
+#endif
@@ -18,6 +18,12 @@ double calibrateCamera(cv::Mat &cameraMatrix, cv::Mat &distCoeffs, cv::Size &ima
                        std::vector<cv::Mat> &tvecs, std::vector<int> &markerIds,
                        std::vector<int> &markerCounterPerFrame, cv::Ptr<cv::aruco::Board> &board);
 
+double calibrateCameraCharuco(cv::Mat &cameraMatrix, cv::Mat &distCoeffs, const cv::Size &imageSize,
+                              const std::vector<std::vector<cv::Point2f>> &charucoCorners,
+                              const std::vector<std::vector<int>> &charucoIds,
+                              const cv::Ptr<cv::aruco::CharucoBoard> &board, std::vector<cv::Mat> &rvecs,
+                              std::vector<cv::Mat> &tvecs, int flags = 0);
+
 void readCameraParameters(cv::Mat &cameraMatrix, cv::Mat &distCoeffs, std::string filename);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,95 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Persistent ChArUco board tracker: markers plus interpolated chessboard corners from partial views
+
+#ifndef CHARUCO_TRACKER_H
+#define CHARUCO_TRACKER_H
+
+#include <opencv2/aruco.hpp>
+#include <opencv2/objdetect/charuco_detector.hpp>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Fewer interpolated corners than this constrain a calibration view too weakly to be worth keeping
+static const int minimumCharucoCorners = 6;
+
+/**
+ * @brief Detects the ChArUco board frame after frame. The defaults match img/opencv_charuco_board.png: 5x7 squares
+ * of 30 mm with 15 mm DICT_5X5_100 markers.
+ *
+ * Every chessboard corner between two detected markers is interpolated and refined, so a view with only part of the
+ * board visible still yields exactly identified corners. Unlike the Aruco grid board path, no frame has to show every
+ * marker.
+ *
+ * Holds no global state, so any number of trackers can live in one process (one per thread or per stream).
+ */
+class CharucoTracker
+{
+  public:
+    CharucoTracker(cv::aruco::PredefinedDictionaryType dictionaryId = cv::aruco::DICT_5X5_100,
+                   cv::Size squares = cv::Size(5, 7), float squareLength = 30, float markerLength = 15,
+                   const cv::aruco::DetectorParameters &detectorParams = cv::aruco::DetectorParameters());
+
+    /**
+     * @brief Detects the markers and interpolates the chessboard corners. Results stay valid until the next call.
+     *
+     * @return number of chessboard corners found
+     */
+    int detect(const cv::Mat &image);
+
+    /**
+     * @brief Draws the last detection's markers and corners onto image
+     */
+    void draw(cv::Mat &image) const;
+
+    /**
+     * @brief Board coordinates (z = 0) and image positions of the last detection's chessboard corners
+     *
+     * @return false if fewer than minimumCharucoCorners corners were found
+     */
+    bool matchPoints(std::vector<cv::Point3f> &objectPoints, std::vector<cv::Point2f> &imagePoints) const;
+
+    const std::vector<cv::Point2f> &corners() const
+    {
+        return charucoCorners;
+    }
+
+    const std::vector<int> &ids() const
+    {
+        return charucoIds;
+    }
+
+    const std::vector<std::vector<cv::Point2f>> &markerCorners() const
+    {
+        return detectedMarkerCorners;
+    }
+
+    const std::vector<int> &markerIds() const
+    {
+        return detectedMarkerIds;
+    }
+
+    cv::Ptr<cv::aruco::CharucoBoard> board() const
+    {
+        return charucoBoard;
+    }
+
+    /**
+     * @brief Chessboard corners of the whole board
+     */
+    int maxCorners() const
+    {
+        return (int)charucoBoard->getChessboardCorners().size();
+    }
+
+  private:
+    cv::aruco::Dictionary dict;
+    cv::Ptr<cv::aruco::CharucoBoard> charucoBoard;
+    cv::aruco::CharucoDetector detector;
+    std::vector<cv::Point2f> charucoCorners;
+    std::vector<int> charucoIds;
+    std::vector<std::vector<cv::Point2f>> detectedMarkerCorners;
+    std::vector<int> detectedMarkerIds;
+};
+
+#endif
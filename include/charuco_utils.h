@@ -0,0 +1,19 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: ChArUco board detection and calibration stream (img/opencv_charuco_board.png)
+
+#ifndef CHARUCO_UTILS_H
+#define CHARUCO_UTILS_H
+
+#include "frame_source.h"
+
+/**
+ * @brief Streams frames, detects the ChArUco board and calibrates from saved views in the background. Any view with
+ * at least minimumCharucoCorners interpolated corners can be saved, so the board does not have to be fully visible.
+ *
+ * @param calibrationFile calibration to start from ("" to start uncalibrated)
+ * @param options frame source, headless, frame limit, pose history/log, recording and stats settings
+ */
+int charucoDetectionAndCalibration(std::string calibrationFile, const StreamOptions &options = StreamOptions());
+
+#endif
@@ -0,0 +1,143 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Frame-to-frame chessboard corner tracking with pyramidal Lucas-Kanade optical flow
+
+#ifndef CHESSBOARD_TRACKER_H
+#define CHESSBOARD_TRACKER_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "frame_context.h"
+
+/**
+ * @brief Number of pyramid levels to drop before searching for the board, chosen so the searched image's longer side
+ * is at most 960 pixels (0 for 960p and smaller, 1 for 720p/1080p, 2 for 4K)
+ */
+int chessboardPyramidLevels(const cv::Size &imageSize);
+
+/**
+ * @brief Coarse-to-fine findChessboardCorners: searches a downsampled pyramid level, scales the corners back up and
+ * refines them with cornerSubPix on the full-resolution image. Falls back to a full-resolution search if the board
+ * is not found on the coarse level (small or distant boards).
+ *
+ * @param gray 8-bit grayscale frame
+ * @param patternSize inner corners per row and column
+ * @param corners refined corners in full-resolution coordinates
+ * @param levels pyramid levels to drop, -1 to pick from the frame size
+ * @return true when the board was found
+ */
+bool findChessboardCornersMultiScale(const cv::Mat &gray, cv::Size patternSize, std::vector<cv::Point2f> &corners,
+                                     int levels = -1);
+
+/**
+ * @brief findChessboardCornersMultiScale on a shared frame: the gray image and the coarse level come from (and stay
+ * in) the context, so other detectors on the same frame reuse them
+ */
+bool findChessboardCornersMultiScale(FrameContext &context, cv::Size patternSize, std::vector<cv::Point2f> &corners,
+                                     int levels = -1);
+
+/**
+ * @brief The original single-scale path: findChessboardCorners plus an 11x11 cornerSubPix on the full image
+ */
+bool findChessboardCornersSingleScale(const cv::Mat &gray, cv::Size patternSize, std::vector<cv::Point2f> &corners);
+
+/**
+ * @brief Counters for the chessboard tracker
+ *
+ * detectedFrames - frames that ran the full findChessboardCorners search
+ * trackedFrames  - frames whose corners came from optical flow
+ * trackingFailures - frames where optical flow lost a corner or failed the homography check
+ */
+struct ChessboardTrackingStats
+{
+    long long detectedFrames;
+    long long trackedFrames;
+    long long trackingFailures;
+    double detectMs;
+    double trackMs;
+
+    ChessboardTrackingStats() : detectedFrames(0), trackedFrames(0), trackingFailures(0), detectMs(0), trackMs(0)
+    {
+    }
+
+    void report() const;
+};
+
+/**
+ * @brief Finds the chessboard once with findChessboardCorners and then follows its corners with pyramidal
+ * Lucas-Kanade.
+ *
+ * Tracked corners are refined with the same cornerSubPix window as detected ones, so solvePnP gets input of the same
+ * quality. Each tracked frame is checked by fitting a homography from the ideal board grid to the tracked corners;
+ * if the RMS residual is above maxHomographyError pixels, or any corner was lost, the full detection runs instead.
+ * The full detection also runs every redetectInterval frames (0 disables tracking altogether).
+ */
+class ChessboardTracker
+{
+  public:
+    ChessboardTracker(cv::Size patternSize = cv::Size(9, 6), int redetectInterval = 30,
+                      double maxHomographyError = 2.0);
+
+    /**
+     * @brief Finds the board corners in gray
+     *
+     * @param gray 8-bit grayscale frame
+     * @param corners board corners in row-major order, empty when the board was not found
+     * @return true when the board was found or tracked
+     */
+    bool process(const cv::Mat &gray, std::vector<cv::Point2f> &corners);
+
+    /**
+     * @brief Same as process(gray, corners) but takes the gray frame and search level from a shared frame context
+     */
+    bool process(FrameContext &context, std::vector<cv::Point2f> &corners);
+
+    /**
+     * @brief Forgets the previous frame so the next call runs a full detection
+     */
+    void reset();
+
+    void setRedetectInterval(int interval)
+    {
+        redetectInterval = interval;
+    }
+
+    bool lastFrameTracked() const
+    {
+        return wasTracked;
+    }
+
+    const ChessboardTrackingStats &stats() const
+    {
+        return trackingStats;
+    }
+
+  private:
+    bool processFrame(const cv::Mat &gray, FrameContext *context, std::vector<cv::Point2f> &corners);
+    bool detect(const cv::Mat &gray, FrameContext *context, std::vector<cv::Point2f> &corners);
+    bool track(const cv::Mat &gray, std::vector<cv::Point2f> &corners);
+
+    /**
+     * @brief RMS distance between the corners and the ideal grid mapped through the best-fit homography
+     */
+    double homographyResidual(const std::vector<cv::Point2f> &corners);
+
+    cv::Size patternSize;
+    int redetectInterval;
+    double maxHomographyError;
+
+    std::vector<cv::Point2f> gridPoints;
+    std::vector<cv::Point2f> projectedGrid;
+    std::vector<cv::Point2f> previousCorners;
+    std::vector<cv::Mat> previousPyramid;
+    std::vector<cv::Mat> currentPyramid;
+    std::vector<uchar> status;
+    std::vector<float> errors;
+    bool hasPrevious;
+    bool wasTracked;
+    int framesSinceDetection;
+    ChessboardTrackingStats trackingStats;
+};
+
+#endif
@@ -5,8 +5,14 @@
 #ifndef CHESSBOARD_UTILS_H
 #define CHESSBOARD_UTILS_H
 
-int chessboardDetectionAndCalibration(std::string calibrationFile);
+#include "frame_source.h"
+
+int chessboardDetectionAndCalibration(std::string calibrationFile, const StreamOptions &options = StreamOptions());
 
 void generateChessBoardImage();
 
+int benchmarkChessboardDetection(std::string directory, int repeats = 5);
+
+int benchmarkPoseEstimation(std::string source, std::string calibrationFile = "", int maxFrames = 0);
+
 #endif
\ No newline at end of file
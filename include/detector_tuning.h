@@ -0,0 +1,43 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Offline search over Aruco DetectorParameters for the best detection time vs. recall/accuracy trade-off
+
+#ifndef DETECTOR_TUNING_H
+#define DETECTOR_TUNING_H
+
+#include <opencv2/aruco.hpp>
+#include <string>
+
+/**
+ * @brief Reads Aruco detector parameters from an XML/YAML file written by saveDetectorParameters (or by hand; missing
+ * fields keep their defaults)
+ *
+ * @return false if the file cannot be opened or holds no parameters
+ */
+bool loadDetectorParameters(const std::string &filename, cv::aruco::DetectorParameters &params);
+
+bool saveDetectorParameters(const std::string &filename, const cv::aruco::DetectorParameters &params,
+                            const std::string &comment = "");
+
+/**
+ * @brief Replays a directory of images through every combination of a parameter grid (adaptive threshold window
+ * sweep, minMarkerPerimeterRate, corner refinement method, perspectiveRemovePixelPerCell) and prints the Pareto front
+ * of detection time against recall and deviation from the reference corners.
+ *
+ * Recall and deviation are measured against a reference detection with the most thorough settings of the grid. The
+ * reference refines corners with SUBPIX, so the deviation is agreement with SUBPIX, not ground-truth accuracy.
+ * Each combination runs as one task on a work-stealing pool with OpenCV's own threading off, so the times are
+ * single-thread times. The fastest front entry whose recall is at least minRecall and whose deviation is at most
+ * maxRefDeviation is written to outputFile; a faster entry it was preferred over is reported as the trade-off.
+ *
+ * @param directory folder of recorded images showing the Aruco board
+ * @param outputFile parameters file for --detector-params
+ * @param threads worker threads, 0 for one per hardware thread
+ * @param minRecall fraction of the reference markers the chosen parameters must find
+ * @param maxRefDeviation mean distance in pixels the chosen parameters' corners may lie from the reference corners
+ * @return 0 on success
+ */
+int tuneDetectorParameters(const std::string &directory, const std::string &outputFile, int threads = 0,
+                           double minRecall = 0.99, double maxRefDeviation = 0.5);
+
+#endif
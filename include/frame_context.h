@@ -0,0 +1,99 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Per-frame cache of derived images (gray, pyramid levels, blurred gray) shared by every detector
+
+#ifndef FRAME_CONTEXT_H
+#define FRAME_CONTEXT_H
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief How often derived images were asked for and how often they had to be computed
+ */
+struct FrameContextStats
+{
+    long long frames;
+    long long requests;
+    long long computations;
+    double computeMs;
+
+    FrameContextStats() : frames(0), requests(0), computations(0), computeMs(0)
+    {
+    }
+
+    void report() const;
+};
+
+/**
+ * @brief One captured frame and the images derived from it. Each derived image is computed on first use and then
+ * shared, so detectors that all need the gray frame (or the same pyramid level) pay for it once per frame.
+ *
+ * Any number of threads may ask for derived images of the current frame at the same time; the first one computes,
+ * the others wait for it. The returned references stay valid until the next reset(). reset() must not be called
+ * while another thread is still using the context. Buffers are reused from frame to frame, so a steady stream of
+ * same-sized frames allocates nothing.
+ */
+class FrameContext
+{
+  public:
+    // Pyramid levels that can be cached (level 0 is the gray frame itself)
+    static const int maxPyramidLevels = 8;
+
+    FrameContext();
+
+    /**
+     * @brief Starts a new frame and forgets everything derived from the previous one
+     *
+     * @param frame BGR (or already gray) frame; referenced, not copied
+     */
+    void reset(const cv::Mat &frame);
+
+    const cv::Mat &image() const
+    {
+        return frame;
+    }
+
+    /**
+     * @brief 8-bit gray version of the frame
+     */
+    const cv::Mat &gray();
+
+    /**
+     * @brief Gray frame downsampled level times with pyrDown (0 = gray(), clamped to maxPyramidLevels - 1)
+     */
+    const cv::Mat &pyramidLevel(int level);
+
+    /**
+     * @brief Gray frame smoothed with a kernelSize x kernelSize Gaussian
+     */
+    const cv::Mat &blurred(int kernelSize);
+
+    FrameContextStats stats() const;
+
+  private:
+    FrameContext(const FrameContext &);
+    FrameContext &operator=(const FrameContext &);
+
+    void countRequest(bool computed, double ms);
+
+    cv::Mat frame;
+    std::mutex grayLock;
+    bool hasGray;
+    cv::Mat grayFrame;
+    std::mutex pyramidLock;
+    int pyramidLevels;
+    cv::Mat pyramid[maxPyramidLevels];
+    std::mutex blurLock;
+    // Entries are kept across frames so their buffers are reused; valid marks the ones computed for this frame
+    std::map<int, cv::Mat> blurredFrames;
+    std::map<int, bool> blurValid;
+    std::atomic<long long> frameCount;
+    std::atomic<long long> requestCount;
+    std::atomic<long long> computationCount;
+    std::atomic<long long> computeMicros;
+};
+
+#endif
@@ -0,0 +1,218 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Frame sources (camera, video file, image directory, memory) and headless stream helpers
+
+#ifndef FRAME_SOURCE_H
+#define FRAME_SOURCE_H
+
+#include <chrono>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+// Largest --queue accepted; a deeper capture queue only adds latency
+const int maxQueueCapacity = 1024;
+
+/**
+ * @brief Options shared by every stream loop (aruco, chessboard, harris)
+ *
+ * source   - "" or a device index for a live camera, a video file, a directory of images, or "mem:<dir>" to preload
+ *            a directory into memory before the loop starts
+ * headless - skip all windows and key handling, process frames as fast as they can be decoded
+ * maxFrames - stop after this many frames (0 = until the source is exhausted)
+ * workers  - detection threads for the pipelined loop (0 = run everything on one thread)
+ * queueCapacity - frames buffered between capture and detection before the oldest is dropped
+ * roiTracking - search for Aruco markers only around last frame's markers, with a full search every
+ *            fullSearchInterval frames
+ * chessboardRedetectInterval - frames the chessboard is tracked by optical flow before findChessboardCorners runs
+ *            again (0 = run findChessboardCorners on every frame)
+ * undistort - once a calibration is available, undistort every frame with cached remap tables before detection
+ * modelFile - Wavefront OBJ model rasterized on the board instead of the wireframe overlay ("" for none)
+ * flatShading - shade the model per face instead of per vertex
+ * poseHistory - board poses kept in memory (0 = defaultPoseHistoryCapacity)
+ * poseLog  - CSV file every board pose is streamed to ("" for none)
+ * pngCompression - PNG compression level 0-9 for saved frames (-1 = OpenCV default)
+ * rawImages - save frames as uncompressed binary PPM instead of PNG/JPEG
+ * recordFile - video file the annotated stream is recorded to ("" for none)
+ * recordFps - frame rate stored in the recording
+ * stats    - time every stage of the loop and print p50/p95/p99/max per stage on exit
+ * statsFile - CSV (or JSON, by extension) file the stage times are written to ("" for none)
+ * calibrationFile - calibration shared by every stream of the multi-stream mode ("" for none)
+ * pinThreads - pin each multi-stream worker to its own core
+ * detectorParamsFile - Aruco detector parameters written by the tuner ("" for OpenCV's defaults)
+ * detector - what every stream of the multi-stream mode detects: "aruco", "chessboard" or "harris"
+ */
+struct StreamOptions
+{
+    std::string source;
+    bool headless;
+    int maxFrames;
+    int workers;
+    int queueCapacity;
+    bool roiTracking;
+    int fullSearchInterval;
+    int chessboardRedetectInterval;
+    bool undistort;
+    std::string modelFile;
+    bool flatShading;
+    int poseHistory;
+    std::string poseLog;
+    int pngCompression;
+    bool rawImages;
+    std::string recordFile;
+    double recordFps;
+    bool stats;
+    std::string statsFile;
+    std::string calibrationFile;
+    bool pinThreads;
+    std::string detectorParamsFile;
+    std::string detector;
+
+    StreamOptions()
+        : source(""), headless(false), maxFrames(0), workers(0), queueCapacity(4), roiTracking(false),
+          fullSearchInterval(30), chessboardRedetectInterval(30), undistort(false), modelFile(""), flatShading(false),
+          poseHistory(0), poseLog(""), pngCompression(-1), rawImages(false), recordFile(""), recordFps(30),
+          stats(false), statsFile(""), calibrationFile(""), pinThreads(false), detectorParamsFile(""),
+          detector("aruco")
+    {
+    }
+};
+
+/**
+ * @brief Abstract source of BGR frames for the stream loops
+ */
+class FrameSource
+{
+  public:
+    virtual ~FrameSource()
+    {
+    }
+
+    /**
+     * @brief Reads the next frame. Returns false when the source is exhausted or failed.
+     */
+    virtual bool read(cv::Mat &frame) = 0;
+
+    virtual bool isOpened() const = 0;
+
+    /**
+     * @brief True for sources that never run out (cameras)
+     */
+    virtual bool isLive() const
+    {
+        return false;
+    }
+
+    virtual std::string describe() const = 0;
+};
+
+/**
+ * @brief Live camera through VideoCapture
+ */
+class CameraFrameSource : public FrameSource
+{
+  public:
+    explicit CameraFrameSource(int deviceId = 0);
+    bool read(cv::Mat &frame);
+    bool isOpened() const;
+    bool isLive() const;
+    std::string describe() const;
+
+  private:
+    cv::VideoCapture cap;
+    int deviceId;
+};
+
+/**
+ * @brief Recorded video file through VideoCapture
+ */
+class VideoFileFrameSource : public FrameSource
+{
+  public:
+    explicit VideoFileFrameSource(const std::string &path);
+    bool read(cv::Mat &frame);
+    bool isOpened() const;
+    std::string describe() const;
+
+  private:
+    cv::VideoCapture cap;
+    std::string path;
+};
+
+/**
+ * @brief Sorted directory of still images (e.g. img/CameraCalibration), decoded one per read
+ */
+class ImageDirectoryFrameSource : public FrameSource
+{
+  public:
+    explicit ImageDirectoryFrameSource(const std::string &directory);
+    bool read(cv::Mat &frame);
+    bool isOpened() const;
+    std::string describe() const;
+
+    const std::vector<cv::String> &files() const
+    {
+        return imageFiles;
+    }
+
+  private:
+    std::string directory;
+    std::vector<cv::String> imageFiles;
+    size_t nextIndex;
+};
+
+/**
+ * @brief Frames that are already in memory, either decoded Mats or one raw pixel buffer holding consecutive frames
+ */
+class MemoryFrameSource : public FrameSource
+{
+  public:
+    explicit MemoryFrameSource(const std::vector<cv::Mat> &frames);
+    MemoryFrameSource(const unsigned char *data, int width, int height, int type, size_t step, int frameCount);
+    bool read(cv::Mat &frame);
+    bool isOpened() const;
+    std::string describe() const;
+
+  private:
+    std::vector<cv::Mat> frames;
+    size_t nextIndex;
+};
+
+/**
+ * @brief Opens the frame source described by spec (see StreamOptions::source)
+ */
+cv::Ptr<FrameSource> openFrameSource(const std::string &spec);
+
+/**
+ * @brief Counts frames and reports the throughput of a stream loop
+ */
+class FrameRateCounter
+{
+  public:
+    FrameRateCounter();
+    void start();
+    void tick();
+    int frames() const;
+    double elapsedSeconds() const;
+    double fps() const;
+    void report(const std::string &label) const;
+
+  private:
+    std::chrono::steady_clock::time_point startTime;
+    int frameCount;
+};
+
+/**
+ * @brief Shows a frame and polls the keyboard, or does nothing in headless mode
+ *
+ * @return The key pressed, or -1 when no key was pressed (always -1 when headless)
+ */
+char presentFrame(const std::string &windowName, const cv::Mat &image, const StreamOptions &options,
+                  int delay = 10);
+
+/**
+ * @brief True once the loop has processed options.maxFrames frames
+ */
+bool frameLimitReached(const FrameRateCounter &counter, const StreamOptions &options);
+
+#endif
@@ -0,0 +1,150 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Background writer for saved frames and recorded video, so encoding and disk I/O stay off the frame loop
+
+#ifndef FRAME_WRITER_H
+#define FRAME_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frame_source.h"
+
+/**
+ * @brief Counters for the frame writer
+ *
+ * imagesDropped / framesDropped - submitted while the queue was full, so never written
+ * imagesFailed - imwrite reported an error
+ */
+struct FrameWriterStats
+{
+    long long imagesQueued;
+    long long imagesWritten;
+    long long imagesDropped;
+    long long imagesFailed;
+    long long framesRecorded;
+    long long framesDropped;
+    double encodeMs;
+    double recordMs;
+
+    FrameWriterStats()
+        : imagesQueued(0), imagesWritten(0), imagesDropped(0), imagesFailed(0), framesRecorded(0), framesDropped(0),
+          encodeMs(0), recordMs(0)
+    {
+    }
+
+    void report() const;
+};
+
+/**
+ * @brief Writes images and records video on background threads.
+ *
+ * saveImage and record copy the frame into a bounded queue and return at once; when a queue is full the frame is
+ * dropped (and counted) rather than stalling the caller. Images are encoded by a small pool of encoder threads, so
+ * several saves can be in flight; video frames go through one recorder thread that owns the VideoWriter, which keeps
+ * them in order. The threads are started on first use and drained and joined by flush() or the destructor, so a
+ * writer can be a global.
+ */
+class FrameWriter
+{
+  public:
+    /**
+     * @param encoders image encoder threads
+     * @param queueCapacity images (and, separately, video frames) that may wait before new ones are dropped
+     */
+    explicit FrameWriter(int encoders = 2, int queueCapacity = 8);
+    ~FrameWriter();
+
+    /**
+     * @brief PNG compression level 0-9 (0 stores the pixels uncompressed, fastest); -1 for the OpenCV default
+     */
+    void setPngCompression(int level);
+
+    /**
+     * @brief Writes images as binary PPM (a header plus the raw pixels, nothing to encode) instead of the format of
+     * the file name's extension
+     */
+    void setRawImages(bool raw);
+
+    /**
+     * @brief Queues image to be written to filename
+     *
+     * @return the file name that will be written (the extension becomes .ppm for raw images), or "" if the queue was
+     * full and the image was dropped
+     */
+    std::string saveImage(const std::string &filename, const cv::Mat &image);
+
+    /**
+     * @brief Starts recording to a video file; the writer is opened with the first frame's size. The codec follows the
+     * extension: MJPG for .avi, mp4v for .mp4 and .mov.
+     *
+     * @param filename video file
+     * @param fps frame rate stored in the file
+     */
+    void startRecording(const std::string &filename, double fps = 30);
+
+    /**
+     * @brief Queues a frame for the recording; does nothing when not recording
+     *
+     * @return false if the frame was dropped
+     */
+    bool record(const cv::Mat &frame);
+
+    /**
+     * @brief Finishes the recording after the queued frames have been written
+     */
+    void stopRecording();
+
+    bool recording() const
+    {
+        return !recordFile.empty();
+    }
+
+    /**
+     * @brief Blocks until every queued image and video frame has been written, then stops the threads
+     */
+    void flush();
+
+    FrameWriterStats stats();
+
+  private:
+    FrameWriter(const FrameWriter &);
+    FrameWriter &operator=(const FrameWriter &);
+
+    struct ImageJob
+    {
+        std::string filename;
+        cv::Mat image;
+    };
+
+    void encoderLoop();
+    void recorderLoop(std::string filename, double fps);
+
+    int encoderCount;
+    size_t queueCapacity;
+    std::vector<int> imageParams;
+    bool rawImages;
+    std::string recordFile;
+
+    std::mutex lock;
+    std::condition_variable workReady;
+    std::deque<ImageJob> images;
+    std::deque<cv::Mat> frames;
+    bool stopping;
+    bool stopRecorder;
+    std::vector<std::thread> encoders;
+    std::thread recorder;
+    FrameWriterStats writerStats;
+};
+
+/**
+ * @brief Applies the image options (PNG compression, raw) to a writer and starts recording if options ask for it
+ */
+void configureFrameWriter(FrameWriter &writer, const StreamOptions &options);
+
+#endif
@@ -6,6 +6,19 @@
 #ifndef HARRIS_DETECTION_H
 #define HARRIS_DETECTION_H
 
-int startVideoStream(std::string calibrationFileName);
+#include "frame_source.h"
+
+int startVideoStream(std::string calibrationFileName, const StreamOptions &options = StreamOptions());
+
+/**
+ * @brief Checks the fused Harris kernel against cv::cornerHarris on a folder of images and compares its speed with
+ * the original four-pass path for every supported instruction set, then times the tiled keypoint extractor on one
+ * thread and on every core
+ *
+ * @param directory folder of images
+ * @param repeats timed runs per image
+ * @return 0 when every image matched cornerHarris
+ */
+int benchmarkHarrisKernel(std::string directory, int repeats = 20);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,81 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Fused single-pass Harris response + threshold kernel (AVX2 / SSE2 / scalar, picked at runtime)
+
+#ifndef HARRIS_KERNEL_H
+#define HARRIS_KERNEL_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief A pixel whose Harris response passed the threshold
+ */
+struct HarrisCorner
+{
+    int x;
+    int y;
+    float response;
+};
+
+enum HarrisKernelIsa
+{
+    HARRIS_ISA_AUTO,
+    HARRIS_ISA_SCALAR,
+    HARRIS_ISA_SSE2,
+    HARRIS_ISA_AVX2
+};
+
+/**
+ * @brief Harris parameters. The response matches cv::cornerHarris(gray, dst, blockSize, 3, k) on 8-bit input
+ * (3x3 Sobel, unnormalized blockSize x blockSize box filter, BORDER_REFLECT_101).
+ */
+struct HarrisKernelParams
+{
+    int blockSize;
+    float k;
+    float threshold;
+    HarrisKernelIsa isa;
+
+    HarrisKernelParams() : blockSize(2), k(0.04f), threshold(0), isa(HARRIS_ISA_AUTO)
+    {
+    }
+};
+
+/**
+ * @brief Computes the Harris response of an 8-bit grayscale image in one row-streaming pass and keeps every pixel
+ * whose response is above params.threshold.
+ *
+ * Each output row is produced from a small ring of per-row structure-tensor sums, so gradients, box filter,
+ * response and threshold test all happen while the row is still in cache. Only the passing pixels are written.
+ *
+ * @param image first pixel of the image
+ * @param width image width
+ * @param height image height
+ * @param step bytes between rows
+ * @param params block size, k, threshold and instruction set
+ * @param corners passing pixels are appended here, in row-major order
+ * @param maxResponse if not null, receives the largest response seen
+ */
+void harrisCornersFused(const unsigned char *image, int width, int height, size_t step,
+                        const HarrisKernelParams &params, std::vector<HarrisCorner> &corners, float *maxResponse = 0);
+
+/**
+ * @brief Same as harrisCornersFused, restricted to the rectangle [x, x + regionWidth) x [y, y + regionHeight).
+ * Borders are still handled against the full image, so tiles computed separately match a full-image run exactly.
+ *
+ * @param response if not null, the response of every pixel of the region is also written here (row r of the region
+ * at response + r * responseStride floats)
+ * @param responseStride floats between response rows
+ */
+void harrisCornersRegion(const unsigned char *image, int width, int height, size_t step, int x, int y,
+                         int regionWidth, int regionHeight, const HarrisKernelParams &params,
+                         std::vector<HarrisCorner> &corners, float *maxResponse = 0, float *response = 0,
+                         size_t responseStride = 0);
+
+/**
+ * @brief Instruction set the kernel uses for the requested isa on this machine ("avx2", "sse2" or "scalar")
+ */
+const char *harrisKernelIsaName(HarrisKernelIsa isa = HARRIS_ISA_AUTO);
+
+#endif
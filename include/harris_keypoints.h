@@ -0,0 +1,82 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Tiled, parallel Harris keypoint extraction with per-tile non-maximum suppression and top-K bucketing
+
+#ifndef HARRIS_KEYPOINTS_H
+#define HARRIS_KEYPOINTS_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "harris_kernel.h"
+
+/**
+ * @brief Settings for HarrisKeypointExtractor
+ *
+ * blockSize, k     - Harris neighborhood and free parameter (3x3 Sobel, as cv::cornerHarris with apertureSize 3)
+ * qualityLevel     - a keypoint's response has to be above this fraction of the frame's strongest response
+ * tileSize         - width and height of a tile in pixels
+ * maxPerTile       - strongest keypoints kept per tile
+ * nmsRadius        - a keypoint has to be the largest response in its (2 * nmsRadius + 1) square neighborhood
+ */
+struct HarrisKeypointParams
+{
+    int blockSize;
+    float k;
+    float qualityLevel;
+    int tileSize;
+    int maxPerTile;
+    int nmsRadius;
+
+    HarrisKeypointParams() : blockSize(2), k(0.04f), qualityLevel(0.01f), tileSize(64), maxPerTile(4), nmsRadius(1)
+    {
+    }
+};
+
+/**
+ * @brief Splits the frame into tiles and finds Harris keypoints in every tile in parallel.
+ *
+ * Each tile computes its response with the fused kernel (plus a nmsRadius halo, so suppression across tile edges
+ * agrees with a full-image run), keeps the local maxima and then only its maxPerTile strongest. The output is bounded
+ * by tiles * maxPerTile and spread over the whole frame, instead of clustering in the most textured region.
+ * Per-tile buffers are kept between frames.
+ */
+class HarrisKeypointExtractor
+{
+  public:
+    HarrisKeypointExtractor(const HarrisKeypointParams &params = HarrisKeypointParams());
+
+    /**
+     * @brief Finds the keypoints of an 8-bit grayscale frame
+     *
+     * @param gray 8-bit grayscale frame
+     * @param keypoints keypoints in tile order, response set to the Harris response
+     */
+    void detect(const cv::Mat &gray, std::vector<cv::KeyPoint> &keypoints);
+
+    void setParameters(const HarrisKeypointParams &params);
+
+    const HarrisKeypointParams &parameters() const
+    {
+        return params;
+    }
+
+  private:
+    struct Tile
+    {
+        cv::Rect area;
+        std::vector<float> response;
+        std::vector<HarrisCorner> candidates;
+        std::vector<HarrisCorner> unused;
+        float maxResponse;
+    };
+
+    void layoutTiles(const cv::Size &imageSize);
+    void processTile(const cv::Mat &gray, Tile &tile) const;
+
+    HarrisKeypointParams params;
+    std::vector<Tile> tiles;
+    cv::Size tiledSize;
+};
+
+#endif
@@ -0,0 +1,119 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Asynchronous leveled logger: per-thread lock-free buffers drained by a background thread
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <sstream>
+#include <string>
+
+enum LogLevel
+{
+    LOG_LEVEL_TRACE,
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_OFF
+};
+
+// Messages below this level are compiled out entirely (e.g. -DLOG_COMPILE_LEVEL=2 keeps INFO and above)
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 1
+#endif
+
+/**
+ * @brief Sets the lowest level that is written at runtime (INFO by default)
+ */
+void setLogLevel(LogLevel level);
+
+/**
+ * @brief Parses trace, debug, info, warn, error or off
+ *
+ * @return false if name is not a level
+ */
+bool parseLogLevel(const std::string &name, LogLevel &level);
+
+// Set by setLogLevel; read on every log call
+extern std::atomic<int> runtimeLogLevel;
+
+/**
+ * @brief True if a message at level would be written. One relaxed load.
+ */
+inline bool logEnabled(LogLevel level)
+{
+    return (int)level >= runtimeLogLevel.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Queues a finished message. The calling thread pushes it into its own ring buffer, without locking; the
+ * background thread writes it (INFO and below to stdout, WARN and ERROR to stderr). If the ring is full an INFO or
+ * lower message is dropped and counted rather than blocking the caller; warnings and errors are written directly.
+ */
+void logWrite(LogLevel level, const std::string &message);
+
+/**
+ * @brief Blocks until every message queued so far has been written. Call before writing to cout directly.
+ */
+void logFlush();
+
+/**
+ * @brief Per call site state of a rate-limited message
+ */
+struct LogRateLimit
+{
+    std::atomic<long long> nextMs;
+    std::atomic<long long> suppressed;
+};
+
+/**
+ * @brief True if the call site may log now (at most once per intervalMs); otherwise counts the message as suppressed
+ *
+ * @param limit the call site's state
+ * @param intervalMs minimum time between two messages
+ * @param suppressed receives the number of messages suppressed since the last one that was let through
+ */
+bool logRateAllows(LogRateLimit &limit, int intervalMs, long long &suppressed);
+
+// The message is a stream expression: LOG_INFO("Saved " << count << " views")
+#define LOG_AT(level, message)                                                                                         \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if ((int)(level) >= LOG_COMPILE_LEVEL && logEnabled(level))                                                    \
+        {                                                                                                              \
+            std::ostringstream logStream_;                                                                             \
+            logStream_ << message;                                                                                     \
+            logWrite(level, logStream_.str());                                                                         \
+        }                                                                                                              \
+    } while (0)
+
+// Logs at most once per intervalMs from this call site, noting how many messages were skipped in between
+#define LOG_EVERY_MS(level, intervalMs, message)                                                                       \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if ((int)(level) >= LOG_COMPILE_LEVEL && logEnabled(level))                                                    \
+        {                                                                                                              \
+            static LogRateLimit logLimit_ = {{0}, {0}};                                                                \
+            long long logSuppressed_ = 0;                                                                              \
+            if (logRateAllows(logLimit_, intervalMs, logSuppressed_))                                                  \
+            {                                                                                                          \
+                std::ostringstream logStream_;                                                                         \
+                logStream_ << message;                                                                                 \
+                if (logSuppressed_ > 0)                                                                                \
+                {                                                                                                      \
+                    logStream_ << " (" << logSuppressed_ << " similar messages suppressed)";                           \
+                }                                                                                                      \
+                logWrite(level, logStream_.str());                                                                     \
+            }                                                                                                          \
+        }                                                                                                              \
+    } while (0)
+
+#define LOG_TRACE(message) LOG_AT(LOG_LEVEL_TRACE, message)
+#define LOG_DEBUG(message) LOG_AT(LOG_LEVEL_DEBUG, message)
+#define LOG_INFO(message) LOG_AT(LOG_LEVEL_INFO, message)
+#define LOG_WARN(message) LOG_AT(LOG_LEVEL_WARN, message)
+#define LOG_ERROR(message) LOG_AT(LOG_LEVEL_ERROR, message)
+
+#endif
@@ -0,0 +1,20 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Combined mode that runs the Aruco, chessboard and Harris detectors concurrently on one shared frame
+
+#ifndef MULTI_DETECTOR_H
+#define MULTI_DETECTOR_H
+
+#include "frame_source.h"
+
+/**
+ * @brief Streams frames and runs Aruco marker detection, chessboard detection and Harris keypoints on every frame at
+ * the same time. The detectors share one FrameContext, so the gray frame (and the chessboard's search level) is
+ * computed once per frame however many detectors read it. On exit, reports each detector's mean cost next to the
+ * frame's detection wall time, which should sit close to the slowest detector rather than the sum.
+ *
+ * @param options frame source, headless, frame limit, recording and stats settings
+ */
+int multiDetectorStream(const StreamOptions &options = StreamOptions());
+
+#endif
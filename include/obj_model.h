@@ -0,0 +1,62 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Wavefront OBJ loading and placement of triangle meshes on a board
+
+#ifndef OBJ_MODEL_H
+#define OBJ_MODEL_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Indexed triangle mesh
+ *
+ * vertices  - positions; after placeObjModel, in board units (z < 0 is above the board)
+ * normals   - one unit normal per vertex, the area-weighted average of the surrounding faces
+ * triangles - vertex indices, wound counter-clockwise when seen from outside
+ */
+struct ObjModel
+{
+    std::vector<cv::Point3f> vertices;
+    std::vector<cv::Point3f> normals;
+    std::vector<cv::Vec3i> triangles;
+
+    bool empty() const
+    {
+        return triangles.empty();
+    }
+};
+
+/**
+ * @brief Loads the positions and faces of a Wavefront OBJ file. Polygons are split into triangle fans, negative
+ * (relative) indices are resolved, and texture coordinates, normals, materials and groups are ignored; vertex normals
+ * are recomputed from the faces.
+ *
+ * @param filename path to the .obj file
+ * @param model loaded mesh
+ * @return false if the file cannot be read or has no valid faces
+ */
+bool loadObjModel(const std::string &filename, ObjModel &model);
+
+/**
+ * @brief Recomputes the vertex normals from the triangles
+ */
+void computeObjNormals(ObjModel &model);
+
+/**
+ * @brief Moves a model from OBJ conventions (y up) onto a board: y up becomes -z, the largest extent is scaled to size,
+ * the footprint is centered on center and the lowest point rests on the board
+ *
+ * @param model mesh to place, modified in place
+ * @param size largest extent after scaling, in board units
+ * @param center board point under the middle of the model
+ */
+void placeObjModel(ObjModel &model, float size, const cv::Point2f &center);
+
+/**
+ * @brief A UV sphere resting on the board at center, with 2 * segments * (rings - 1) triangles
+ */
+ObjModel makeSphereModel(float radius, int segments, int rings, const cv::Point2f &center = cv::Point2f());
+
+#endif
@@ -0,0 +1,184 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Batched AR overlay renderer for pre-built wireframe and solid meshes
+
+#ifndef OVERLAY_RENDERER_H
+#define OVERLAY_RENDERER_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Vertices, edges and triangles of one overlay object, in board units (z < 0 is above the board)
+ *
+ * Triangles are wound counter-clockwise when seen from outside the mesh; the renderer culls the ones facing away.
+ */
+struct OverlayMeshData
+{
+    std::vector<cv::Point3f> vertices;
+    std::vector<cv::Vec2i> edges;
+    std::vector<cv::Vec3i> triangles;
+};
+
+/**
+ * @brief The hourglass drawn on the chessboard: a size x size square on the board, a peak at height size, and a
+ * second square at height 2 * size, joined by 16 edges
+ */
+OverlayMeshData makeHourglassMesh(float size);
+
+/**
+ * @brief A cube of the given side standing on the board at (x, y), with 12 edges and 12 outward-facing triangles
+ */
+OverlayMeshData makeCubeMesh(float side, float x = 0, float y = 0);
+
+/**
+ * @brief Counters for the overlay renderer
+ *
+ * drawnPrimitives - edges and triangles handed to polylines/fillPoly
+ * culledPrimitives - edges and triangles dropped because they were behind the camera, off screen or back-facing
+ */
+struct OverlayRenderStats
+{
+    long long frames;
+    long long instances;
+    long long drawnPrimitives;
+    long long culledPrimitives;
+    double projectMs;
+    double drawMs;
+
+    OverlayRenderStats() : frames(0), instances(0), drawnPrimitives(0), culledPrimitives(0), projectMs(0), drawMs(0)
+    {
+    }
+
+    void report() const;
+};
+
+/**
+ * @brief Draws posed copies (instances) of pre-built meshes on a frame.
+ *
+ * All meshes live in one set of flat vertex, edge and triangle arrays built once. Each frame the vertices of every
+ * instance are moved into camera space and projected with a single projectPoints call, primitives behind the camera,
+ * off screen or facing away are culled, and the rest are drawn with one fillPoly and one polylines call per run of
+ * instances that share a mesh. Instances are drawn far to near so solid meshes occlude each other correctly.
+ *
+ * On a solid mesh an edge is only drawn when both of its vertices belong to a visible triangle, which hides the back
+ * edges of convex meshes.
+ */
+class OverlayRenderer
+{
+  public:
+    OverlayRenderer();
+
+    /**
+     * @brief Adds a mesh to the renderer
+     *
+     * @param mesh vertices, edges and triangles; edges and triangles index into mesh.vertices
+     * @param color line (and fill) color
+     * @param thickness line thickness
+     * @param filled fill the visible triangles before drawing the edges
+     * @param fillColor fill color for filled meshes
+     * @return mesh id for addInstance
+     */
+    int addMesh(const OverlayMeshData &mesh, const cv::Scalar &color, int thickness = 2, bool filled = false,
+                const cv::Scalar &fillColor = cv::Scalar());
+
+    /**
+     * @brief Removes the instances of the previous frame; the meshes are kept
+     */
+    void clearInstances();
+
+    /**
+     * @brief Places a mesh in the current frame at a board pose
+     *
+     * @param mesh mesh id from addMesh
+     * @param rvec board rotation vector
+     * @param tvec board translation vector
+     */
+    void addInstance(int mesh, const cv::Mat &rvec, const cv::Mat &tvec);
+
+    /**
+     * @brief Projects and draws every instance
+     *
+     * @param image frame to draw on
+     * @param cameraMatrix camera matrix
+     * @param distCoeffs distortion coefficients (empty for none)
+     * @return number of primitives drawn
+     */
+    int render(cv::Mat &image, const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs);
+
+    int meshCount() const
+    {
+        return (int)meshes.size();
+    }
+
+    const OverlayRenderStats &stats() const
+    {
+        return renderStats;
+    }
+
+  private:
+    struct MeshRange
+    {
+        int vertexOffset;
+        int vertexCount;
+        int edgeOffset;
+        int edgeCount;
+        int triangleOffset;
+        int triangleCount;
+        cv::Scalar color;
+        cv::Scalar fillColor;
+        int thickness;
+        bool filled;
+    };
+
+    /**
+     * @brief Moves every instance's vertices into camera space and projects them in one call
+     */
+    void projectInstances(const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs);
+
+    /**
+     * @brief Appends the visible triangles and edges of one instance to the current batch
+     */
+    void collectInstance(int instance, const cv::Rect &imageRect);
+
+    /**
+     * @brief Draws and empties the current batch
+     */
+    void flushBatch(cv::Mat &image, const MeshRange &mesh);
+
+    // Meshes, as flat structure-of-arrays buffers
+    std::vector<float> vertexX, vertexY, vertexZ;
+    std::vector<int> edgeStart, edgeEnd;
+    std::vector<int> triangleA, triangleB, triangleC;
+    std::vector<MeshRange> meshes;
+
+    // Instances of the current frame
+    std::vector<int> instanceMesh;
+    std::vector<cv::Matx33f> instanceRotation;
+    std::vector<cv::Vec3f> instanceTranslation;
+
+    // Per-frame scratch, reused across frames
+    std::vector<int> instanceVertexOffset;
+    std::vector<float> instanceDepth;
+    std::vector<int> drawOrder;
+    std::vector<cv::Point3f> cameraPoints;
+    std::vector<cv::Point2f> projectedPoints;
+    std::vector<unsigned char> vertexVisible;
+    std::vector<cv::Point> fillPoints;
+    std::vector<cv::Point> linePoints;
+    std::vector<const cv::Point *> contourStarts;
+    std::vector<int> contourSizes;
+
+    OverlayRenderStats renderStats;
+};
+
+/**
+ * @brief Times drawing 1, 2, 4 ... maxObjects hourglasses with the original per-object projectPoints + line() code
+ * and with the batched renderer on a synthetic frame
+ *
+ * @param maxObjects largest number of objects per frame
+ * @param repeats frames timed per object count
+ */
+int benchmarkOverlayRenderer(int maxObjects = 64, int repeats = 200);
+
+#endif
@@ -0,0 +1,131 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Planar board pose estimation, warm-started from the previous frame's pose
+
+#ifndef POSE_ESTIMATOR_H
+#define POSE_ESTIMATOR_H
+
+#include <opencv2/aruco.hpp>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Counters for the pose estimator
+ *
+ * warmSolves - frames refined from the previous frame's pose
+ * coldSolves - frames solved from scratch with IPPE (no prior, or the warm result was rejected)
+ * rejectedWarm - warm solves whose reprojection error was too large, so a cold solve followed
+ * failures - frames where no pose was found
+ */
+struct PoseEstimatorStats
+{
+    long long warmSolves;
+    long long coldSolves;
+    long long rejectedWarm;
+    long long failures;
+    long long warmIterations;
+    long long coldIterations;
+    double warmMs;
+    double coldMs;
+
+    PoseEstimatorStats()
+        : warmSolves(0), coldSolves(0), rejectedWarm(0), failures(0), warmIterations(0), coldIterations(0), warmMs(0),
+          coldMs(0)
+    {
+    }
+
+    void report() const;
+};
+
+/**
+ * @brief Estimates the pose of a planar target (z = 0 board points) frame after frame.
+ *
+ * With no prior the pose comes from the planar IPPE solver and is then refined. With a prior (the last frame's pose)
+ * the Levenberg-Marquardt refinement starts from it directly, which typically converges in one or two iterations.
+ * If the warm result reprojects worse than maxReprojectionError pixels (the board jumped, or the prior is from
+ * another board) the frame is solved again from scratch.
+ */
+class PoseEstimator
+{
+  public:
+    PoseEstimator(double maxReprojectionError = 3.0, int maxIterations = 20);
+
+    /**
+     * @brief Finds the board pose
+     *
+     * @param objectPoints board points, all with z = 0
+     * @param imagePoints matching image points
+     * @param cameraMatrix camera matrix
+     * @param distCoeffs distortion coefficients (empty for none)
+     * @param rvec rotation vector (3x1 CV_64F)
+     * @param tvec translation vector (3x1 CV_64F)
+     * @return false if the pose could not be found; the prior is dropped in that case
+     */
+    bool estimate(const std::vector<cv::Point3f> &objectPoints, const std::vector<cv::Point2f> &imagePoints,
+                  const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs, cv::Mat &rvec, cv::Mat &tvec);
+
+    /**
+     * @brief Board pose from detected Aruco markers, matched to board points with Board::matchImagePoints
+     */
+    bool estimateBoard(const cv::Ptr<cv::aruco::Board> &board, const std::vector<std::vector<cv::Point2f>> &corners,
+                       const std::vector<int> &ids, const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs,
+                       cv::Mat &rvec, cv::Mat &tvec);
+
+    /**
+     * @brief Forgets the prior, so the next frame is solved from scratch
+     */
+    void reset()
+    {
+        hasPrior = false;
+    }
+
+    bool lastSolveWarm() const
+    {
+        return lastWarm;
+    }
+
+    int lastIterations() const
+    {
+        return iterations;
+    }
+
+    /**
+     * @brief RMS reprojection error of the last pose, in pixels
+     */
+    double lastError() const
+    {
+        return error;
+    }
+
+    const PoseEstimatorStats &stats() const
+    {
+        return poseStats;
+    }
+
+  private:
+    /**
+     * @brief Levenberg-Marquardt refinement of pose (rvec, tvec) in place
+     *
+     * @return RMS reprojection error after refinement
+     */
+    double refine(const std::vector<cv::Point3f> &objectPoints, const std::vector<cv::Point2f> &imagePoints,
+                  const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs, cv::Mat &pose);
+
+    double reprojectionError(const std::vector<cv::Point3f> &objectPoints,
+                             const std::vector<cv::Point2f> &imagePoints, const cv::Mat &cameraMatrix,
+                             const cv::Mat &distCoeffs, const cv::Mat &pose);
+
+    double maxReprojectionError;
+    int maxIterations;
+    bool hasPrior;
+    bool lastWarm;
+    int iterations;
+    double error;
+    cv::Mat prior;
+    std::vector<cv::Point2f> projected;
+    std::vector<cv::Point3f> boardObjectPoints;
+    std::vector<cv::Point2f> boardImagePoints;
+    PoseEstimatorStats poseStats;
+};
+
+#endif
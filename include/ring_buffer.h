@@ -0,0 +1,162 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Bounded lock-free ring buffer used to connect the stages of the stream pipeline
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Bounded multi-producer / multi-consumer queue (Vyukov's sequence-numbered ring).
+ *
+ * Every slot carries a sequence number that tells producers and consumers whether the slot is free for the current
+ * lap, so pushes and pops only need one compare-and-swap on the shared position. The capacity is rounded up to a
+ * power of two, and anything above maxCapacity is rejected. Neither call ever blocks; callers decide whether to retry,
+ * drop or back off.
+ */
+template <typename T> class RingBuffer
+{
+  public:
+    static const size_t maxCapacity = (size_t)1 << 24;
+
+    explicit RingBuffer(size_t requestedCapacity) : enqueuePos(0), dequeuePos(0)
+    {
+        // Also catches negative sizes converted to size_t, which would make the doubling below overflow and spin
+        if (requestedCapacity > maxCapacity)
+        {
+            throw std::length_error("RingBuffer capacity too large");
+        }
+        size_t capacity = 2;
+        while (capacity < requestedCapacity)
+        {
+            capacity <<= 1;
+        }
+        mask = capacity - 1;
+        slots = std::vector<Slot>(capacity);
+        for (size_t i = 0; i < capacity; i++)
+        {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Moves item into the buffer. Returns false (and leaves item untouched) when the buffer is full.
+     */
+    bool tryPush(T &item)
+    {
+        Slot *slot;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            slot = &slots[pos & mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(item);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Moves the oldest item out of the buffer. Returns false when the buffer is empty.
+     */
+    bool tryPop(T &item)
+    {
+        Slot *slot;
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        while (true)
+        {
+            slot = &slots[pos & mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(slot->value);
+        slot->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    /**
+     * @brief Approximate number of queued items (exact only when no other thread is pushing or popping)
+     */
+    size_t size() const
+    {
+        size_t head = dequeuePos.load(std::memory_order_relaxed);
+        size_t tail = enqueuePos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+  private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        T value;
+
+        Slot() : sequence(0)
+        {
+        }
+
+        // Only used while the buffer is being built, before any thread can see it
+        Slot(const Slot &other) : sequence(other.sequence.load(std::memory_order_relaxed)), value(other.value)
+        {
+        }
+
+        Slot &operator=(const Slot &other)
+        {
+            sequence.store(other.sequence.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            value = other.value;
+            return *this;
+        }
+    };
+
+    std::vector<Slot> slots;
+    size_t mask;
+    // Keep the producer and consumer positions on separate cache lines
+    char padding0[64];
+    std::atomic<size_t> enqueuePos;
+    char padding1[64];
+    std::atomic<size_t> dequeuePos;
+    char padding2[64];
+};
+
+#endif
@@ -0,0 +1,128 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Bounded per-session state: pose history ring buffer and session memory accounting
+
+#ifndef SESSION_STORE_H
+#define SESSION_STORE_H
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+// Poses kept in memory per stream unless --pose-history says otherwise
+static const size_t defaultPoseHistoryCapacity = 1024;
+
+/**
+ * @brief Adds (or with a negative delta, releases) bytes of long-lived session state: pose history and stored
+ * calibration views. Thread-safe.
+ */
+void trackSessionMemory(long long deltaBytes);
+
+/**
+ * @brief Bytes of session state held right now
+ */
+long long sessionMemoryBytes();
+
+/**
+ * @brief Largest value sessionMemoryBytes() has reached
+ */
+long long sessionMemoryPeakBytes();
+
+/**
+ * @brief Peak resident set size of the whole process in kilobytes, -1 where the platform does not report it
+ */
+long processPeakResidentKb();
+
+/**
+ * @brief Prints the session memory, its high-water mark and the process peak resident size
+ */
+void reportSessionMemory();
+
+/**
+ * @brief One estimated board pose
+ */
+struct PoseRecord
+{
+    long long frame;
+    double timeMs;
+    cv::Vec3d rvec;
+    cv::Vec3d tvec;
+};
+
+/**
+ * @brief Fixed-capacity history of board poses. Once full, each new pose overwrites the oldest, so memory stays at
+ * capacity * sizeof(PoseRecord) however long the session runs. Every pose can also be streamed to a CSV file
+ * (frame,time_ms,rx,ry,rz,tx,ty,tz) to keep the full history on disk.
+ */
+class PoseHistory
+{
+  public:
+    PoseHistory(size_t capacity = defaultPoseHistoryCapacity);
+    ~PoseHistory();
+
+    /**
+     * @brief Drops the stored poses and reallocates the ring for a new capacity (at least 1)
+     */
+    void setCapacity(size_t capacity);
+
+    /**
+     * @brief Appends every following pose to a CSV file
+     *
+     * @return false if the file cannot be opened
+     */
+    bool streamTo(const std::string &filename);
+
+    /**
+     * @brief Records the pose of the current frame
+     *
+     * @param frame frame number
+     * @param rvec rotation vector
+     * @param tvec translation vector
+     */
+    void push(long long frame, const cv::Mat &rvec, const cv::Mat &tvec);
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    size_t capacity() const
+    {
+        return records.size();
+    }
+
+    /**
+     * @brief Pose i of the stored ones, 0 being the oldest
+     */
+    const PoseRecord &at(size_t i) const
+    {
+        return records[(head + records.size() - count + i) % records.size()];
+    }
+
+    /**
+     * @brief Poses recorded since the start, including the overwritten ones
+     */
+    long long recorded() const
+    {
+        return total;
+    }
+
+    void report() const;
+
+  private:
+    PoseHistory(const PoseHistory &);
+    PoseHistory &operator=(const PoseHistory &);
+
+    std::vector<PoseRecord> records;
+    size_t head;
+    size_t count;
+    long long total;
+    std::ofstream stream;
+    std::string streamFile;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif
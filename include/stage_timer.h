@@ -0,0 +1,165 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Per-stage latency histograms for the stream loops (--stats)
+
+#ifndef STAGE_TIMER_H
+#define STAGE_TIMER_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Stages of a stream loop. Not every mode has every stage.
+ */
+enum Stage
+{
+    STAGE_CAPTURE,   // reading the frame from the source
+    STAGE_UNDISTORT, // remapping the frame
+    STAGE_GRAY,      // color to gray conversion
+    STAGE_DETECT,    // detectMarkers / findChessboardCorners / Harris response
+    STAGE_TRACK,     // optical-flow chessboard tracking
+    STAGE_SUBPIX,    // cornerSubPix
+    STAGE_POSE,      // pose estimation
+    STAGE_DRAW,      // markers, overlays, models and text
+    STAGE_DISPLAY,   // imshow and waitKey
+    STAGE_WRITE,     // handing frames to the frame writer
+    STAGE_FRAME,     // the whole loop iteration
+    STAGE_COUNT
+};
+
+const char *stageName(Stage stage);
+
+// Set once by setStageTiming before the stream starts; read by every timer
+extern bool stageTimingEnabled;
+
+/**
+ * @brief Turns stage timing on or off. Call before any stream thread starts.
+ */
+void setStageTiming(bool enabled);
+
+/**
+ * @brief Adds one sample to the calling thread's histogram for stage. Each thread owns its histograms, so recording
+ * takes no lock and no atomic read-modify-write.
+ */
+void recordStageTime(Stage stage, long long nanoseconds);
+
+/**
+ * @brief Times a scope and records it for a stage. When stage timing is off it only tests one flag.
+ */
+class ScopedStageTimer
+{
+  public:
+    explicit ScopedStageTimer(Stage stage) : stage(stage), running(stageTimingEnabled)
+    {
+        if (running)
+        {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedStageTimer()
+    {
+        stop();
+    }
+
+    /**
+     * @brief Records the time so far and stops the timer, for stages that end before the scope does
+     */
+    void stop()
+    {
+        if (running)
+        {
+            running = false;
+            recordStageTime(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now() - start)
+                                       .count());
+        }
+    }
+
+  private:
+    Stage stage;
+    bool running;
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * @brief Latency histogram of its own with the stage-timer buckets, for anything that needs percentiles per stream
+ * rather than per stage. Fixed size however many samples it takes. Not thread-safe; one writer at a time.
+ */
+class LatencyHistogram
+{
+  public:
+    LatencyHistogram();
+
+    void record(long long nanoseconds);
+
+    long long samples() const
+    {
+        return sampleCount;
+    }
+
+    double meanMs() const
+    {
+        return sampleCount > 0 ? totalNs / 1e6 / sampleCount : 0.0;
+    }
+
+    double maxMs() const
+    {
+        return largestNs / 1e6;
+    }
+
+    /**
+     * @brief Quantile q (0-1) in milliseconds, within 12.5% like the stage summaries; 0 without samples
+     */
+    double quantileMs(double q) const;
+
+  private:
+    std::vector<long long> counts;
+    long long sampleCount;
+    long long totalNs;
+    long long largestNs;
+};
+
+/**
+ * @brief Latency distribution of one stage over all threads. Percentiles come from log-linear buckets (8 per power
+ * of two), so they are within 12.5% of the exact value; mean and max are exact.
+ */
+struct StageSummary
+{
+    Stage stage;
+    long long samples;
+    double meanMs;
+    double p50Ms;
+    double p95Ms;
+    double p99Ms;
+    double maxMs;
+};
+
+/**
+ * @brief Merges the per-thread histograms. Exact once the threads that recorded have stopped.
+ *
+ * @return one summary per stage that has samples
+ */
+std::vector<StageSummary> summarizeStageTimes();
+
+/**
+ * @brief Prints p50/p95/p99/max per stage
+ */
+void reportStageTimes(const std::string &label);
+
+/**
+ * @brief Writes the summaries as JSON when filename ends in .json, CSV otherwise
+ *
+ * @param filename output file
+ * @param label name of the run, stored in the JSON output
+ * @return false if the file cannot be written
+ */
+bool writeStageTimes(const std::string &filename, const std::string &label);
+
+/**
+ * @brief Reports the stage times and writes them to statsFile (if not empty); does nothing when timing is off
+ */
+void finishStageTimes(const std::string &label, const std::string &statsFile);
+
+#endif
@@ -0,0 +1,91 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Multi-threaded capture -> detect -> render pipeline for the stream loops
+
+#ifndef STREAM_PIPELINE_H
+#define STREAM_PIPELINE_H
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "frame_source.h"
+
+class UndistortMaps;
+
+/**
+ * @brief One frame travelling through the pipeline
+ *
+ * image   - the captured frame, never modified after capture
+ * output  - the annotated frame produced by the detection stage
+ * dropped - set when the frame was evicted from the capture queue before any worker picked it up
+ */
+struct PipelineFrame
+{
+    long long sequence;
+    std::chrono::steady_clock::time_point captureTime;
+    cv::Mat image;
+    cv::Mat output;
+    std::vector<std::vector<cv::Point2f>> markerCorners;
+    std::vector<int> markerIds;
+    // image was undistorted by the detect stage, so its points carry no lens distortion
+    bool undistorted;
+    // Maps image was undistorted with, to take points back to the raw frame (null when not undistorted)
+    std::shared_ptr<const UndistortMaps> undistortMaps;
+    bool dropped;
+
+    PipelineFrame() : sequence(-1), undistorted(false), dropped(false)
+    {
+    }
+};
+
+/**
+ * @brief Runs on a detection worker. workerIndex lets the caller keep one detector per worker.
+ */
+typedef std::function<void(int workerIndex, PipelineFrame &frame)> DetectStage;
+
+/**
+ * @brief Runs on the calling thread, in capture order. latencyMs is capture -> render. Return false to stop.
+ */
+typedef std::function<bool(PipelineFrame &frame, double latencyMs)> RenderStage;
+
+/**
+ * @brief Counters of one pipeline run. Latency is capture -> render; the p95 comes from a LatencyHistogram, so it is
+ * within 12.5% of the exact value while mean and max are exact.
+ */
+struct PipelineStats
+{
+    long long captured;
+    long long processed;
+    long long dropped;
+    double meanLatencyMs;
+    double p95LatencyMs;
+    double maxLatencyMs;
+    double elapsedSeconds;
+
+    PipelineStats()
+        : captured(0), processed(0), dropped(0), meanLatencyMs(0), p95LatencyMs(0), maxLatencyMs(0), elapsedSeconds(0)
+    {
+    }
+
+    void report(const std::string &label) const;
+};
+
+/**
+ * @brief Runs a capture thread, `workers` detection threads and the render stage (on the calling thread), connected
+ * by bounded lock-free ring buffers. When detection falls behind the oldest queued frame is dropped so latency stays
+ * bounded; the render stage still sees every remaining frame in capture order.
+ *
+ * @param source frame source, read only by the capture thread
+ * @param workers number of detection workers
+ * @param queueCapacity capacity of the capture queue
+ * @param maxFrames stop after this many frames have been captured (0 = until the source is exhausted)
+ * @param detect detection stage
+ * @param render render/display stage
+ */
+PipelineStats runStreamPipeline(FrameSource &source, int workers, size_t queueCapacity, int maxFrames,
+                                const DetectStage &detect, const RenderStage &render);
+
+#endif
@@ -0,0 +1,249 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Per-stream detection sessions and the multi-stream mode that runs many of them on one thread pool
+
+#ifndef STREAM_SESSION_H
+#define STREAM_SESSION_H
+
+#include <atomic>
+#include <chrono>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+#include "aruco_tracker.h"
+#include "chessboard_tracker.h"
+#include "frame_context.h"
+#include "frame_source.h"
+#include "harris_keypoints.h"
+#include "pose_estimator.h"
+#include "session_store.h"
+#include "stage_timer.h"
+#include "thread_pool.h"
+#include "undistortion.h"
+
+/**
+ * @brief Throughput and latency of one stream
+ *
+ * detectedFrames - frames in which the detector found its target
+ * latency - time from the start of the frame read to the end of pose estimation, one sample per frame; a histogram,
+ *           so a camera stream that runs for days takes no more memory than a short one
+ */
+struct StreamSessionStats
+{
+    long long frames;
+    long long detectedFrames;
+    long long posedFrames;
+    double busyMs;
+    LatencyHistogram latency;
+
+    StreamSessionStats() : frames(0), detectedFrames(0), posedFrames(0), busyMs(0)
+    {
+    }
+
+    /**
+     * @brief Prints fps over elapsedSeconds of wall time and the latency summary
+     */
+    void report(const std::string &label, double elapsedSeconds) const;
+};
+
+/**
+ * @brief Everything one stream needs: its frame source, calibration, undistortion maps, pose history and the
+ * detector state of the subclass. Holds no global state, so any number of sessions can run in one process.
+ *
+ * A session is not thread-safe, and trackers and poses carry state from the previous frame, so its frames must be
+ * processed one at a time and in order. Different sessions may run on different threads at the same time.
+ */
+class StreamSession
+{
+  public:
+    /**
+     * @param source frame source owned by this session
+     * @param cameraMatrix camera matrix (empty to detect only)
+     * @param distCoeffs distortion coefficients
+     * @param options undistort, maxFrames and poseHistory are used
+     */
+    StreamSession(const cv::Ptr<FrameSource> &source, const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs,
+                  const StreamOptions &options);
+
+    virtual ~StreamSession()
+    {
+    }
+
+    /**
+     * @brief Reads, undistorts and detects one frame and, with a calibration, estimates the board pose
+     *
+     * @return false once the source is exhausted or maxFrames frames have been processed
+     */
+    bool processNextFrame();
+
+    /**
+     * @brief Streams every pose of this session to a CSV file
+     *
+     * @return false if the file cannot be opened
+     */
+    bool streamPosesTo(const std::string &filename)
+    {
+        return poses.streamTo(filename);
+    }
+
+    const FrameSource &frameSource() const
+    {
+        return *source;
+    }
+
+    const PoseHistory &poseHistory() const
+    {
+        return poses;
+    }
+
+    const StreamSessionStats &stats() const
+    {
+        return sessionStats;
+    }
+
+  protected:
+    /**
+     * @brief Runs the detector on the frame
+     *
+     * @return true if the target (board, markers, keypoints) was found
+     */
+    virtual bool detect(FrameContext &context) = 0;
+
+    /**
+     * @brief Board pose from the last detect(); frames are already undistorted when distCoeffs is empty
+     *
+     * @return false if there is no pose (the default, for detectors without a board)
+     */
+    virtual bool estimatePose(const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs, cv::Mat &rvec, cv::Mat &tvec)
+    {
+        return false;
+    }
+
+  private:
+    StreamSession(const StreamSession &);
+    StreamSession &operator=(const StreamSession &);
+
+    cv::Ptr<FrameSource> source;
+    PoseHistory poses;
+    cv::Mat cameraMatrix;
+    cv::Mat distCoeffs;
+    bool undistort;
+    int maxFrames;
+    cv::Ptr<UndistortMaps> undistortMaps;
+    cv::Mat frame;
+    cv::Mat undistorted;
+    FrameContext context;
+    cv::Mat rvec;
+    cv::Mat tvec;
+    StreamSessionStats sessionStats;
+};
+
+/**
+ * @brief Aruco board stream (roiTracking and fullSearchInterval of the options are used)
+ */
+class ArucoStreamSession : public StreamSession
+{
+  public:
+    ArucoStreamSession(const cv::Ptr<FrameSource> &source, const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs,
+                       const StreamOptions &options,
+                       const cv::aruco::DetectorParameters &detectorParams = cv::aruco::DetectorParameters());
+
+    const ArucoTracker &arucoTracker() const
+    {
+        return tracker;
+    }
+
+  protected:
+    bool detect(FrameContext &context);
+    bool estimatePose(const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs, cv::Mat &rvec, cv::Mat &tvec);
+
+  private:
+    ArucoTracker tracker;
+    PoseEstimator estimator;
+};
+
+/**
+ * @brief 9x6 chessboard stream with 25 mm squares, tracked by optical flow between detections
+ * (chessboardRedetectInterval of the options is used)
+ */
+class ChessboardStreamSession : public StreamSession
+{
+  public:
+    ChessboardStreamSession(const cv::Ptr<FrameSource> &source, const cv::Mat &cameraMatrix,
+                            const cv::Mat &distCoeffs, const StreamOptions &options);
+
+    const ChessboardTracker &chessboardTracker() const
+    {
+        return tracker;
+    }
+
+  protected:
+    bool detect(FrameContext &context);
+    bool estimatePose(const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs, cv::Mat &rvec, cv::Mat &tvec);
+
+  private:
+    ChessboardTracker tracker;
+    PoseEstimator estimator;
+    std::vector<cv::Point3f> boardPoints;
+    std::vector<cv::Point2f> corners;
+};
+
+/**
+ * @brief Harris keypoint stream; there is no board, so it never has a pose
+ */
+class HarrisStreamSession : public StreamSession
+{
+  public:
+    HarrisStreamSession(const cv::Ptr<FrameSource> &source, const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs,
+                        const StreamOptions &options);
+
+    const std::vector<cv::KeyPoint> &keypoints() const
+    {
+        return frameKeypoints;
+    }
+
+  protected:
+    bool detect(FrameContext &context);
+
+  private:
+    HarrisKeypointExtractor extractor;
+    std::vector<cv::KeyPoint> frameKeypoints;
+};
+
+/**
+ * @brief Creates the session for options.detector ("aruco", "chessboard" or "harris")
+ *
+ * @param detectorParams marker detection settings of an Aruco session
+ * @return an empty pointer for an unknown detector
+ */
+cv::Ptr<StreamSession> createStreamSession(const cv::Ptr<FrameSource> &source, const cv::Mat &cameraMatrix,
+                                           const cv::Mat &distCoeffs, const StreamOptions &options,
+                                           const cv::aruco::DetectorParameters &detectorParams =
+                                               cv::aruco::DetectorParameters());
+
+/**
+ * @brief Runs sessions on pool until each one is exhausted or stop is set. Every frame is one task; a session that
+ * finished a frame goes to the back of a shared ready queue and the next task runs the session at its front, so with
+ * more sessions than workers every session still advances in turn.
+ *
+ * @param finishedSeconds set to the time from the start at which each session stopped
+ * @return wall time of the run in seconds
+ */
+double runStreamSessions(const std::vector<cv::Ptr<StreamSession>> &sessions, ThreadPool &pool,
+                         const std::atomic<bool> &stop, std::vector<double> &finishedSeconds);
+
+/**
+ * @brief Runs one session per source, headless, on a shared thread pool (see runStreamSessions) until every source is
+ * exhausted or Ctrl+C is pressed. Ctrl+C lets the frames in progress finish, then the report runs as usual; the
+ * previous SIGINT handler is restored afterwards. Reports fps and latency per stream and the combined throughput.
+ *
+ * @param sources frame source specs (see StreamOptions::source)
+ * @param options detector, calibrationFile (shared by every stream, "" to detect only), detectorParamsFile (aruco
+ *            only), workers (0 = one per core), pinThreads, maxFrames per stream, poseLog (one file per stream,
+ *            suffixed _<index>)
+ * @return 0 on success, -1 if a source or the calibration cannot be opened or the detector is unknown
+ */
+int multiStreamDetection(const std::vector<std::string> &sources, const StreamOptions &options);
+
+#endif
@@ -0,0 +1,86 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Work-stealing thread pool for batch jobs (one task queue per worker, idle workers steal)
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed set of worker threads, each with its own task deque.
+ *
+ * A worker takes tasks from the back of its own deque and, when that is empty, steals from the front of the others,
+ * so one slow task (a large image, a failed board search) does not leave the rest of the batch waiting behind it.
+ * Tasks submitted from outside the pool are spread round-robin; tasks submitted from a worker go to its own deque.
+ */
+class ThreadPool
+{
+  public:
+    /**
+     * @param threads number of workers, 0 for one per hardware thread
+     * @param pinThreads pin worker i to core i (modulo the core count) so its caches stay warm; Linux only
+     */
+    explicit ThreadPool(int threads = 0, bool pinThreads = false);
+    ~ThreadPool();
+
+    /**
+     * @brief Queues a task. An exception thrown by the task is logged and the task counts as finished.
+     */
+    void submit(const std::function<void()> &task);
+
+    /**
+     * @brief Blocks until every submitted task has finished. Must not be called from a worker.
+     */
+    void wait();
+
+    int size() const
+    {
+        return (int)workers.size();
+    }
+
+    /**
+     * @brief Tasks taken from another worker's deque so far
+     */
+    long long steals() const
+    {
+        return stolen.load();
+    }
+
+    /**
+     * @brief Index of the worker running the calling thread, or -1 when called from outside this pool. Useful to give
+     * every worker its own scratch state.
+     */
+    int currentWorker() const;
+
+  private:
+    struct WorkerQueue
+    {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool takeTask(int worker, std::function<void()> &task);
+    void workerLoop(int index);
+    void pinWorker(int index);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::mutex sleepLock;
+    std::condition_variable wakeUp;
+    std::condition_variable allDone;
+    std::atomic<long long> queued;
+    std::atomic<long long> pending;
+    std::atomic<long long> stolen;
+    std::atomic<unsigned> nextQueue;
+    bool stopping;
+};
+
+#endif
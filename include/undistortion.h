@@ -0,0 +1,110 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Cached fixed-point undistortion maps, built once per calibration and frame size and applied in parallel
+
+#ifndef UNDISTORTION_H
+#define UNDISTORTION_H
+
+#include <algorithm>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * @brief initUndistortRectifyMap maps in the compact CV_16SC2 + CV_16UC1 fixed-point form.
+ *
+ * The undistorted frame keeps the original camera matrix, so anything that used (cameraMatrix, distCoeffs) on the
+ * raw frame can use (cameraMatrix, no distortion) on the undistorted one. Once built the maps are never modified, so
+ * one instance can be shared by any number of threads.
+ */
+class UndistortMaps
+{
+  public:
+    UndistortMaps();
+
+    /**
+     * @brief Builds the maps for a calibration and frame size
+     */
+    void build(const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs, const cv::Size &imageSize);
+
+    /**
+     * @brief True when the maps were built for exactly this calibration and frame size
+     */
+    bool matches(const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs, const cv::Size &imageSize) const;
+
+    /**
+     * @brief Loads maps saved by save(). Fails if the file is missing, damaged, or was built for another calibration.
+     */
+    bool load(const std::string &filename, const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs,
+              const cv::Size &imageSize);
+
+    bool save(const std::string &filename) const;
+
+    /**
+     * @brief Undistorts frame into undistorted, one horizontal band per thread
+     */
+    void apply(const cv::Mat &frame, cv::Mat &undistorted) const;
+
+    /**
+     * @brief Maps points found on an undistorted frame back to where they are on the raw frame, with the calibration
+     * the maps were built for. Calibration views must always hold raw-frame points.
+     */
+    void distortPoints(const std::vector<cv::Point2f> &undistorted, std::vector<cv::Point2f> &raw) const;
+
+    bool empty() const
+    {
+        return map1.empty();
+    }
+
+    cv::Size size() const
+    {
+        return imageSize;
+    }
+
+  private:
+    cv::Mat map1;
+    cv::Mat map2;
+    // Calibration the maps were built for (CV_64F)
+    cv::Mat mapCameraMatrix;
+    cv::Mat mapDistCoeffs;
+    cv::Size imageSize;
+    uint64_t fingerprint;
+};
+
+/**
+ * @brief Cache file for the maps of a calibration file at a frame size ("<calibration>.undistort-<w>x<h>.bin")
+ */
+std::string undistortCachePath(const std::string &calibrationFile, const cv::Size &imageSize);
+
+/**
+ * @brief Returns maps for the calibration, loading them from the cache next to calibrationFile when it is up to
+ * date and building (and caching) them otherwise. An empty calibrationFile skips the cache.
+ */
+cv::Ptr<UndistortMaps> loadOrBuildUndistortMaps(const cv::Mat &cameraMatrix, const cv::Mat &distCoeffs,
+                                                const cv::Size &imageSize, const std::string &calibrationFile);
+
+/**
+ * @brief Per-frame undistortion cost
+ */
+struct UndistortTiming
+{
+    long long frames;
+    double totalMs;
+    double maxMs;
+
+    UndistortTiming() : frames(0), totalMs(0), maxMs(0)
+    {
+    }
+
+    void add(double ms)
+    {
+        frames++;
+        totalMs += ms;
+        maxMs = std::max(maxMs, ms);
+    }
+
+    void report() const;
+};
+
+#endif
@@ -0,0 +1,59 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Picks a bounded, pose-diverse subset of calibration views so solve time does not grow with capture count
+
+#ifndef VIEW_SELECTION_H
+#define VIEW_SELECTION_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Views kept for a solve when the caller does not say otherwise
+const int defaultMaxCalibrationViews = 25;
+
+/**
+ * @brief What a view contributes to a calibration, measured without knowing the intrinsics
+ *
+ * center   - board center in the image, as a fraction of the image size
+ * scale    - square root of the board's image area over the image area
+ * tilt     - relative depth change across the board's width and height, from the plane-to-image homography
+ *            (0 for a board facing the camera; tilted views are what pin down the focal length)
+ * coverage - bit per cell of an 8x8 grid over the image, set when the cell contains a board point
+ */
+struct ViewFeatures
+{
+    cv::Point2f center;
+    float scale;
+    cv::Point2f tilt;
+    unsigned long long coverage;
+    bool valid;
+
+    ViewFeatures() : scale(0), coverage(0), valid(false)
+    {
+    }
+};
+
+/**
+ * @brief Measures one view
+ *
+ * @param objectPoints board points (z = 0 plane)
+ * @param imagePoints matching image points
+ * @param imageSize frame size
+ */
+ViewFeatures measureView(const std::vector<cv::Point3f> &objectPoints, const std::vector<cv::Point2f> &imagePoints,
+                         const cv::Size &imageSize);
+
+/**
+ * @brief Greedily picks at most maxViews maximally different views.
+ *
+ * Starts from the view covering the most of the image, then repeatedly adds the view farthest (in center, scale and
+ * tilt) from every view picked so far, with a bonus for image cells no picked view covers yet. Near-duplicate poses
+ * are therefore the last to be picked. Cost is O(views * maxViews).
+ *
+ * @return indices of the picked views in ascending order (all views when there are at most maxViews, or maxViews <= 0)
+ */
+std::vector<int> selectDiverseViews(const std::vector<std::vector<cv::Point3f>> &objectPoints,
+                                    const std::vector<std::vector<cv::Point2f>> &imagePoints,
+                                    const cv::Size &imageSize, int maxViews = defaultMaxCalibrationViews);
+
+#endif
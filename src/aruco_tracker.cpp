@@ -0,0 +1,281 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Persistent Aruco board tracker that reuses its dictionary, board, detector and result buffers
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <opencv2/aruco.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "aruco_tracker.h"
+#include "logger.h"
+
+using namespace std;
+using namespace cv;
+
+// Upper bound on rejected candidates kept without reallocating
+static const int reservedRejectedCandidates = 256;
+
+// Smallest growth around a marker box in pixels, so tiny markers still get a quiet zone to detect against
+static const int minimumRegionPadding = 8;
+
+/**
+ * @brief Prints the ROI hit rate and the mean cost of ROI and full-image frames
+ */
+void RoiTrackingStats::report() const
+{
+    LOG_INFO("ROI tracking: " << roiFrames << " ROI frames (" << hitRate() * 100.0 << "% hit rate), " << fullFrames
+             << " full searches");
+    LOG_INFO("Mean detection cost: ROI " << (roiFrames > 0 ? roiMs / roiFrames : 0.0) << " ms, full "
+             << (fullFrames > 0 ? fullMs / fullFrames : 0.0) << " ms");
+}
+
+/**
+ * @brief Copies one corner set into a slot of a list, reusing the slot's storage when it already exists
+ *
+ * @param sets destination list
+ * @param index slot to write
+ * @param corners corner set to copy
+ * @param offset translation added to every corner
+ */
+static void storeCornerSet(vector<vector<Point2f>> &sets, size_t index, const vector<Point2f> &corners,
+                           const Point2f &offset)
+{
+    if (index >= sets.size())
+    {
+        sets.push_back(vector<Point2f>());
+    }
+    vector<Point2f> &slot = sets[index];
+    slot.resize(corners.size());
+    for (size_t i = 0; i < corners.size(); i++)
+    {
+        slot[i] = corners[i] + offset;
+    }
+}
+
+/**
+ * @brief Milliseconds elapsed since start
+ */
+static double millisecondsSince(const chrono::steady_clock::time_point &start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Checks whether a list of corner sets still uses the storage recorded before the last detection
+ *
+ * @param sets corner sets after detection
+ * @param outerStorage outer buffer before detection
+ * @param innerStorage inner buffers before detection
+ */
+static bool cornerSetsMoved(const vector<vector<Point2f>> &sets, const void *outerStorage,
+                            const vector<const Point2f *> &innerStorage)
+{
+    if ((const void *)sets.data() != outerStorage)
+    {
+        return true;
+    }
+    // Any set beyond the previous count had to be created
+    if (sets.size() > innerStorage.size())
+    {
+        return true;
+    }
+    for (size_t i = 0; i < sets.size(); i++)
+    {
+        if (sets[i].data() != innerStorage[i])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Records the storage used by a list of corner sets
+ *
+ * @param sets corner sets
+ * @param innerStorage destination for the inner buffer pointers
+ */
+static void recordCornerSets(const vector<vector<Point2f>> &sets, vector<const Point2f *> &innerStorage)
+{
+    innerStorage.resize(sets.size());
+    for (size_t i = 0; i < sets.size(); i++)
+    {
+        innerStorage[i] = sets[i].data();
+    }
+}
+
+ArucoTracker::ArucoTracker(aruco::PredefinedDictionaryType dictionaryId, Size gridSize, float markerLength,
+                           float markerSeparation, const aruco::DetectorParameters &detectorParams)
+    : dict(aruco::getPredefinedDictionary(dictionaryId)),
+      arucoBoard(makePtr<aruco::GridBoard>(gridSize, markerLength, markerSeparation, dict)),
+      detector(dict, detectorParams), cornerOuterStorage(0), rejectedOuterStorage(0), idStorage(0), frameCount(0),
+      reallocationCount(0), roiTracking(false), fullSearchInterval(30), motionMargin(0.5f), framesSinceFullSearch(0)
+{
+    int maxMarkers = gridSize.area();
+    markerCorners.reserve(maxMarkers);
+    markerIds.reserve(maxMarkers);
+    rejectedCandidates.reserve(reservedRejectedCandidates);
+    cornerStorage.reserve(maxMarkers);
+    rejectedStorage.reserve(reservedRejectedCandidates);
+    regions.reserve(maxMarkers);
+    regionCorners.reserve(maxMarkers);
+    regionIds.reserve(maxMarkers);
+    regionRejected.reserve(reservedRejectedCandidates);
+}
+
+void ArucoTracker::setRoiTracking(bool enabled, int fullSearchInterval, float motionMargin)
+{
+    roiTracking = enabled;
+    this->fullSearchInterval = max(1, fullSearchInterval);
+    this->motionMargin = max(0.0f, motionMargin);
+    framesSinceFullSearch = 0;
+}
+
+void ArucoTracker::predictRegions(const Size &imageSize)
+{
+    Rect imageRect(Point(0, 0), imageSize);
+    regions.clear();
+    for (size_t i = 0; i < markerCorners.size(); i++)
+    {
+        Rect box = boundingRect(markerCorners[i]);
+        int padding = max(minimumRegionPadding, (int)(motionMargin * max(box.width, box.height)));
+        box.x -= padding;
+        box.y -= padding;
+        box.width += 2 * padding;
+        box.height += 2 * padding;
+        box &= imageRect;
+        if (box.area() > 0)
+        {
+            regions.push_back(box);
+        }
+    }
+
+    // Merge overlapping boxes so a board is searched as one region and no marker is cut in half
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (size_t i = 0; i < regions.size() && !merged; i++)
+        {
+            for (size_t j = i + 1; j < regions.size(); j++)
+            {
+                if ((regions[i] & regions[j]).area() > 0)
+                {
+                    regions[i] |= regions[j];
+                    regions.erase(regions.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void ArucoTracker::detectInRegions(const Mat &image)
+{
+    size_t markerCount = 0;
+    size_t rejectedCount = 0;
+    for (size_t r = 0; r < regions.size(); r++)
+    {
+        const Rect &region = regions[r];
+        Point2f offset((float)region.x, (float)region.y);
+        detector.detectMarkers(image(region), regionCorners, regionIds, regionRejected);
+
+        for (size_t i = 0; i < regionIds.size(); i++)
+        {
+            storeCornerSet(markerCorners, markerCount, regionCorners[i], offset);
+            if (markerCount < markerIds.size())
+            {
+                markerIds[markerCount] = regionIds[i];
+            }
+            else
+            {
+                markerIds.push_back(regionIds[i]);
+            }
+            markerCount++;
+        }
+        for (size_t i = 0; i < regionRejected.size(); i++)
+        {
+            storeCornerSet(rejectedCandidates, rejectedCount++, regionRejected[i], offset);
+        }
+    }
+    markerCorners.resize(markerCount);
+    markerIds.resize(markerCount);
+    rejectedCandidates.resize(rejectedCount);
+}
+
+void ArucoTracker::setDetectorParameters(const aruco::DetectorParameters &detectorParams)
+{
+    detector.setDetectorParameters(detectorParams);
+}
+
+void ArucoTracker::snapshotBuffers()
+{
+    cornerOuterStorage = markerCorners.data();
+    rejectedOuterStorage = rejectedCandidates.data();
+    idStorage = markerIds.data();
+    recordCornerSets(markerCorners, cornerStorage);
+    recordCornerSets(rejectedCandidates, rejectedStorage);
+}
+
+bool ArucoTracker::buffersMoved() const
+{
+    return markerIds.data() != idStorage || cornerSetsMoved(markerCorners, cornerOuterStorage, cornerStorage) ||
+           cornerSetsMoved(rejectedCandidates, rejectedOuterStorage, rejectedStorage);
+}
+
+int ArucoTracker::detect(const Mat &image)
+{
+    snapshotBuffers();
+
+    size_t previousMarkers = markerIds.size();
+    bool searchFullImage = true;
+    if (roiTracking && previousMarkers > 0 && framesSinceFullSearch < fullSearchInterval)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        predictRegions(image.size());
+        detectInRegions(image);
+        roiTrackingStats.roiMs += millisecondsSince(start);
+        roiTrackingStats.roiFrames++;
+
+        // Fewer markers than last frame means something moved out of its region: look everywhere
+        searchFullImage = markerIds.size() < previousMarkers;
+        if (!searchFullImage)
+        {
+            roiTrackingStats.roiHits++;
+            framesSinceFullSearch++;
+        }
+    }
+
+    if (searchFullImage)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        regions.clear();
+        detector.detectMarkers(image, markerCorners, markerIds, rejectedCandidates);
+        roiTrackingStats.fullMs += millisecondsSince(start);
+        roiTrackingStats.fullFrames++;
+        framesSinceFullSearch = 0;
+    }
+
+    if (buffersMoved())
+    {
+        reallocationCount++;
+    }
+    frameCount++;
+    return (int)markerIds.size();
+}
+
+void ArucoTracker::draw(Mat &image, bool showRejected) const
+{
+    if (markerIds.size() > 0)
+    {
+        aruco::drawDetectedMarkers(image, markerCorners, markerIds);
+    }
+
+    if (showRejected && !rejectedCandidates.empty())
+    {
+        aruco::drawDetectedMarkers(image, rejectedCandidates, noArray(), Scalar(100, 0, 255));
+    }
+}
@@ -2,50 +2,101 @@
 // Date: March 1, 2024
 // Purpose: A collection of utils used for Aruco marker recognition and calibration
 
+#include <iomanip>
 #include <opencv2/aruco.hpp>
 #include <opencv2/opencv.hpp>
+#include <sstream>
 
+#include "aruco_tracker.h"
 #include "aruco_utils.h"
+#include "calibration_worker.h"
 #include "camera_utils.h"
+#include "detector_tuning.h"
+#include "frame_source.h"
+#include "frame_writer.h"
+#include "logger.h"
+#include "obj_model.h"
+#include "overlay_renderer.h"
+#include "pose_estimator.h"
+#include "session_store.h"
+#include "software_rasterizer.h"
+#include "stage_timer.h"
+#include "stream_pipeline.h"
+#include "undistortion.h"
 
 using namespace std;
 using namespace cv;
 
-//--------------------- Global Variables ---------------------//
-string defaultCalibrationDirectory = "../img/CameraCalibration/";
-aruco::DetectorParameters detectorParams;
-aruco::Dictionary dict;
-Mat cameraMatrix, distCoeffs, frame, frameCopy;
-Size imageSize;
-vector<int> markerIds, markerIdsCopy, markerCounterPerFrame;
-// vector<int> markerCounterPerFrame;
-vector<vector<Point2f>> markerCorners, rejectedCandidates;
-Ptr<aruco::Board> arucoBoard;
-
-// Future Goal: Create a class or struct to store the following variables
-vector<Vec3f> point_set;             // should equal markerCorners // object points
-vector<vector<Vec3f>> point_list;    // should be the same size as corner_list
-vector<vector<Point2f>> corner_list; // image points
-vector<Mat> calibrationImages;
-vector<Mat> tvecs, rvecs;
-int numOfCalibrationImages;
-float markerSize, aspectRatio;
-// int markersX = 7;
-int markersX = 5;
-int markersY = 7;
-// int markersY = 5;
-int margins = 10;
-int borderBits = 1;
-int markerLength = 10;
-// int markerLength = 100;
-int markerSeparation = 10;
-// int markerSeparation = 10;
-// Size boardSize = Size(780, 560);
-Size boardSize = Size(560, 780);
-bool isCalibrated = false;
-bool areVariablesInitialized = false;
-
-//------------------------------------------------------------//
+// Board layout, shared by the board image, the trackers and the calibration object points
+// static const int markersX = 7;
+static const int markersX = 5;
+static const int markersY = 7;
+// static const int markersY = 5;
+static const int margins = 10;
+static const int borderBits = 1;
+static const int markerLength = 10;
+// static const int markerLength = 100;
+static const int markerSeparation = 10;
+// static const Size boardSize = Size(780, 560);
+static const Size boardSize = Size(560, 780);
+static const string defaultCalibrationDirectory = "../img/CameraCalibration/";
+
+/**
+ * @brief Everything one -v stream owns: the current frame, the calibration and its saved views, the overlay and the
+ * writer. videoStreaming builds one per call, so no state outlives the stream or is shared with another one.
+ */
+class ArucoVideoSession
+{
+  public:
+    ArucoVideoSession();
+
+    int run(FrameSource &source, const string &cameraCalibrationFile, const StreamOptions &options);
+
+  private:
+    void printCalibrationVariables();
+    void saveCalibrationVariables(double reprojectionError, const vector<vector<Point2f>> &markerCorners);
+    bool saveCalibrationImage(Mat &src, const vector<vector<Point2f>> &markerCorners, const vector<int> &markerIds,
+                              string calibrationDirectory = defaultCalibrationDirectory);
+    void initializeVariables();
+    void updateCalibration(Mat &display, const vector<vector<Point2f>> &markerCorners);
+    void drawBoardPose(Mat &display, PoseEstimator &estimator, const vector<vector<Point2f>> &markerCorners,
+                       const vector<int> &markerIds, Ptr<aruco::Board> arucoBoard, bool undistorted,
+                       long long frameNumber);
+    bool handleVideoStreamKey(char key, const vector<vector<Point2f>> &markerCorners, const vector<int> &markerIds,
+                              Ptr<aruco::Board> arucoBoard, const UndistortMaps *undistortedWith);
+    void undistortFrame(Mat &frame, Ptr<UndistortMaps> &maps, Mat &undistorted, const string &calibrationFile,
+                        UndistortTiming &timing);
+    int runPipelined(FrameSource &source, const StreamOptions &options, const string &calibrationFile);
+
+    aruco::DetectorParameters detectorParams;
+    Mat cameraMatrix, distCoeffs, frame, frameCopy;
+    // Board object points; the saved views themselves are kept (as points only) by arucoCalibration
+    vector<Vec3f> point_set; // should equal the detected marker corners // object points
+    int numOfCalibrationImages;
+    float aspectRatio;
+    bool isCalibrated;
+    bool areVariablesInitialized;
+    CalibrationWorker arucoCalibration;
+    int appliedArucoCalibration;
+    // Solid cube standing in the middle of the board, drawn once the board pose is known
+    OverlayRenderer arucoOverlay;
+    int arucoCubeMesh;
+    // Optional OBJ model (--model) drawn in place of the cube
+    ObjModel arucoModel;
+    SoftwareRasterizer arucoRasterizer;
+    RasterShading arucoShading;
+    // Bounded history of live board poses, optionally streamed to disk (--pose-history, --pose-log)
+    PoseHistory arucoPoses;
+    // Saved calibration images and the --record video are encoded off the frame loop
+    FrameWriter arucoWriter;
+};
+
+ArucoVideoSession::ArucoVideoSession()
+    : numOfCalibrationImages(0), aspectRatio(1), isCalibrated(false), areVariablesInitialized(false),
+      arucoCalibration(0, 5), appliedArucoCalibration(0), arucoShading(SHADING_GOURAUD)
+{
+    arucoCubeMesh = arucoOverlay.addMesh(makeCubeMesh(40, 25, 45), Scalar(0, 0, 0), 1, true, Scalar(0, 200, 255));
+}
 
 /**
  * @brief Get the current date and time as a formatted string.
@@ -55,7 +106,7 @@ bool areVariablesInitialized = false;
  *
  * @return string The current date and time as a formatted string.
  */
-string getCurrentDateTimeStamp()
+static string getCurrentDateTimeStamp()
 {
     auto now = chrono::system_clock::now();
     time_t currentTime = chrono::system_clock::to_time_t(now);
@@ -74,7 +125,7 @@ string getCurrentDateTimeStamp()
  */
 void createArucoMarker(int markerId)
 {
-    cout << "Creating new Aruco marker..." << endl;
+    LOG_INFO("Creating new Aruco marker...");
     Mat markerImage;
     aruco::Dictionary arucoDict = aruco::getPredefinedDictionary(aruco::DICT_6X6_250);
     int markerSize = 200;
@@ -89,79 +140,29 @@ void createArucoMarker(int markerId)
  */
 void createArucoBoard()
 {
-    cout << "Creating new Aruco board..." << endl;
-    dict = aruco::getPredefinedDictionary(aruco::DICT_6X6_250);
+    LOG_INFO("Creating new Aruco board...");
+    aruco::Dictionary dict = aruco::getPredefinedDictionary(aruco::DICT_6X6_250);
     Mat boardImage;
     aruco::GridBoard board = aruco::GridBoard(Size(markersX, markersY), markerLength, markerSeparation, dict);
     string filename = "aruco_board_" + getCurrentDateTimeStamp() + ".png";
     board.generateImage(boardSize, boardImage, margins, borderBits);
     imwrite(filename, boardImage);
-    cout << "Aruco board created and saved to " << filename << endl;
-}
-
-/**
- * @brief Detects and draws Aruco markers in the video stream
- *
- * @param src The source image
- * @param estimatePose Flag to estimate the pose of the markers
- * @return void
- */
-void detectAndDrawMarkers(Mat &src, bool estimatePose = false, bool showRejected = false)
-{
-    aruco::GridBoard board = aruco::GridBoard(Size(markersX, markersY), markerLength, markerSeparation, dict);
-
-    arucoBoard = makePtr<aruco::Board>(board);
-    // cout << "Aruco Board: " << board << endl;
-    // cout << "Marker Size: " << board.getMarkerLength() << endl;
-    // cout << "Marker Separation: " << board.getMarkerSeparation() << endl;
-    // cout << "Number of markers: " << board.getGridSize().area() << endl;
-    // cout << "Board Size: " << board.getObjPoints() << endl;
-
-    aruco::ArucoDetector detector(dict, detectorParams);
-    detector.detectMarkers(src, markerCorners, markerIds, rejectedCandidates);
-
-    int markersDetected = 0;
-    // if (!markerIds.empty())
-    // {
-    //     Mat objPoints, imgPoints;
-    //     board.matchImagePoints(markerCorners, markerIds, objPoints, imgPoints);
-    //     solvePnP(objPoints, imgPoints, cameraMatrix, distCoeffs, rvecs, tvecs);
-    //     markersDetected = (int)objPoints.total() / 4;
-    //     aruco::estimatePoseSingleMarkers(markerCorners, markerLength, cameraMatrix, distCoeffs, rvecs, tvecs);
-    //     // for (int i = 0; i < markerIds.size(); i++)
-    //     // {
-    //     //     aruco::drawAxis(src, cameraMatrix, distCoeffs, rvecs[i], tvecs[i], markerLength * 0.5f);
-    //     // }
-    // }
-
-    if (markerIds.size() > 0)
-    {
-        aruco::drawDetectedMarkers(src, markerCorners, markerIds);
-    }
-
-    if (showRejected && !rejectedCandidates.empty())
-    {
-        aruco::drawDetectedMarkers(src, rejectedCandidates, noArray(), Scalar(100, 0, 255));
-    }
-
-    // if (estimatePose)
-    // {
-    //     drawFrameAxes(src, cameraMatrix, distCoeffs, rvecs, tvecs, markerLength * 0.5f);
-    // }
+    LOG_INFO("Aruco board created and saved to " << filename);
 }
 
 /**
  * @brief Prints the calibration variables to the console
  */
-void printCalibrationVariables()
+void ArucoVideoSession::printCalibrationVariables()
 {
-    // Iterating over corner_list and comparing each corner to the point_set
+    // Iterating over the saved views and comparing each corner to the point_set
+    vector<vector<Point2f>> corner_list = arucoCalibration.viewImagePoints();
     for (size_t i = 0; i < corner_list.size(); i++)
     {
-        for (size_t j = 0; j < corner_list[i].size(); j++)
+        for (size_t j = 0; j < corner_list[i].size() && j < point_set.size(); j++)
         {
-            cout << "Corner " << i + 1 << ": " << corner_list[i][j] << endl;
-            cout << "Point " << i + 1 << ": " << point_set[j] << endl;
+            LOG_DEBUG("Corner " << i + 1 << ": " << corner_list[i][j]);
+            LOG_DEBUG("Point " << i + 1 << ": " << point_set[j]);
         }
     }
 }
@@ -170,8 +171,9 @@ void printCalibrationVariables()
  * @brief Saves the calibration variables to a file
  *
  * @param reprojectionError The reprojection error
+ * @param markerCorners The marker corners of the current frame
  */
-void saveCalibrationVariables(double reprojectionError = 0.0)
+void ArucoVideoSession::saveCalibrationVariables(double reprojectionError, const vector<vector<Point2f>> &markerCorners)
 {
     string filename = "calibration_variables_" + getCurrentDateTimeStamp() + ".xml";
     FileStorage fs(filename, FileStorage::WRITE);
@@ -182,7 +184,8 @@ void saveCalibrationVariables(double reprojectionError = 0.0)
     fs << "dist_coeffs" << distCoeffs;
     fs << "reprojection_error" << reprojectionError;
     fs << "point_set" << point_set;
-    fs << "corner_list" << corner_list;
+    // Image points of the views held by the calibration worker
+    fs << "corner_list" << arucoCalibration.viewImagePoints();
     fs << "marker_corners" << markerCorners;
     fs.release();
 }
@@ -191,16 +194,19 @@ void saveCalibrationVariables(double reprojectionError = 0.0)
  * @brief Saves the calibration image to a file
  *
  * @param src The source image
+ * @param markerCorners The marker corners detected in src
+ * @param markerIds The marker ids detected in src
  * @param calibrationDirectory The directory to save the calibration images
- * @return void
+ * @return true if the image was saved as a calibration view
  */
-void saveCalibrationImage(Mat &src, string calibrationDirectory = defaultCalibrationDirectory)
+bool ArucoVideoSession::saveCalibrationImage(Mat &src, const vector<vector<Point2f>> &markerCorners,
+                                             const vector<int> &markerIds, string calibrationDirectory)
 {
     // TODO: Add some error handling for the directory and validation for the image
 
-    cout << "Marker Corners vs point_set: " << endl;
-    cout << "Marker Corners: " << markerCorners.size() << endl;
-    cout << "Point Set: " << point_set.size() << endl;
+    LOG_INFO("Marker Corners vs point_set: ");
+    LOG_INFO("Marker Corners: " << markerCorners.size());
+    LOG_INFO("Point Set: " << point_set.size());
 
     vector<Point2f> corners;
 
@@ -219,38 +225,28 @@ void saveCalibrationImage(Mat &src, string calibrationDirectory = defaultCalibra
 
     if (corners.size() != point_set.size())
     {
-        cerr << "\n===========\nError: The number of corners and points do not match\n===========\n" << endl;
-        return;
+        LOG_ERROR("\n===========\nError: The number of corners and points do not match\n===========\n");
+        return false;
     }
 
-    corner_list.push_back(corners);
-    // aruco::GridBoard board =
-    //     aruco::GridBoard(Size(markersX, markersY), markerLength, markerSeparation, dict);
-    // cout << "Object Points: " << board.getObjPoints()[0] << endl;
-    point_list.push_back(point_set);
-    markerCounterPerFrame.push_back((int)markerIds.size());
-    markerIdsCopy = markerIds;
-
     string filename = calibrationDirectory + to_string(numOfCalibrationImages) + "_calibration_image.png";
-    imwrite(filename, src);
+    filename = arucoWriter.saveImage(filename, src);
     numOfCalibrationImages++;
-    cout << "Calibration image saved" << endl;
-    calibrationImages.push_back(src);
-
-    cout << "Number of calibration images: " << numOfCalibrationImages << endl;
-    cout << "Number of corner sets: " << corner_list.size() << endl;
-    cout << "Number of corners in last set: " << corner_list[corner_list.size() - 1].size() << endl;
-    cout << "Number of points: " << point_list.size() << endl;
-    cout << "Number of points in last set: " << point_list[point_list.size() - 1].size() << endl;
-    cout << "Number of marker ids: " << markerIds.size() << endl;
-    cout << "Number of marker ids in last set: " << markerCounterPerFrame[markerCounterPerFrame.size() - 1] << endl;
-    cout << "Number of marker corners: " << markerCorners.size() << endl;
-    cout << "Number of marker corners in last set: " << markerCorners[markerCorners.size() - 1].size() << endl;
-    cout << "Number of rejected candidates: " << rejectedCandidates.size() << endl;
-
-    cout << "\n" << endl;
+    if (!filename.empty())
+    {
+        LOG_INFO("Calibration image queued as " << filename);
+    }
+
+    LOG_INFO("Number of calibration images: " << numOfCalibrationImages);
+    LOG_INFO("Number of corners in this view: " << corners.size());
+    LOG_INFO("Number of marker ids: " << markerIds.size());
+    LOG_INFO("Number of marker corners: " << markerCorners.size());
+    LOG_INFO("Number of marker corners in last set: " << markerCorners[markerCorners.size() - 1].size());
+
+    LOG_INFO("\n");
 
     // printCalibrationVariables();
+    return true;
 }
 
 /**
@@ -258,18 +254,16 @@ void saveCalibrationImage(Mat &src, string calibrationDirectory = defaultCalibra
  *
  * @return void
  */
-void initializeVariables()
+void ArucoVideoSession::initializeVariables()
 {
-    cout << "Initializing variables..." << endl;
+    LOG_INFO("Initializing variables...");
     numOfCalibrationImages = 0;
-    dict = aruco::getPredefinedDictionary(aruco::DICT_6X6_250);
-    detectorParams = aruco::DetectorParameters();
     aspectRatio = 1;
     double focalLength = frame.cols;
-    cout << "Focal Length: " << focalLength << endl;
-    cout << "Frame width: " << frame.cols << endl;
-    cout << "Frame height: " << frame.rows << endl;
-    cout << "Aspect Ratio: " << aspectRatio << endl;
+    LOG_INFO("Focal Length: " << focalLength);
+    LOG_INFO("Frame width: " << frame.cols);
+    LOG_INFO("Frame height: " << frame.rows);
+    LOG_INFO("Aspect Ratio: " << aspectRatio);
 
     distCoeffs = Mat::zeros(5, 1, CV_64F);
     // distCoeffs = Mat::zeros(8, 1, CV_64F);
@@ -314,53 +308,394 @@ void initializeVariables()
         }
     }
 
-    cout << "Point Set Size: " << point_set.size() << endl;
-    cout << "Camera Matrix" << cameraMatrix << endl;
+    LOG_INFO("Point Set Size: " << point_set.size());
+    LOG_INFO("Camera Matrix" << cameraMatrix);
 
     areVariablesInitialized = true;
-    cout << "Variables initialized! \n" << endl;
+    LOG_INFO("Variables initialized! \n");
 }
 
 /**
- * @brief Starts the video stream and applies the Aruco marker detection algorithm
+ * @brief Picks up a calibration finished by the background worker (never waits for one) and shows its progress
  *
- * @param cameraCalibrationFile The file containing the camera calibration parameters
+ * @param display The frame being shown
+ * @param markerCorners The marker corners of the displayed frame
  */
-int videoStreaming(string cameraCalibrationFile)
+void ArucoVideoSession::updateCalibration(Mat &display, const vector<vector<Point2f>> &markerCorners)
 {
-    VideoCapture cap(0);
-    if (!cap.isOpened())
+    shared_ptr<const CalibrationSnapshot> calibration = arucoCalibration.latest();
+    if (calibration && calibration->version != appliedArucoCalibration)
     {
-        cerr << "Error opening video stream" << endl;
-        return -1;
+        calibration->cameraMatrix.copyTo(cameraMatrix);
+        calibration->distCoeffs.copyTo(distCoeffs);
+        appliedArucoCalibration = calibration->version;
+        isCalibrated = true;
+
+        LOG_INFO("\nCalibration " << calibration->version << " (" << calibration->usedViews << " of "
+                 << calibration->views << " views, " << calibration->solveMs << " ms in the background)");
+        LOG_INFO("Reprojection Error: " << calibration->reprojectionError);
+        LOG_INFO("Camera Matrix:\n " << cameraMatrix);
+        LOG_INFO("Distortion Coefficients: " << distCoeffs.t());
+        saveCalibrationVariables(calibration->reprojectionError, markerCorners);
+    }
+    if (arucoCalibration.solving())
+    {
+        putText(display, "Calibrating with " + to_string(arucoCalibration.views()) + " views...", Point(10, 90),
+                FONT_HERSHEY_SIMPLEX, .75, Scalar(0, 0, 255), 2);
+    }
+}
+
+/**
+ * @brief Estimates the board pose from the detected markers and draws the cube overlay and the board axes once the
+ * camera is calibrated. The
+ * estimator is warm-started from the previous frame, so it must be fed frames in display order.
+ *
+ * @param display The frame being shown
+ * @param estimator Pose estimator holding the previous frame's pose
+ * @param markerCorners The marker corners of the displayed frame
+ * @param markerIds The marker ids of the displayed frame
+ * @param arucoBoard The board being tracked
+ * @param undistorted True when the markers were detected on an undistorted frame
+ * @param frameNumber Frame number recorded with the pose
+ */
+void ArucoVideoSession::drawBoardPose(Mat &display, PoseEstimator &estimator,
+                                      const vector<vector<Point2f>> &markerCorners, const vector<int> &markerIds,
+                                      Ptr<aruco::Board> arucoBoard, bool undistorted, long long frameNumber)
+{
+    if (!isCalibrated || cameraMatrix.empty())
+    {
+        estimator.reset();
+        return;
+    }
+    Mat poseDistortion = undistorted ? Mat() : distCoeffs;
+    Mat rvec, tvec;
+    ScopedStageTimer poseTimer(STAGE_POSE);
+    bool found =
+        estimator.estimateBoard(arucoBoard, markerCorners, markerIds, cameraMatrix, poseDistortion, rvec, tvec);
+    poseTimer.stop();
+    if (found)
+    {
+        ScopedStageTimer drawTimer(STAGE_DRAW);
+        arucoPoses.push(frameNumber, rvec, tvec);
+        if (!arucoModel.empty())
+        {
+            arucoRasterizer.beginFrame(display.size());
+            arucoRasterizer.draw(display, arucoModel, rvec, tvec, cameraMatrix, poseDistortion, Scalar(80, 180, 255),
+                                 arucoShading);
+        }
+        else
+        {
+            arucoOverlay.clearInstances();
+            arucoOverlay.addInstance(arucoCubeMesh, rvec, tvec);
+            arucoOverlay.render(display, cameraMatrix, poseDistortion);
+        }
+        drawFrameAxes(display, cameraMatrix, poseDistortion, rvec, tvec, (float)(markerLength * 2), 2);
+    }
+}
+
+/**
+ * @brief Handles a key press in the Aruco video stream (save, calibrate, quit)
+ *
+ * @param key The key that was pressed
+ * @param markerCorners The marker corners of the displayed frame
+ * @param markerIds The marker ids of the displayed frame
+ * @param arucoBoard The board being tracked
+ * @param undistortedWith Maps the frame was undistorted with (null for a raw frame); saved views are mapped back to
+ * raw-frame points so the calibration never mixes raw and undistorted corners
+ * @return false when the user asked to quit
+ */
+bool ArucoVideoSession::handleVideoStreamKey(char key, const vector<vector<Point2f>> &markerCorners,
+                                             const vector<int> &markerIds, Ptr<aruco::Board> arucoBoard,
+                                             const UndistortMaps *undistortedWith)
+{
+    if (key == 'q' || key == 'Q')
+    {
+        LOG_INFO("User terminated program");
+        return false;
+    }
+    if (key == 's' || key == 'S')
+    {
+        LOG_INFO("Saving frame");
+        if (saveCalibrationImage(frameCopy, markerCorners, markerIds, defaultCalibrationDirectory))
+        {
+            vector<Point3f> objectPoints;
+            vector<Point2f> imagePoints;
+            arucoBoard->matchImagePoints(markerCorners, markerIds, objectPoints, imagePoints);
+            if (undistortedWith)
+            {
+                vector<Point2f> rawPoints;
+                undistortedWith->distortPoints(imagePoints, rawPoints);
+                imagePoints.swap(rawPoints);
+            }
+            arucoCalibration.addView(objectPoints, imagePoints, frame.size());
+        }
+    }
+    if (key == 'c' || key == 'C')
+    {
+        LOG_INFO("Calibrating camera");
+        if (numOfCalibrationImages >= 5)
+        {
+            // Solves on the worker thread; every later 's' re-solves from the current intrinsics
+            LOG_INFO("User began calibration, running in the background");
+            arucoCalibration.start();
+        }
+        else
+        {
+            LOG_INFO("Need at least 5 calibration images");
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Undistorts frame in place once the camera is calibrated, rebuilding the maps when the calibration or frame
+ * size changes
+ *
+ * @param frame The frame to undistort
+ * @param maps The cached maps
+ * @param undistorted Scratch frame, swapped with frame
+ * @param calibrationFile The calibration file the maps are cached next to ("" for no cache)
+ * @param timing Per-frame cost
+ */
+void ArucoVideoSession::undistortFrame(Mat &frame, Ptr<UndistortMaps> &maps, Mat &undistorted,
+                                       const string &calibrationFile, UndistortTiming &timing)
+{
+    if (!isCalibrated || cameraMatrix.empty())
+    {
+        return;
+    }
+    if (!maps || !maps->matches(cameraMatrix, distCoeffs, frame.size()))
+    {
+        maps = loadOrBuildUndistortMaps(cameraMatrix, distCoeffs, frame.size(), calibrationFile);
+    }
+    ScopedStageTimer undistortTimer(STAGE_UNDISTORT);
+    int64 start = getTickCount();
+    maps->apply(frame, undistorted);
+    swap(frame, undistorted);
+    timing.add((getTickCount() - start) * 1000.0 / getTickFrequency());
+}
+
+/**
+ * @brief Runs the Aruco video stream as a capture -> detect -> render pipeline. Capture and detection run on their
+ * own threads; the render stage (display, keys, calibration) stays on this thread so the GUI calls are safe.
+ *
+ * @param source The frame source
+ * @param options Stream options (workers, queue capacity, headless)
+ * @param calibrationFile The calibration file undistortion maps are cached next to
+ */
+int ArucoVideoSession::runPipelined(FrameSource &source, const StreamOptions &options, const string &calibrationFile)
+{
+    // Maps are built by the render stage and read by the detection workers
+    shared_ptr<const UndistortMaps> undistortMaps;
+    vector<UndistortTiming> undistortTiming(options.workers);
+
+    // With several workers each tracker only sees every Nth frame, so its predicted regions would be N frames old
+    bool roiTracking = options.roiTracking && options.workers == 1;
+    if (options.roiTracking && !roiTracking)
+    {
+        LOG_WARN("ROI tracking needs consecutive frames; disabled with " << options.workers << " detection workers");
+    }
+
+    // One tracker per worker, built before the workers start
+    vector<Ptr<ArucoTracker>> trackers;
+    for (int i = 0; i < options.workers; i++)
+    {
+        trackers.push_back(makePtr<ArucoTracker>(aruco::DICT_6X6_250, Size(markersX, markersY), (float)markerLength,
+                                                 (float)markerSeparation, detectorParams));
+        trackers.back()->setRoiTracking(roiTracking, options.fullSearchInterval);
+    }
+    Ptr<aruco::Board> arucoBoard = trackers[0]->board();
+    // Frames reach the render stage in capture order, so the board pose is estimated there
+    PoseEstimator boardPose;
+
+    LOG_INFO("Running pipeline with " << options.workers << " detection workers, queue capacity "
+             << options.queueCapacity);
+
+    DetectStage detect = [&](int workerIndex, PipelineFrame &pipelineFrame) {
+        ArucoTracker &tracker = *trackers[workerIndex];
+        shared_ptr<const UndistortMaps> maps = atomic_load(&undistortMaps);
+        pipelineFrame.undistorted = maps && maps->size() == pipelineFrame.image.size();
+        if (pipelineFrame.undistorted)
+        {
+            ScopedStageTimer undistortTimer(STAGE_UNDISTORT);
+            int64 start = getTickCount();
+            Mat undistorted;
+            maps->apply(pipelineFrame.image, undistorted);
+            pipelineFrame.image = undistorted;
+            pipelineFrame.undistortMaps = maps;
+            undistortTiming[workerIndex].add((getTickCount() - start) * 1000.0 / getTickFrequency());
+        }
+        pipelineFrame.image.copyTo(pipelineFrame.output);
+        ScopedStageTimer detectTimer(STAGE_DETECT);
+        tracker.detect(pipelineFrame.output);
+        detectTimer.stop();
+        ScopedStageTimer drawTimer(STAGE_DRAW);
+        tracker.draw(pipelineFrame.output);
+        pipelineFrame.markerCorners = tracker.corners();
+        pipelineFrame.markerIds = tracker.ids();
+        putText(pipelineFrame.output, "Number of markers detected: " + to_string(pipelineFrame.markerIds.size()),
+                Point(10, 30), FONT_HERSHEY_SIMPLEX, .75, Scalar(0, 0, 255), 2);
+    };
+
+    RenderStage render = [&](PipelineFrame &pipelineFrame, double latencyMs) {
+        ScopedStageTimer frameTimer(STAGE_FRAME);
+        frame = pipelineFrame.image;
+        frameCopy = pipelineFrame.output;
+        if (!areVariablesInitialized)
+        {
+            initializeVariables();
+        }
+
+        stringstream latencyText;
+        latencyText << "Latency: " << fixed << setprecision(1) << latencyMs << " ms";
+        putText(frameCopy, latencyText.str(), Point(10, 60), FONT_HERSHEY_SIMPLEX, .75, Scalar(0, 0, 255), 2);
+
+        updateCalibration(frameCopy, pipelineFrame.markerCorners);
+        drawBoardPose(frameCopy, boardPose, pipelineFrame.markerCorners, pipelineFrame.markerIds, arucoBoard,
+                      pipelineFrame.undistorted, pipelineFrame.sequence);
+        if (options.undistort && isCalibrated)
+        {
+            shared_ptr<const UndistortMaps> maps = atomic_load(&undistortMaps);
+            if (!maps || !maps->matches(cameraMatrix, distCoeffs, frame.size()))
+            {
+                shared_ptr<const UndistortMaps> rebuilt =
+                    loadOrBuildUndistortMaps(cameraMatrix, distCoeffs, frame.size(), calibrationFile);
+                atomic_store(&undistortMaps, rebuilt);
+            }
+        }
+
+        ScopedStageTimer writeTimer(STAGE_WRITE);
+        arucoWriter.record(frameCopy);
+        writeTimer.stop();
+
+        // Short poll: the pipeline keeps capturing and detecting while we wait for a key
+        ScopedStageTimer displayTimer(STAGE_DISPLAY);
+        char key = presentFrame("Video Stream", frameCopy, options, 1);
+        displayTimer.stop();
+        return handleVideoStreamKey(key, pipelineFrame.markerCorners, pipelineFrame.markerIds, arucoBoard,
+                                    pipelineFrame.undistortMaps.get());
+    };
+
+    PipelineStats stats = runStreamPipeline(source, options.workers, options.queueCapacity, options.maxFrames,
+                                            detect, render);
+    stats.report("Aruco detection pipeline");
+    boardPose.stats().report();
+    arucoOverlay.stats().report();
+    if (!arucoModel.empty())
+    {
+        arucoRasterizer.stats().report();
+    }
+    arucoPoses.report();
+    reportSessionMemory();
+    arucoWriter.flush();
+    arucoWriter.stats().report();
+    finishStageTimes("Aruco detection", options.statsFile);
+    for (size_t i = 0; i < undistortTiming.size(); i++)
+    {
+        if (undistortTiming[i].frames > 0)
+        {
+            LOG_INFO("Worker " << i << ":");
+            undistortTiming[i].report();
+        }
     }
+    if (roiTracking)
+    {
+        for (size_t i = 0; i < trackers.size(); i++)
+        {
+            LOG_INFO("Worker " << i << ":");
+            trackers[i]->roiStats().report();
+        }
+    }
+    return 0;
+}
 
+/**
+ * @brief Runs the interactive loop over source (or the pipeline when options.workers > 0)
+ *
+ * @param source The frame source
+ * @param cameraCalibrationFile The file containing the camera calibration parameters
+ * @param options Frame source and headless settings
+ */
+int ArucoVideoSession::run(FrameSource &source, const string &cameraCalibrationFile, const StreamOptions &options)
+{
     if (cameraCalibrationFile != "")
     {
         readCameraParameters(cameraMatrix, distCoeffs, cameraCalibrationFile);
         isCalibrated = true;
     }
 
-    cout << "\nWelcome to the Augmented Reality Application\n" << endl;
-    cout << "Press 'q' to quit the program" << endl;
-    cout << "Press 's' to save a calibration image" << endl;
-    cout << "Press 'c' to calibrate the camera" << endl;
-    cout << "\n" << endl;
+    LOG_INFO("\nWelcome to the Augmented Reality Application\n");
+    LOG_INFO("Press 'q' to quit the program");
+    LOG_INFO("Press 's' to save a calibration image");
+    LOG_INFO("Press 'c' to calibrate the camera");
+    LOG_INFO("\n");
 
     // calibrationDirectory = calibrationDirectory == "" ? defaultCalibrationDirectory : calibrationDirectory;
-    namedWindow("Video Stream", WINDOW_AUTOSIZE);
+    if (!options.headless)
+    {
+        namedWindow("Video Stream", WINDOW_AUTOSIZE);
+    }
 
-    cout << "Initial Camera Matrix: " << cameraMatrix << endl;
+    if (!options.modelFile.empty())
+    {
+        if (!loadObjModel(options.modelFile, arucoModel))
+        {
+            return -1;
+        }
+        // Stands in the middle of the board, 60 units tall
+        placeObjModel(arucoModel, 60, Point2f(45, 65));
+        arucoShading = options.flatShading ? SHADING_FLAT : SHADING_GOURAUD;
+        LOG_INFO("Loaded model " << options.modelFile << " (" << arucoModel.triangles.size() << " triangles)");
+    }
 
-    while (true)
+    arucoPoses.setCapacity(options.poseHistory > 0 ? options.poseHistory : defaultPoseHistoryCapacity);
+    if (!options.poseLog.empty() && !arucoPoses.streamTo(options.poseLog))
     {
+        return -1;
+    }
+    configureFrameWriter(arucoWriter, options);
+    // Read before any tracker is built; every tracker copies detectorParams
+    if (!options.detectorParamsFile.empty())
+    {
+        if (!loadDetectorParameters(options.detectorParamsFile, detectorParams))
+        {
+            return -1;
+        }
+        LOG_INFO("Utilizing detector parameters file: " << options.detectorParamsFile);
+    }
+
+    LOG_INFO("Initial Camera Matrix: " << cameraMatrix);
+    LOG_INFO("Reading frames from " << source.describe());
+
+    if (options.workers > 0)
+    {
+        return runPipelined(source, options, cameraCalibrationFile);
+    }
+
+    ArucoTracker tracker(aruco::DICT_6X6_250, Size(markersX, markersY), (float)markerLength, (float)markerSeparation,
+                         detectorParams);
+    tracker.setRoiTracking(options.roiTracking, options.fullSearchInterval);
+    PoseEstimator boardPose;
+    long long frameNumber = 0;
+
+    Ptr<UndistortMaps> undistortMaps;
+    Mat undistorted;
+    UndistortTiming undistortTiming;
+    FrameRateCounter frameRate;
+    while (!frameLimitReached(frameRate, options))
+    {
+        ScopedStageTimer frameTimer(STAGE_FRAME);
+        ScopedStageTimer captureTimer(STAGE_CAPTURE);
         // Mat frame, frameCopy;
-        cap >> frame;
-        if (frame.empty())
+        if (!source.read(frame))
         {
-            cerr << "Error: Could not capture frame" << endl;
+            if (source.isLive())
+            {
+                LOG_ERROR("Error: Could not capture frame");
+            }
             break;
         }
+        captureTimer.stop();
         if (!areVariablesInitialized)
         {
             initializeVariables();
@@ -369,60 +704,78 @@ int videoStreaming(string cameraCalibrationFile)
         // flip image vertically
         // flip(frame, frame, 1);
 
+        bool frameUndistorted = options.undistort && isCalibrated && !cameraMatrix.empty();
+        if (frameUndistorted)
+        {
+            undistortFrame(frame, undistortMaps, undistorted, cameraCalibrationFile, undistortTiming);
+        }
+
         frame.copyTo(frameCopy);
-        imageSize = frame.size();
-        detectAndDrawMarkers(frameCopy);
+        ScopedStageTimer detectTimer(STAGE_DETECT);
+        tracker.detect(frameCopy);
+        detectTimer.stop();
 
+        ScopedStageTimer drawTimer(STAGE_DRAW);
+        tracker.draw(frameCopy);
         // display number of markers detected in window
-        putText(frameCopy, "Number of markers detected: " + to_string(markerIds.size()), Point(10, 30),
+        putText(frameCopy, "Number of markers detected: " + to_string(tracker.ids().size()), Point(10, 30),
                 FONT_HERSHEY_SIMPLEX, .75, Scalar(0, 0, 255), 2);
-
-        imshow("Video Stream", frameCopy);
-
-        char key = waitKey(10);
-        if (key == 'q' || key == 'Q')
+        drawTimer.stop();
+
+        updateCalibration(frameCopy, tracker.corners());
+        drawBoardPose(frameCopy, boardPose, tracker.corners(), tracker.ids(), tracker.board(), frameUndistorted,
+                      frameNumber++);
+        ScopedStageTimer writeTimer(STAGE_WRITE);
+        arucoWriter.record(frameCopy);
+        writeTimer.stop();
+
+        frameRate.tick();
+        ScopedStageTimer displayTimer(STAGE_DISPLAY);
+        char key = presentFrame("Video Stream", frameCopy, options);
+        displayTimer.stop();
+        if (!handleVideoStreamKey(key, tracker.corners(), tracker.ids(), tracker.board(),
+                                  frameUndistorted ? undistortMaps.get() : 0))
         {
-            cout << "User terminated program" << endl;
             break;
         }
-        if (key == 's' || key == 'S')
-        {
-            cout << "Saving frame" << endl;
-            saveCalibrationImage(frameCopy, defaultCalibrationDirectory);
-            waitKey(500);
-        }
-        if (key == 'c' || key == 'C')
-        {
-            cout << "Calibrating camera" << endl;
-            if (numOfCalibrationImages >= 5)
-            {
-                // TODO: Make sure that this calibration call allows the video loop to continue
-                cout << "User began calibration" << endl;
-                arucoBoard->matchImagePoints(markerCorners, markerIds, point_set, corner_list);
-                // double result = calibrateCamera(cameraMatrix, distCoeffs, boardSize, point_list, corner_list);
-                double result = calibrateCamera(cameraMatrix, distCoeffs, imageSize, point_list, corner_list, rvecs,
-                                                tvecs, markerIdsCopy, markerCounterPerFrame, arucoBoard);
-                // double result = calibrateCamera(cameraMatrix, distCoeffs, imageSize, point_list, corner_list, rvecs,
-                //                                 tvecs);
-                saveCalibrationVariables(result);
-
-                if (result > 0)
-                {
-                    cout << "Camera calibration successful" << endl;
-                    isCalibrated = true;
-                }
-                else
-                {
-                    cout << "Camera calibration failed" << endl;
-                }
-            }
-            else
-            {
-                cout << "Need at least 5 calibration images" << endl;
-            }
-            continue;
-        }
     }
 
+    frameRate.report("Aruco detection");
+    undistortTiming.report();
+    boardPose.stats().report();
+    arucoOverlay.stats().report();
+    if (!arucoModel.empty())
+    {
+        arucoRasterizer.stats().report();
+    }
+    arucoPoses.report();
+    reportSessionMemory();
+    arucoWriter.flush();
+    arucoWriter.stats().report();
+    finishStageTimes("Aruco detection", options.statsFile);
+    LOG_INFO("Frames that reallocated tracker buffers: " << tracker.bufferReallocations() << " of "
+             << tracker.frames());
+    if (options.roiTracking)
+    {
+        tracker.roiStats().report();
+    }
     return 0;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Starts the video stream and applies the Aruco marker detection algorithm
+ *
+ * @param cameraCalibrationFile The file containing the camera calibration parameters
+ * @param options Frame source and headless settings
+ */
+int videoStreaming(string cameraCalibrationFile, const StreamOptions &options)
+{
+    Ptr<FrameSource> source = openFrameSource(options.source);
+    if (!source->isOpened())
+    {
+        LOG_ERROR("Error opening video stream: " << source->describe());
+        return -1;
+    }
+    ArucoVideoSession session;
+    return session.run(*source, cameraCalibrationFile, options);
+}
@@ -7,9 +7,20 @@
 #include <opencv2/opencv.hpp>
 
 #include "../include/aruco_utils.h"
+#include "../include/batch_calibration.h"
+#include "../include/calibration_file.h"
 #include "../include/camera_utils.h"
+#include "../include/charuco_utils.h"
 #include "../include/chessboard_utils.h"
+#include "../include/detector_tuning.h"
+#include "../include/frame_source.h"
 #include "../include/harris_detection.h"
+#include "../include/logger.h"
+#include "../include/multi_detector.h"
+#include "../include/overlay_renderer.h"
+#include "../include/software_rasterizer.h"
+#include "../include/stage_timer.h"
+#include "../include/stream_session.h"
 
 using namespace std;
 
@@ -18,19 +29,211 @@ using namespace std;
  */
 void printUsage()
 {
+    // Anything logged before (e.g. the reason for the usage message) comes first
+    logFlush();
     cout << "Usage: ./augment_reality.exe [options] (arguments)\n"
          << "Options:\n"
          << "  -a --aruco\t\tCreate new Aruco board \n"
          << "  -v --video\t\tInitiate video stream  \n"
          << "  -c --chessboard\tDetect and calibrate using chessboard\n"
+         << "  -ch --charuco\t\tDetect and calibrate using the ChArUco board (partial views are fine)\n"
          << "  -hc --harriscorner\tDetect Harris Corners\n"
+         << "  -md --multi-detect\tRun Aruco, chessboard and Harris detection concurrently on every frame\n"
+         << "  -bc --bench-chessboard [dir]\tCompare single-scale and coarse-to-fine chessboard detection\n"
+         << "  -bp --bench-pose [calibration]\tTime warm-started pose estimation against solvePnP per frame\n"
+         << "\t\t\t(frames from --source, default: ../img/CameraCalibration)\n"
+         << "  -bo --bench-overlay [n]\tTime per-object overlay drawing against the batched renderer (1..n objects)\n"
+         << "  -br --bench-raster [model.obj]\tTime the software rasterizer on 1080p frames (--frames n, default 100)\n"
+         << "  -bh --bench-harris [dir]\tCheck the fused Harris kernel against cornerHarris and time it\n"
+         << "  -bcal --batch-calibrate <dir> [chessboard|aruco|charuco] [output.xml]\n"
+         << "\t\t\tCalibrate offline from a directory of images on all cores (--workers n to limit)\n"
+         << "  -cc --convert-calibration <in> <out>\tConvert a calibration file (XML/YAML <-> .bin binary)\n"
+         << "  -td --tune-detector <dir> [params.yml]\tSearch Aruco detector parameters for speed vs. recall on\n"
+         << "\t\t\trecorded images and write the chosen ones (--workers n to limit)\n"
+         << "  -ms --multi-stream <source>...\tDetect on several sources at once, headless, on a shared thread pool\n"
+         << "\t\t\t(--workers n, default: one per core; --detector picks the target)\n"
          << "  -h or --help\t\tShow this help message\n"
+         << "Stream options (for -v, -c, -ch, -hc, -md):\n"
+         << "  --source <spec>\tCamera index, video file, image directory, or mem:<dir> (default: camera 0)\n"
+         << "  --headless\t\tNo windows, process frames as fast as possible and report fps\n"
+         << "  --frames <n>\t\tStop after n frames\n"
+         << "  --workers <n>\t\tRun -v as a capture/detect/render pipeline with n detection threads\n"
+         << "  --queue <n>\t\tFrames buffered before the oldest is dropped (1-1024, default: 4)\n"
+         << "  --roi-tracking\t\tSearch for markers only around the previous frame's markers (-v, not with --workers > 1)\n"
+         << "  --full-search-interval <n>\tFull-frame marker search at least every n frames (default: 30)\n"
+         << "  --undistort\t\tUndistort frames with cached remap tables once calibrated (-v, -c)\n"
+         << "  --redetect-interval <n>\tTrack the chessboard with optical flow, re-detect every n frames (-c,\n"
+         << "\t\t\t-ms --detector chessboard, default: 30, 0 = detect every frame)\n"
+         << "  --model <file.obj>\tRasterize an OBJ model on the board once calibrated (-v, -c)\n"
+         << "  --flat-shading\t\tShade the model per face instead of per vertex\n"
+         << "  --pose-history <n>\tBoard poses kept in memory (-v, -c, default: 1024)\n"
+         << "  --pose-log <file.csv>\tStream every board pose to a CSV file (-v, -c)\n"
+         << "  --png-compression <0-9>\tCompression of saved PNG frames (0 = uncompressed, fastest)\n"
+         << "  --raw-images\t\tSave frames as uncompressed binary PPM\n"
+         << "  --record <file>\tRecord the annotated stream to a video file (.avi MJPG, .mp4 mp4v)\n"
+         << "  --record-fps <fps>\tFrame rate stored in the recording (default: 30)\n"
+         << "  --stats\t\tTime every stage and print p50/p95/p99/max per stage on exit\n"
+         << "  --stats-file <file>\tAlso write the stage times as CSV, or JSON for a .json file (implies --stats)\n"
+         << "  --calibration <file>\tCalibration used by every stream of -ms\n"
+         << "  --pin-threads\t\tPin each -ms worker to its own core (Linux)\n"
+         << "  --detector <name>\tWhat every -ms stream detects: aruco, chessboard or harris (default: aruco)\n"
+         << "  --detector-params <file>\tAruco detector parameters written by -td (-v, -ms, -bcal aruco)\n"
+         << "  --log-level <level>\ttrace, debug, info, warn, error or off (default: info)\n"
          << endl;
 }
 
+/**
+ * @brief Parses the stream options that follow the mode flag. Anything that is not an option is returned as a
+ * positional argument (e.g. the calibration file).
+ *
+ * @param argc argument count
+ * @param argv argument values
+ * @param options parsed stream options
+ * @param positional remaining positional arguments
+ * @return false if an option is missing its value or has an invalid one
+ */
+bool parseStreamOptions(int argc, char *argv[], StreamOptions &options, vector<string> &positional)
+{
+    for (int i = 2; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--headless")
+        {
+            options.headless = true;
+        }
+        else if (arg == "--roi-tracking")
+        {
+            options.roiTracking = true;
+        }
+        else if (arg == "--undistort")
+        {
+            options.undistort = true;
+        }
+        else if (arg == "--flat-shading")
+        {
+            options.flatShading = true;
+        }
+        else if (arg == "--raw-images")
+        {
+            options.rawImages = true;
+        }
+        else if (arg == "--stats")
+        {
+            options.stats = true;
+        }
+        else if (arg == "--pin-threads")
+        {
+            options.pinThreads = true;
+        }
+        else if (arg == "--source" || arg == "--frames" || arg == "--workers" || arg == "--queue" ||
+                 arg == "--full-search-interval" || arg == "--redetect-interval" || arg == "--model" ||
+                 arg == "--pose-history" || arg == "--pose-log" || arg == "--png-compression" || arg == "--record" ||
+                 arg == "--record-fps" || arg == "--stats-file" || arg == "--log-level" || arg == "--calibration" ||
+                 arg == "--detector-params" || arg == "--detector")
+        {
+            if (i + 1 >= argc)
+            {
+                LOG_ERROR("Missing value for " << arg);
+                return false;
+            }
+            if (arg == "--source")
+            {
+                options.source = argv[++i];
+            }
+            else if (arg == "--frames")
+            {
+                options.maxFrames = atoi(argv[++i]);
+            }
+            else if (arg == "--workers")
+            {
+                options.workers = atoi(argv[++i]);
+            }
+            else if (arg == "--full-search-interval")
+            {
+                options.fullSearchInterval = atoi(argv[++i]);
+            }
+            else if (arg == "--redetect-interval")
+            {
+                options.chessboardRedetectInterval = atoi(argv[++i]);
+            }
+            else if (arg == "--model")
+            {
+                options.modelFile = argv[++i];
+            }
+            else if (arg == "--pose-history")
+            {
+                options.poseHistory = atoi(argv[++i]);
+            }
+            else if (arg == "--pose-log")
+            {
+                options.poseLog = argv[++i];
+            }
+            else if (arg == "--png-compression")
+            {
+                options.pngCompression = atoi(argv[++i]);
+            }
+            else if (arg == "--record")
+            {
+                options.recordFile = argv[++i];
+            }
+            else if (arg == "--record-fps")
+            {
+                options.recordFps = atof(argv[++i]);
+            }
+            else if (arg == "--stats-file")
+            {
+                options.stats = true;
+                options.statsFile = argv[++i];
+            }
+            else if (arg == "--calibration")
+            {
+                options.calibrationFile = argv[++i];
+            }
+            else if (arg == "--detector-params")
+            {
+                options.detectorParamsFile = argv[++i];
+            }
+            else if (arg == "--detector")
+            {
+                options.detector = argv[++i];
+                if (options.detector != "aruco" && options.detector != "chessboard" && options.detector != "harris")
+                {
+                    LOG_ERROR("Invalid detector: " << options.detector << " (aruco, chessboard or harris)");
+                    return false;
+                }
+            }
+            else if (arg == "--log-level")
+            {
+                // Applied right away so the rest of the parsing already logs at the requested level
+                LogLevel level;
+                if (!parseLogLevel(argv[++i], level))
+                {
+                    LOG_ERROR("Invalid log level: " << argv[i]);
+                    return false;
+                }
+                setLogLevel(level);
+            }
+            else
+            {
+                options.queueCapacity = atoi(argv[++i]);
+                if (options.queueCapacity < 1 || options.queueCapacity > maxQueueCapacity)
+                {
+                    LOG_ERROR("Invalid queue capacity: " << argv[i] << " (1 to " << maxQueueCapacity << ")");
+                    return false;
+                }
+            }
+        }
+        else
+        {
+            positional.push_back(arg);
+        }
+    }
+    return true;
+}
+
 int main(int argc, char *argv[])
 {
-    cout << "Hello, Augmented Reality!\n" << endl;
+    LOG_INFO("Hello, Augmented Reality!\n");
     // Print usage message if no arguments are passed
     if (argc <= 1)
     {
@@ -38,6 +241,16 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    StreamOptions options;
+    vector<string> positional;
+    if (!parseStreamOptions(argc, argv, options, positional))
+    {
+        printUsage();
+        return -1;
+    }
+    string calibrationFileName = positional.empty() ? "" : positional[0];
+    setStageTiming(options.stats);
+
     // Check for command line arguments
     if (argc >= 2)
     {
@@ -49,42 +262,93 @@ int main(int argc, char *argv[])
 
         else if (strcmp(argv[1], "-c") == 0 || strcmp(argv[1], "--chessboard") == 0)
         {
-            if (argv[2] != NULL)
-            {
-                string calibrationFileName = argv[2];
-                return chessboardDetectionAndCalibration(calibrationFileName);
-            }
-            else
+            return chessboardDetectionAndCalibration(calibrationFileName, options);
+        }
+
+        else if (strcmp(argv[1], "-ch") == 0 || strcmp(argv[1], "--charuco") == 0)
+        {
+            return charucoDetectionAndCalibration(calibrationFileName, options);
+        }
+
+        else if (strcmp(argv[1], "-bc") == 0 || strcmp(argv[1], "--bench-chessboard") == 0)
+        {
+            return benchmarkChessboardDetection(positional.empty() ? "../img/CameraCalibration" : positional[0]);
+        }
+
+        else if (strcmp(argv[1], "-bp") == 0 || strcmp(argv[1], "--bench-pose") == 0)
+        {
+            string source = options.source.empty() ? "../img/CameraCalibration" : options.source;
+            return benchmarkPoseEstimation(source, calibrationFileName, options.maxFrames);
+        }
+
+        else if (strcmp(argv[1], "-bo") == 0 || strcmp(argv[1], "--bench-overlay") == 0)
+        {
+            return benchmarkOverlayRenderer(positional.empty() ? 64 : atoi(positional[0].c_str()));
+        }
+
+        else if (strcmp(argv[1], "-br") == 0 || strcmp(argv[1], "--bench-raster") == 0)
+        {
+            return benchmarkRasterizer(calibrationFileName, options.maxFrames > 0 ? options.maxFrames : 100);
+        }
+
+        else if (strcmp(argv[1], "-bh") == 0 || strcmp(argv[1], "--bench-harris") == 0)
+        {
+            return benchmarkHarrisKernel(positional.empty() ? "../img/CameraCalibration" : positional[0]);
+        }
+
+        else if (strcmp(argv[1], "-bcal") == 0 || strcmp(argv[1], "--batch-calibrate") == 0)
+        {
+            CalibrationPattern pattern = PATTERN_CHESSBOARD;
+            if (positional.empty() || (positional.size() > 1 && !parseCalibrationPattern(positional[1], pattern)))
             {
-                return chessboardDetectionAndCalibration("");
+                printUsage();
+                return -1;
             }
+            string outputFile = positional.size() > 2 ? positional[2] : "batch_calibration_results.xml";
+            return batchCalibrate(positional[0], pattern, outputFile, options.workers, defaultMaxCalibrationViews,
+                                  options.detectorParamsFile);
         }
 
-        else if (strcmp(argv[1], "-hc") == 0 || strcmp(argv[1], "--harriscorner") == 0)
+        else if (strcmp(argv[1], "-cc") == 0 || strcmp(argv[1], "--convert-calibration") == 0)
         {
-            if (argv[2] != NULL)
+            if (positional.size() < 2)
             {
-                string calibrationFileName = argv[2];
-                return startVideoStream(calibrationFileName);
+                printUsage();
+                return -1;
             }
-            else
+            return convertCalibrationFile(positional[0], positional[1]);
+        }
+
+        else if (strcmp(argv[1], "-td") == 0 || strcmp(argv[1], "--tune-detector") == 0)
+        {
+            if (positional.empty())
             {
-                return startVideoStream("");
+                printUsage();
+                return -1;
             }
+            string outputFile = positional.size() > 1 ? positional[1] : "detector_params.yml";
+            return tuneDetectorParameters(positional[0], outputFile, options.workers);
+        }
+
+        else if (strcmp(argv[1], "-ms") == 0 || strcmp(argv[1], "--multi-stream") == 0)
+        {
+            return multiStreamDetection(positional, options);
+        }
+
+        else if (strcmp(argv[1], "-md") == 0 || strcmp(argv[1], "--multi-detect") == 0)
+        {
+            return multiDetectorStream(options);
+        }
+
+        else if (strcmp(argv[1], "-hc") == 0 || strcmp(argv[1], "--harriscorner") == 0)
+        {
+            return startVideoStream(calibrationFileName, options);
         }
 
         // Video command is passed
         else if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--video") == 0)
         {
-            if (argc == 3)
-            {
-                string calibrationFileName = argv[2];
-                return videoStreaming(calibrationFileName);
-            }
-            else
-            {
-                return videoStreaming("");
-            }
+            return videoStreaming(calibrationFileName, options);
         }
 
         // Help command is passed
@@ -96,7 +360,7 @@ int main(int argc, char *argv[])
         // Invalid option is passed
         else
         {
-            cout << "Invalid option: " << argv[1] << endl;
+            LOG_ERROR("Invalid option: " << argv[1]);
             printUsage();
             return -1;
         }
@@ -104,7 +368,7 @@ int main(int argc, char *argv[])
     // Invalid number of arguments
     else
     {
-        cout << "Invalid number of arguments" << endl;
+        LOG_ERROR("Invalid number of arguments");
         printUsage();
         return -1;
     }
@@ -0,0 +1,371 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Offline camera calibration from a directory of recorded images, decoded and detected on all cores
+
+#include <chrono>
+#include <iostream>
+#include <opencv2/aruco.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "aruco_tracker.h"
+#include "batch_calibration.h"
+#include "calibration_file.h"
+#include "camera_utils.h"
+#include "charuco_tracker.h"
+#include "chessboard_tracker.h"
+#include "detector_tuning.h"
+#include "frame_source.h"
+#include "logger.h"
+#include "thread_pool.h"
+
+using namespace std;
+using namespace cv;
+
+// Same board and flags as the interactive chessboard calibration (chessboard_utils.cpp)
+static const Size chessboardPattern(9, 6);
+static const float chessboardSquareSize = 25; // in mm
+static const int chessboardCalibrationFlags =
+    CALIB_FIX_ASPECT_RATIO + CALIB_FIX_K3 + CALIB_ZERO_TANGENT_DIST + CALIB_FIX_PRINCIPAL_POINT;
+
+// A view with fewer markers than this constrains the pose too weakly to help the calibration
+static const int minimumArucoMarkers = 4;
+
+/**
+ * @brief Milliseconds elapsed since start
+ */
+static double millisecondsSince(const chrono::steady_clock::time_point &start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+bool parseCalibrationPattern(const string &name, CalibrationPattern &pattern)
+{
+    if (name == "chessboard")
+    {
+        pattern = PATTERN_CHESSBOARD;
+        return true;
+    }
+    if (name == "aruco")
+    {
+        pattern = PATTERN_ARUCO;
+        return true;
+    }
+    if (name == "charuco")
+    {
+        pattern = PATTERN_CHARUCO;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Prints the per-stage timing of a batch calibration
+ */
+void BatchCalibrationTiming::report(size_t images) const
+{
+    double perImage = images > 0 ? 1.0 / images : 0.0;
+    LOG_INFO("Stage timing (" << images << " images, " << threads << " threads):");
+    LOG_INFO("  list:       " << listMs << " ms");
+    LOG_INFO("  decode:     " << decodeMs << " ms total, " << decodeMs * perImage << " ms per image");
+    LOG_INFO("  detect:     " << detectMs << " ms total, " << detectMs * perImage << " ms per image");
+    LOG_INFO("  decode + detect wall: " << detectWallMs << " ms ("
+             << (detectWallMs > 0 ? (decodeMs + detectMs) / detectWallMs : 0.0) << "x parallel speedup)");
+    LOG_INFO("  select:     " << selectMs << " ms");
+    LOG_INFO("  calibrate:  " << calibrateMs << " ms");
+    LOG_INFO("  write:      " << writeMs << " ms");
+}
+
+/**
+ * @brief Outcome of decoding and searching one image, written by exactly one task
+ */
+struct ImageDetection
+{
+    bool found;
+    double decodeMs;
+    double detectMs;
+    CalibrationView view;
+
+    ImageDetection() : found(false), decodeMs(0), detectMs(0)
+    {
+    }
+};
+
+/**
+ * @brief Finds the chessboard corners and their board coordinates
+ */
+static bool detectChessboardView(const Mat &image, CalibrationView &view)
+{
+    Mat gray;
+    cvtColor(image, gray, COLOR_BGR2GRAY);
+    if (!findChessboardCornersMultiScale(gray, chessboardPattern, view.imagePoints))
+    {
+        return false;
+    }
+    for (int i = 0; i < chessboardPattern.height; i++)
+    {
+        for (int j = 0; j < chessboardPattern.width; j++)
+        {
+            view.objectPoints.push_back(Point3f(j * chessboardSquareSize, i * chessboardSquareSize, 0));
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Finds the Aruco markers and matches their corners to board coordinates
+ */
+static bool detectArucoView(const Mat &image, ArucoTracker &tracker, CalibrationView &view)
+{
+    if (tracker.detect(image) < minimumArucoMarkers)
+    {
+        return false;
+    }
+    tracker.board()->matchImagePoints(tracker.corners(), tracker.ids(), view.objectPoints, view.imagePoints);
+    return !view.objectPoints.empty();
+}
+
+/**
+ * @brief Finds the ChArUco corners, however much of the board is visible, and their board coordinates
+ */
+static bool detectCharucoView(const Mat &image, CharucoTracker &tracker, CalibrationView &view)
+{
+    tracker.detect(image);
+    if (!tracker.matchPoints(view.objectPoints, view.imagePoints))
+    {
+        return false;
+    }
+    view.cornerIds = tracker.ids();
+    return true;
+}
+
+int detectCalibrationViews(const string &directory, CalibrationPattern pattern, int threads,
+                           BatchCalibrationResult &result, const aruco::DetectorParameters &detectorParams)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    ImageDirectoryFrameSource listing(directory);
+    const vector<string> &files = listing.files();
+    result.timing.listMs = millisecondsSince(start);
+
+    ThreadPool pool(threads);
+    vector<ImageDetection> detections(files.size());
+
+    // One tracker per worker: detect() reuses its buffers and is not safe to share
+    vector<Ptr<ArucoTracker>> trackers(pool.size());
+    vector<Ptr<CharucoTracker>> charucoTrackers(pool.size());
+    for (int i = 0; i < pool.size(); i++)
+    {
+        if (pattern == PATTERN_ARUCO)
+        {
+            trackers[i] = makePtr<ArucoTracker>();
+            trackers[i]->setDetectorParameters(detectorParams);
+        }
+        else if (pattern == PATTERN_CHARUCO)
+        {
+            charucoTrackers[i] = makePtr<CharucoTracker>();
+        }
+    }
+
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        pool.submit([&, i]() {
+            ImageDetection &detection = detections[i];
+            detection.view.file = files[i];
+
+            chrono::steady_clock::time_point stageStart = chrono::steady_clock::now();
+            Mat image = imread(files[i], IMREAD_COLOR);
+            detection.decodeMs = millisecondsSince(stageStart);
+            if (image.empty())
+            {
+                return;
+            }
+            detection.view.imageSize = image.size();
+
+            stageStart = chrono::steady_clock::now();
+            if (pattern == PATTERN_CHESSBOARD)
+            {
+                detection.found = detectChessboardView(image, detection.view);
+            }
+            else if (pattern == PATTERN_CHARUCO)
+            {
+                detection.found = detectCharucoView(image, *charucoTrackers[pool.currentWorker()], detection.view);
+            }
+            else
+            {
+                detection.found = detectArucoView(image, *trackers[pool.currentWorker()], detection.view);
+            }
+            detection.detectMs = millisecondsSince(stageStart);
+        });
+    }
+    pool.wait();
+    result.timing.detectWallMs = millisecondsSince(start);
+    result.timing.threads = pool.size();
+
+    // Collect in file order so the result does not depend on scheduling
+    result.views.clear();
+    result.skippedFiles.clear();
+    for (size_t i = 0; i < detections.size(); i++)
+    {
+        ImageDetection &detection = detections[i];
+        result.timing.decodeMs += detection.decodeMs;
+        result.timing.detectMs += detection.detectMs;
+        if (detection.found && result.views.empty())
+        {
+            result.imageSize = detection.view.imageSize;
+        }
+        if (!detection.found || detection.view.imageSize != result.imageSize)
+        {
+            result.skippedFiles.push_back(detection.view.file);
+            continue;
+        }
+        result.views.push_back(detection.view);
+    }
+    LOG_INFO("Work-stealing pool: " << pool.size() << " workers, " << pool.steals() << " tasks stolen");
+    return (int)result.views.size();
+}
+
+/**
+ * @brief Writes the results in the chessboard results layout, or the binary format for a .bin file
+ */
+static bool writeBatchCalibration(const string &outputFile, const BatchCalibrationResult &result)
+{
+    if (outputFile.size() > 4 && outputFile.substr(outputFile.size() - 4) == ".bin")
+    {
+        CalibrationData calibration;
+        calibration.cameraMatrix = result.cameraMatrix;
+        calibration.distCoeffs = result.distCoeffs;
+        calibration.imageSize = result.imageSize;
+        calibration.reprojectionError = result.reprojectionError;
+        for (size_t i = 0; i < result.rvecs.size(); i++)
+        {
+            calibration.rvecs.push_back(Vec3f(Vec3d(result.rvecs[i])));
+            calibration.tvecs.push_back(Vec3f(Vec3d(result.tvecs[i])));
+        }
+        return saveCalibrationBinary(outputFile, calibration);
+    }
+
+    FileStorage fs(outputFile, FileStorage::WRITE);
+    if (!fs.isOpened())
+    {
+        return false;
+    }
+    fs << "frame_width" << result.imageSize.width;
+    fs << "frame_height" << result.imageSize.height;
+    fs << "camera_matrix" << result.cameraMatrix;
+    fs << "dist_coeffs" << result.distCoeffs;
+    fs << "reprojection_error" << result.reprojectionError;
+    fs << "rotation_vectors" << result.rvecs;
+    fs << "translation_vectors" << result.tvecs;
+    fs << "image_files" << "[";
+    for (size_t i = 0; i < result.selectedViews.size(); i++)
+    {
+        fs << result.views[result.selectedViews[i]].file;
+    }
+    fs << "]";
+    fs.release();
+    return true;
+}
+
+int batchCalibrate(const string &directory, CalibrationPattern pattern, const string &outputFile, int threads,
+                   int maxViews, const string &detectorParamsFile)
+{
+    aruco::DetectorParameters detectorParams;
+    if (!detectorParamsFile.empty())
+    {
+        if (pattern != PATTERN_ARUCO)
+        {
+            LOG_WARN("--detector-params only applies to the aruco pattern; ignored");
+        }
+        else if (!loadDetectorParameters(detectorParamsFile, detectorParams))
+        {
+            return -1;
+        }
+        else
+        {
+            LOG_INFO("Utilizing detector parameters file: " << detectorParamsFile);
+        }
+    }
+
+    BatchCalibrationResult result;
+    int views = detectCalibrationViews(directory, pattern, threads, result, detectorParams);
+    size_t images = views + result.skippedFiles.size();
+    if (images == 0)
+    {
+        LOG_WARN("No images found in " << directory);
+        return -1;
+    }
+
+    LOG_INFO("Board found in " << views << " of " << images << " images");
+    for (size_t i = 0; i < result.skippedFiles.size(); i++)
+    {
+        LOG_INFO("  skipped " << result.skippedFiles[i]);
+    }
+    if (views < 3)
+    {
+        LOG_WARN("Need at least 3 views to calibrate");
+        return -1;
+    }
+
+    vector<vector<Point3f>> objectPoints;
+    vector<vector<Point2f>> imagePoints;
+    for (size_t i = 0; i < result.views.size(); i++)
+    {
+        objectPoints.push_back(result.views[i].objectPoints);
+        imagePoints.push_back(result.views[i].imagePoints);
+    }
+
+    // Near-duplicate poses only make the solve slower, keep the most diverse ones
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    result.selectedViews = selectDiverseViews(objectPoints, imagePoints, result.imageSize, maxViews);
+    vector<vector<Point3f>> selectedObjectPoints;
+    vector<vector<Point2f>> selectedImagePoints;
+    for (size_t i = 0; i < result.selectedViews.size(); i++)
+    {
+        selectedObjectPoints.push_back(objectPoints[result.selectedViews[i]]);
+        selectedImagePoints.push_back(imagePoints[result.selectedViews[i]]);
+    }
+    result.timing.selectMs = millisecondsSince(start);
+    LOG_INFO("Using " << result.selectedViews.size() << " of " << views << " views");
+
+    start = chrono::steady_clock::now();
+    result.cameraMatrix = Mat::eye(3, 3, CV_64F);
+    result.distCoeffs = Mat::zeros(5, 1, CV_64F);
+    if (pattern == PATTERN_CHARUCO)
+    {
+        vector<vector<int>> selectedCornerIds;
+        for (size_t i = 0; i < result.selectedViews.size(); i++)
+        {
+            selectedCornerIds.push_back(result.views[result.selectedViews[i]].cornerIds);
+        }
+        result.reprojectionError =
+            calibrateCameraCharuco(result.cameraMatrix, result.distCoeffs, result.imageSize, selectedImagePoints,
+                                   selectedCornerIds, CharucoTracker().board(), result.rvecs, result.tvecs);
+        if (result.reprojectionError < 0)
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        int flags = pattern == PATTERN_CHESSBOARD ? chessboardCalibrationFlags : 0;
+        result.reprojectionError = calibrateCamera(selectedObjectPoints, selectedImagePoints, result.imageSize,
+                                                   result.cameraMatrix, result.distCoeffs, result.rvecs, result.tvecs,
+                                                   flags);
+    }
+    result.timing.calibrateMs = millisecondsSince(start);
+
+    start = chrono::steady_clock::now();
+    if (!writeBatchCalibration(outputFile, result))
+    {
+        LOG_ERROR("Could not write " << outputFile);
+        return -1;
+    }
+    result.timing.writeMs = millisecondsSince(start);
+
+    LOG_INFO("\nReprojection Error: " << result.reprojectionError);
+    LOG_INFO("Camera Matrix:\n " << result.cameraMatrix);
+    LOG_INFO("Distortion Coefficients: " << result.distCoeffs.t());
+    LOG_INFO("Results written to " << outputFile << "\n");
+    result.timing.report(images);
+    return 0;
+}
@@ -0,0 +1,362 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Calibration files: one loader for every XML layout the app writes, and a memory-mapped binary format
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "calibration_file.h"
+#include "logger.h"
+
+using namespace std;
+using namespace cv;
+
+static const char calibrationMagic[8] = {'A', 'R', 'C', 'A', 'L', 'I', 'B', '\0'};
+
+/**
+ * @brief Milliseconds elapsed since start
+ */
+static double millisecondsSince(const chrono::steady_clock::time_point &start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+MappedCalibrationFile::MappedCalibrationFile() : data(0), bytes(0)
+{
+}
+
+MappedCalibrationFile::~MappedCalibrationFile()
+{
+    close();
+}
+
+bool MappedCalibrationFile::open(const string &filename)
+{
+    close();
+#ifdef _WIN32
+    ifstream file(filename.c_str(), ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    buffer.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    data = buffer.empty() ? 0 : &buffer[0];
+    bytes = buffer.size();
+#else
+    int descriptor = ::open(filename.c_str(), O_RDONLY);
+    if (descriptor < 0)
+    {
+        return false;
+    }
+    struct stat status;
+    if (fstat(descriptor, &status) == 0 && status.st_size > 0)
+    {
+        void *mapping = mmap(0, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (mapping != MAP_FAILED)
+        {
+            data = (const unsigned char *)mapping;
+            bytes = (size_t)status.st_size;
+        }
+    }
+    ::close(descriptor);
+#endif
+    if (!data)
+    {
+        return false;
+    }
+
+    // Reject anything that is not a complete file of a version we understand
+    bool valid = bytes >= sizeof(CalibrationFileHeader);
+    if (valid)
+    {
+        const CalibrationFileHeader &fileHeader = header();
+        valid = memcmp(fileHeader.magic, calibrationMagic, sizeof(calibrationMagic)) == 0 &&
+                fileHeader.version >= 1 && fileHeader.headerBytes >= sizeof(CalibrationFileHeader) &&
+                fileHeader.headerBytes % sizeof(float) == 0 && fileHeader.headerBytes <= bytes &&
+                fileHeader.distortionCount <= (uint32_t)maxDistortionCoefficients &&
+                (bytes - fileHeader.headerBytes) / (6 * sizeof(float)) >= fileHeader.poseCount;
+    }
+    if (!valid)
+    {
+        close();
+    }
+    return valid;
+}
+
+void MappedCalibrationFile::close()
+{
+#ifndef _WIN32
+    if (data)
+    {
+        munmap((void *)data, bytes);
+    }
+#endif
+    buffer.clear();
+    data = 0;
+    bytes = 0;
+}
+
+const float *MappedCalibrationFile::rotations() const
+{
+    return (const float *)(data + header().headerBytes);
+}
+
+const float *MappedCalibrationFile::translations() const
+{
+    return rotations() + 3 * (size_t)header().poseCount;
+}
+
+bool isBinaryCalibrationFile(const string &filename)
+{
+    char magic[sizeof(calibrationMagic)];
+    ifstream file(filename.c_str(), ios::binary);
+    return file.read(magic, sizeof(magic)) && memcmp(magic, calibrationMagic, sizeof(magic)) == 0;
+}
+
+/**
+ * @brief Fills calibration from a mapped binary file
+ */
+static void readBinaryCalibration(const MappedCalibrationFile &file, CalibrationData &calibration)
+{
+    const CalibrationFileHeader &header = file.header();
+    calibration.cameraMatrix = Mat(3, 3, CV_64F, (void *)header.cameraMatrix).clone();
+    calibration.distCoeffs = Mat((int)header.distortionCount, 1, CV_64F, (void *)header.distortion).clone();
+    calibration.imageSize = Size(header.imageWidth, header.imageHeight);
+    calibration.reprojectionError = header.reprojectionError;
+
+    const Vec3f *rotations = (const Vec3f *)file.rotations();
+    const Vec3f *translations = (const Vec3f *)file.translations();
+    calibration.rvecs.assign(rotations, rotations + header.poseCount);
+    calibration.tvecs.assign(translations, translations + header.poseCount);
+}
+
+/**
+ * @brief Returns the first of the given nodes that exists
+ */
+static FileNode firstNode(const FileStorage &fs, const char *first, const char *second, const char *third = 0)
+{
+    FileNode node = fs[first];
+    if (node.empty())
+    {
+        node = fs[second];
+    }
+    if (node.empty() && third)
+    {
+        node = fs[third];
+    }
+    return node;
+}
+
+/**
+ * @brief Appends the 3-vectors stored in a sequence of matrices
+ */
+static void readVectorSequence(const FileNode &node, vector<Vec3f> &vectors)
+{
+    for (FileNodeIterator it = node.begin(); it != node.end(); ++it)
+    {
+        Mat value;
+        *it >> value;
+        if (value.total() == 3)
+        {
+            Mat asFloat;
+            value.reshape(1, 3).convertTo(asFloat, CV_32F);
+            vectors.push_back(Vec3f(asFloat.at<float>(0), asFloat.at<float>(1), asFloat.at<float>(2)));
+        }
+    }
+}
+
+/**
+ * @brief Reads any of the XML/YAML layouts through FileStorage
+ */
+static bool readXmlCalibration(const string &filename, CalibrationData &calibration)
+{
+    FileStorage fs(filename, FileStorage::READ);
+    if (!fs.isOpened())
+    {
+        return false;
+    }
+
+    Mat cameraMatrix, distCoeffs;
+    firstNode(fs, "camera_matrix", "cameraMatrix") >> cameraMatrix;
+    firstNode(fs, "dist_coeffs", "distCoeffs", "distortion_coefficients") >> distCoeffs;
+    if (cameraMatrix.total() != 9)
+    {
+        return false;
+    }
+    cameraMatrix.reshape(1, 3).convertTo(calibration.cameraMatrix, CV_64F);
+    if (distCoeffs.empty())
+    {
+        calibration.distCoeffs = Mat::zeros(5, 1, CV_64F);
+    }
+    else
+    {
+        distCoeffs.reshape(1, (int)distCoeffs.total()).convertTo(calibration.distCoeffs, CV_64F);
+    }
+
+    int width = 0, height = 0;
+    firstNode(fs, "frame_width", "image_width") >> width;
+    firstNode(fs, "frame_height", "image_height") >> height;
+    calibration.imageSize = Size(width, height);
+    firstNode(fs, "reprojection_error", "avg_reprojection_error") >> calibration.reprojectionError;
+
+    calibration.rvecs.clear();
+    calibration.tvecs.clear();
+    readVectorSequence(fs["rotation_vectors"], calibration.rvecs);
+    readVectorSequence(fs["translation_vectors"], calibration.tvecs);
+
+    // The OpenCV calibration sample stores one row of (rvec, tvec) per view
+    Mat extrinsics;
+    fs["extrinsic_parameters"] >> extrinsics;
+    if (calibration.rvecs.empty() && extrinsics.cols == 6)
+    {
+        Mat asFloat;
+        extrinsics.convertTo(asFloat, CV_32F);
+        for (int i = 0; i < asFloat.rows; i++)
+        {
+            const float *row = asFloat.ptr<float>(i);
+            calibration.rvecs.push_back(Vec3f(row[0], row[1], row[2]));
+            calibration.tvecs.push_back(Vec3f(row[3], row[4], row[5]));
+        }
+    }
+    return true;
+}
+
+bool loadCalibration(const string &filename, CalibrationData &calibration)
+{
+    MappedCalibrationFile binary;
+    if (binary.open(filename))
+    {
+        readBinaryCalibration(binary, calibration);
+        return true;
+    }
+    if (isBinaryCalibrationFile(filename))
+    {
+        LOG_ERROR("Unsupported or truncated binary calibration file: " << filename);
+        return false;
+    }
+    if (!readXmlCalibration(filename, calibration))
+    {
+        LOG_ERROR("No camera calibration found in " << filename);
+        return false;
+    }
+    return true;
+}
+
+bool saveCalibrationBinary(const string &filename, const CalibrationData &calibration)
+{
+    if (calibration.cameraMatrix.total() != 9 || calibration.rvecs.size() != calibration.tvecs.size())
+    {
+        return false;
+    }
+
+    CalibrationFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, calibrationMagic, sizeof(calibrationMagic));
+    header.version = calibrationFileVersion;
+    header.headerBytes = sizeof(CalibrationFileHeader);
+    header.imageWidth = calibration.imageSize.width;
+    header.imageHeight = calibration.imageSize.height;
+    header.poseCount = (uint32_t)calibration.rvecs.size();
+    header.reprojectionError = calibration.reprojectionError;
+
+    Mat cameraMatrix, distCoeffs;
+    calibration.cameraMatrix.reshape(1, 9).convertTo(cameraMatrix, CV_64F);
+    memcpy(header.cameraMatrix, cameraMatrix.ptr<double>(), sizeof(header.cameraMatrix));
+    if (!calibration.distCoeffs.empty())
+    {
+        calibration.distCoeffs.reshape(1, (int)calibration.distCoeffs.total()).convertTo(distCoeffs, CV_64F);
+        header.distortionCount = (uint32_t)min((int)distCoeffs.total(), maxDistortionCoefficients);
+        memcpy(header.distortion, distCoeffs.ptr<double>(), header.distortionCount * sizeof(double));
+    }
+
+    ofstream file(filename.c_str(), ios::binary | ios::trunc);
+    file.write((const char *)&header, sizeof(header));
+    if (header.poseCount > 0)
+    {
+        file.write((const char *)&calibration.rvecs[0], header.poseCount * sizeof(Vec3f));
+        file.write((const char *)&calibration.tvecs[0], header.poseCount * sizeof(Vec3f));
+    }
+    return (bool)file;
+}
+
+bool saveCalibrationXml(const string &filename, const CalibrationData &calibration)
+{
+    FileStorage fs(filename, FileStorage::WRITE);
+    if (!fs.isOpened())
+    {
+        return false;
+    }
+    fs << "frame_width" << calibration.imageSize.width;
+    fs << "frame_height" << calibration.imageSize.height;
+    fs << "camera_matrix" << calibration.cameraMatrix;
+    fs << "dist_coeffs" << calibration.distCoeffs;
+    fs << "reprojection_error" << calibration.reprojectionError;
+    fs << "rotation_vectors" << "[";
+    for (size_t i = 0; i < calibration.rvecs.size(); i++)
+    {
+        fs << Mat(Vec3d(calibration.rvecs[i]));
+    }
+    fs << "]";
+    fs << "translation_vectors" << "[";
+    for (size_t i = 0; i < calibration.tvecs.size(); i++)
+    {
+        fs << Mat(Vec3d(calibration.tvecs[i]));
+    }
+    fs << "]";
+    fs.release();
+    return true;
+}
+
+bool saveCalibration(const string &filename, const CalibrationData &calibration)
+{
+    size_t dot = filename.rfind('.');
+    if (dot != string::npos && filename.substr(dot) == ".bin")
+    {
+        return saveCalibrationBinary(filename, calibration);
+    }
+    return saveCalibrationXml(filename, calibration);
+}
+
+int convertCalibrationFile(const string &inputFile, const string &outputFile)
+{
+    CalibrationData calibration;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (!loadCalibration(inputFile, calibration))
+    {
+        return -1;
+    }
+    double inputMs = millisecondsSince(start);
+
+    if (!saveCalibration(outputFile, calibration))
+    {
+        LOG_ERROR("Could not write " << outputFile);
+        return -1;
+    }
+
+    CalibrationData check;
+    start = chrono::steady_clock::now();
+    if (!loadCalibration(outputFile, check))
+    {
+        return -1;
+    }
+    double outputMs = millisecondsSince(start);
+
+    LOG_INFO("Converted " << inputFile << " -> " << outputFile);
+    LOG_INFO("Image size: " << calibration.imageSize << ", poses: " << calibration.rvecs.size()
+             << ", reprojection error: " << calibration.reprojectionError);
+    LOG_INFO("Camera Matrix:\n " << calibration.cameraMatrix);
+    LOG_INFO("Load time: " << inputMs << " ms (" << inputFile << "), " << outputMs << " ms (" << outputFile << ")");
+    return 0;
+}
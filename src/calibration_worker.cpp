@@ -0,0 +1,164 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Background camera calibration that re-solves as views arrive and publishes results without locking
+
+#include <chrono>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#include "calibration_worker.h"
+#include "logger.h"
+#include "session_store.h"
+
+using namespace std;
+using namespace cv;
+
+CalibrationWorker::CalibrationWorker(int flags, int minViews, int maxViews)
+    : flags(flags), minViews(max(1, minViews)), maxViews(maxViews), viewBytes(0), enabled(false), stopping(false),
+      busy(false)
+{
+}
+
+CalibrationWorker::~CalibrationWorker()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+    trackSessionMemory(-viewBytes);
+}
+
+bool CalibrationWorker::addView(const vector<Point3f> &viewObjectPoints, const vector<Point2f> &viewImagePoints,
+                                const Size &viewImageSize)
+{
+    if (viewObjectPoints.empty() || viewObjectPoints.size() != viewImagePoints.size())
+    {
+        LOG_WARN("Calibration view ignored: " << viewObjectPoints.size() << " board points, " << viewImagePoints.size()
+                 << " image points");
+        return false;
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        if (objectPoints.empty())
+        {
+            imageSize = viewImageSize;
+        }
+        else if (viewImageSize != imageSize)
+        {
+            LOG_WARN("Calibration view ignored: frame size " << viewImageSize << " differs from " << imageSize);
+            return false;
+        }
+        objectPoints.push_back(viewObjectPoints);
+        imagePoints.push_back(viewImagePoints);
+        long long bytes =
+            (long long)(viewObjectPoints.size() * sizeof(Point3f) + viewImagePoints.size() * sizeof(Point2f));
+        viewBytes += bytes;
+        trackSessionMemory(bytes);
+    }
+    wakeUp.notify_one();
+    return true;
+}
+
+void CalibrationWorker::start()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        enabled = true;
+        if (!worker.joinable())
+        {
+            worker = thread(&CalibrationWorker::run, this);
+        }
+    }
+    wakeUp.notify_one();
+}
+
+bool CalibrationWorker::started() const
+{
+    lock_guard<mutex> guard(lock);
+    return enabled;
+}
+
+int CalibrationWorker::views() const
+{
+    lock_guard<mutex> guard(lock);
+    return (int)objectPoints.size();
+}
+
+vector<vector<Point2f>> CalibrationWorker::viewImagePoints() const
+{
+    lock_guard<mutex> guard(lock);
+    return imagePoints;
+}
+
+void CalibrationWorker::run()
+{
+    size_t solvedViews = 0;
+    unique_lock<mutex> guard(lock);
+    while (true)
+    {
+        wakeUp.wait(guard, [&]() {
+            bool newViews = objectPoints.size() >= (size_t)minViews && objectPoints.size() > solvedViews;
+            return stopping || (enabled && newViews);
+        });
+        if (stopping)
+        {
+            return;
+        }
+
+        // Solve on a copy of the most diverse views so new ones can keep arriving while calibrateCamera runs
+        vector<int> selected = selectDiverseViews(objectPoints, imagePoints, imageSize, maxViews);
+        vector<vector<Point3f>> solveObjectPoints;
+        vector<vector<Point2f>> solveImagePoints;
+        for (size_t i = 0; i < selected.size(); i++)
+        {
+            solveObjectPoints.push_back(objectPoints[selected[i]]);
+            solveImagePoints.push_back(imagePoints[selected[i]]);
+        }
+        Size solveImageSize = imageSize;
+        solvedViews = objectPoints.size();
+        guard.unlock();
+
+        busy = true;
+        shared_ptr<const CalibrationSnapshot> previous = latest();
+        shared_ptr<CalibrationSnapshot> next = make_shared<CalibrationSnapshot>();
+        int solveFlags = flags;
+        if (previous)
+        {
+            previous->cameraMatrix.copyTo(next->cameraMatrix);
+            previous->distCoeffs.copyTo(next->distCoeffs);
+            solveFlags |= CALIB_USE_INTRINSIC_GUESS;
+        }
+        else
+        {
+            next->cameraMatrix = Mat::eye(3, 3, CV_64F);
+            next->distCoeffs = Mat::zeros(5, 1, CV_64F);
+        }
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        try
+        {
+            next->reprojectionError = calibrateCamera(solveObjectPoints, solveImagePoints, solveImageSize,
+                                                      next->cameraMatrix, next->distCoeffs, next->rvecs, next->tvecs,
+                                                      solveFlags);
+            next->solveMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            next->imageSize = solveImageSize;
+            next->views = (int)solvedViews;
+            next->usedViews = (int)solveObjectPoints.size();
+            next->version = previous ? previous->version + 1 : 1;
+            atomic_store(&published, shared_ptr<const CalibrationSnapshot>(next));
+        }
+        catch (const Exception &e)
+        {
+            LOG_ERROR("Background calibration failed with " << solvedViews << " views: " << e.what());
+        }
+        busy = false;
+
+        guard.lock();
+    }
+}
@@ -5,7 +5,10 @@
 #include <opencv2/aruco.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "calibration_file.h"
 #include "camera_utils.h"
+#include "charuco_tracker.h"
+#include "logger.h"
 
 using namespace std;
 using namespace cv;
@@ -28,15 +31,15 @@ double calibrateCamera(Mat &cameraMatrix, Mat &distCoeffs, Size &imageSize, vect
                        vector<vector<Point2f>> corner_list, vector<Mat> &rvecs, vector<Mat> &tvecs,
                        vector<int> &markerIds, vector<int> &markerCounterPerFrame, Ptr<aruco::Board> &board)
 {
-    cout << "Parameters passed to camera calibration function: " << endl;
-    cout << "Camera Matrix:\n " << cameraMatrix << endl;
-    cout << "Distortion Coefficients: " << distCoeffs << endl;
-    cout << "Image Size: " << imageSize << endl;
-    cout << "Point List Size: " << point_list.size() << endl;
-    cout << "Corner List Size: " << corner_list.size() << endl;
-    cout << "Marker Ids Size: " << markerIds.size() << endl;
-    cout << "Marker Counter Per Frame Size: " << markerCounterPerFrame.size() << endl;
-    cout << "Board: " << board << endl;
+    LOG_INFO("Parameters passed to camera calibration function: ");
+    LOG_INFO("Camera Matrix:\n " << cameraMatrix);
+    LOG_INFO("Distortion Coefficients: " << distCoeffs);
+    LOG_INFO("Image Size: " << imageSize);
+    LOG_INFO("Point List Size: " << point_list.size());
+    LOG_INFO("Corner List Size: " << corner_list.size());
+    LOG_INFO("Marker Ids Size: " << markerIds.size());
+    LOG_INFO("Marker Counter Per Frame Size: " << markerCounterPerFrame.size());
+    LOG_INFO("Board: " << board);
 
     // vector<Mat> rvecs, tvecs;
     vector<float> reprojectionErrors;
@@ -45,16 +48,16 @@ double calibrateCamera(Mat &cameraMatrix, Mat &distCoeffs, Size &imageSize, vect
                                              cameraMatrix, distCoeffs, rvecs, tvecs);
 
     // Results from the calibration
-    cout << "\nResults from the calibration: \n";
-    cout << "Reprojection Error: " << rms << endl;
-    cout << "Camera Matrix:\n " << cameraMatrix << endl;
-    cout << "Distortion Coefficients: " << distCoeffs << endl;
-    cout << "Focal Length 'fx': " << cameraMatrix.at<double>(0, 0) << endl;
-    cout << "Focal Length 'fy': " << cameraMatrix.at<double>(1, 1) << endl;
-    cout << "Principal Point 'u0': " << cameraMatrix.at<double>(0, 2) << endl;
-    cout << "Principal Point 'v0': " << cameraMatrix.at<double>(1, 2) << endl;
-    cout << "Rvecs: " << rvecs.size() << endl;
-    cout << "Tvecs: " << tvecs.size() << endl;
+    LOG_INFO("\nResults from the calibration: ");
+    LOG_INFO("Reprojection Error: " << rms);
+    LOG_INFO("Camera Matrix:\n " << cameraMatrix);
+    LOG_INFO("Distortion Coefficients: " << distCoeffs);
+    LOG_INFO("Focal Length 'fx': " << cameraMatrix.at<double>(0, 0));
+    LOG_INFO("Focal Length 'fy': " << cameraMatrix.at<double>(1, 1));
+    LOG_INFO("Principal Point 'u0': " << cameraMatrix.at<double>(0, 2));
+    LOG_INFO("Principal Point 'v0': " << cameraMatrix.at<double>(1, 2));
+    LOG_INFO("Rvecs: " << rvecs.size());
+    LOG_INFO("Tvecs: " << tvecs.size());
 
     FileStorage fs("calibration_results.xml", FileStorage::WRITE);
     fs << "cameraMatrix" << cameraMatrix << "distCoeffs" << distCoeffs;
@@ -78,12 +81,12 @@ double calibrateCamera(Mat &cameraMatrix, Mat &distCoeffs, Size &imageSize, vect
 double calibrateCamera(Mat &cameraMatrix, Mat &distCoeffs, Size &imageSize, vector<vector<Vec3f>> point_list,
                        vector<vector<Point2f>> corner_list, vector<Mat> &rvecs, vector<Mat> &tvecs)
 {
-    cout << "Parameters passed to camera calibration function: " << endl;
-    cout << "Camera Matrix:\n " << cameraMatrix << endl;
-    cout << "Distortion Coefficients: " << distCoeffs << endl;
-    cout << "Image Size: " << imageSize << endl;
-    cout << "Point List Size: " << point_list.size() << endl;
-    cout << "Corner List Size: " << corner_list.size() << endl;
+    LOG_INFO("Parameters passed to camera calibration function: ");
+    LOG_INFO("Camera Matrix:\n " << cameraMatrix);
+    LOG_INFO("Distortion Coefficients: " << distCoeffs);
+    LOG_INFO("Image Size: " << imageSize);
+    LOG_INFO("Point List Size: " << point_list.size());
+    LOG_INFO("Corner List Size: " << corner_list.size());
 
     // vector<Mat> rvecs, tvecs;
     vector<float> reprojectionErrors;
@@ -92,16 +95,16 @@ double calibrateCamera(Mat &cameraMatrix, Mat &distCoeffs, Size &imageSize, vect
                                  CALIB_FIX_ASPECT_RATIO); // re-project error
 
     // Results from the calibration
-    cout << "\nResults from the calibration: \n";
-    cout << "Reprojection Error: " << rms << endl;
-    cout << "Camera Matrix:\n " << cameraMatrix << endl;
-    cout << "Distortion Coefficients: " << distCoeffs << endl;
-    cout << "Focal Length 'fx': " << cameraMatrix.at<double>(0, 0) << endl;
-    cout << "Focal Length 'fy': " << cameraMatrix.at<double>(1, 1) << endl;
-    cout << "Principal Point 'u0': " << cameraMatrix.at<double>(0, 2) << endl;
-    cout << "Principal Point 'v0': " << cameraMatrix.at<double>(1, 2) << endl;
-    cout << "Rvecs: " << rvecs.size() << endl;
-    cout << "Tvecs: " << tvecs.size() << endl;
+    LOG_INFO("\nResults from the calibration: ");
+    LOG_INFO("Reprojection Error: " << rms);
+    LOG_INFO("Camera Matrix:\n " << cameraMatrix);
+    LOG_INFO("Distortion Coefficients: " << distCoeffs);
+    LOG_INFO("Focal Length 'fx': " << cameraMatrix.at<double>(0, 0));
+    LOG_INFO("Focal Length 'fy': " << cameraMatrix.at<double>(1, 1));
+    LOG_INFO("Principal Point 'u0': " << cameraMatrix.at<double>(0, 2));
+    LOG_INFO("Principal Point 'v0': " << cameraMatrix.at<double>(1, 2));
+    LOG_INFO("Rvecs: " << rvecs.size());
+    LOG_INFO("Tvecs: " << tvecs.size());
 
     FileStorage fs("calibration_results.xml", FileStorage::WRITE);
     fs << "cameraMatrix" << cameraMatrix << "distCoeffs" << distCoeffs;
@@ -111,7 +114,61 @@ double calibrateCamera(Mat &cameraMatrix, Mat &distCoeffs, Size &imageSize, vect
 }
 
 /**
- * @brief Function to read the camera parameters from a file
+ * @brief Function to calibrate the camera using a ChArUco board. Each view contributes only the chessboard corners
+ * it actually saw, so partial views of the board are fine; views with fewer than minimumCharucoCorners corners are
+ * skipped.
+ *
+ * @param cameraMatrix initial guess with CALIB_USE_INTRINSIC_GUESS, the result otherwise
+ * @param distCoeffs distortion coefficients
+ * @param imageSize size of the calibration images
+ * @param charucoCorners interpolated chessboard corners, one vector per view
+ * @param charucoIds ids of those corners
+ * @param board the ChArUco board the corners belong to
+ * @param rvecs rotation vectors of the used views
+ * @param tvecs translation vectors of the used views
+ * @param flags calibrateCamera flags
+ * @return RMS reprojection error, or -1 if fewer than 3 views were usable
+ */
+double calibrateCameraCharuco(Mat &cameraMatrix, Mat &distCoeffs, const Size &imageSize,
+                              const vector<vector<Point2f>> &charucoCorners, const vector<vector<int>> &charucoIds,
+                              const Ptr<aruco::CharucoBoard> &board, vector<Mat> &rvecs, vector<Mat> &tvecs,
+                              int flags)
+{
+    vector<vector<Point3f>> objectPoints;
+    vector<vector<Point2f>> imagePoints;
+    for (size_t i = 0; i < charucoCorners.size() && i < charucoIds.size(); i++)
+    {
+        if ((int)charucoIds[i].size() < minimumCharucoCorners)
+        {
+            continue;
+        }
+        vector<Point3f> viewObjectPoints;
+        vector<Point2f> viewImagePoints;
+        board->matchImagePoints(charucoCorners[i], charucoIds[i], viewObjectPoints, viewImagePoints);
+        if ((int)viewObjectPoints.size() >= minimumCharucoCorners)
+        {
+            objectPoints.push_back(viewObjectPoints);
+            imagePoints.push_back(viewImagePoints);
+        }
+    }
+    LOG_INFO("ChArUco calibration: " << objectPoints.size() << " of " << charucoCorners.size() << " views usable");
+    if (objectPoints.size() < 3)
+    {
+        LOG_WARN("Need at least 3 ChArUco views with " << minimumCharucoCorners << " or more corners");
+        return -1;
+    }
+
+    double rms = calibrateCamera(objectPoints, imagePoints, imageSize, cameraMatrix, distCoeffs, rvecs, tvecs, flags);
+
+    LOG_INFO("\nResults from the calibration: ");
+    LOG_INFO("Reprojection Error: " << rms);
+    LOG_INFO("Camera Matrix:\n " << cameraMatrix);
+    LOG_INFO("Distortion Coefficients: " << distCoeffs);
+    return rms;
+}
+
+/**
+ * @brief Function to read the camera parameters from a file (any XML layout or the binary format)
  *
  * @param cameraMatrix
  * @param distCoeffs
@@ -119,12 +176,14 @@ double calibrateCamera(Mat &cameraMatrix, Mat &distCoeffs, Size &imageSize, vect
  */
 void readCameraParameters(Mat &cameraMatrix, Mat &distCoeffs, string filename = "calibration_results.xml")
 {
-    cout << "Reading camera parameters from file: " << filename << endl;
-    FileStorage fs(filename, FileStorage::READ);
-    fs["cameraMatrix"] >> cameraMatrix;
-    fs["distCoeffs"] >> distCoeffs;
-    fs.release();
-    cout << "Camera Matrix:\n " << cameraMatrix << endl;
-    cout << "Distortion Coefficients: " << distCoeffs << endl;
-    cout << "Reading complete!\n" << endl;
+    LOG_INFO("Reading camera parameters from file: " << filename);
+    CalibrationData calibration;
+    if (loadCalibration(filename, calibration))
+    {
+        cameraMatrix = calibration.cameraMatrix;
+        distCoeffs = calibration.distCoeffs;
+    }
+    LOG_INFO("Camera Matrix:\n " << cameraMatrix);
+    LOG_INFO("Distortion Coefficients: " << distCoeffs);
+    LOG_INFO("Reading complete!\n");
 }
@@ -0,0 +1,56 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Persistent ChArUco board tracker: markers plus interpolated chessboard corners from partial views
+
+#include "charuco_tracker.h"
+
+using namespace std;
+using namespace cv;
+
+CharucoTracker::CharucoTracker(aruco::PredefinedDictionaryType dictionaryId, Size squares, float squareLength,
+                               float markerLength, const aruco::DetectorParameters &detectorParams)
+    : dict(aruco::getPredefinedDictionary(dictionaryId)),
+      charucoBoard(makePtr<aruco::CharucoBoard>(squares, squareLength, markerLength, dict)),
+      detector(*charucoBoard, aruco::CharucoParameters(), detectorParams)
+{
+    int maxMarkers = (int)charucoBoard->getIds().size();
+    charucoCorners.reserve(maxCorners());
+    charucoIds.reserve(maxCorners());
+    detectedMarkerCorners.reserve(maxMarkers);
+    detectedMarkerIds.reserve(maxMarkers);
+}
+
+int CharucoTracker::detect(const Mat &image)
+{
+    charucoCorners.clear();
+    charucoIds.clear();
+    detectedMarkerCorners.clear();
+    detectedMarkerIds.clear();
+    detector.detectBoard(image, charucoCorners, charucoIds, detectedMarkerCorners, detectedMarkerIds);
+    return (int)charucoIds.size();
+}
+
+void CharucoTracker::draw(Mat &image) const
+{
+    if (!detectedMarkerIds.empty())
+    {
+        aruco::drawDetectedMarkers(image, detectedMarkerCorners, detectedMarkerIds);
+    }
+    if (!charucoIds.empty())
+    {
+        aruco::drawDetectedCornersCharuco(image, charucoCorners, charucoIds, Scalar(255, 0, 0));
+    }
+}
+
+bool CharucoTracker::matchPoints(vector<Point3f> &objectPoints, vector<Point2f> &imagePoints) const
+{
+    objectPoints.clear();
+    imagePoints.clear();
+    if ((int)charucoIds.size() < minimumCharucoCorners)
+    {
+        return false;
+    }
+    // With ChArUco corner ids, matchImagePoints returns chessboard corners rather than marker corners
+    charucoBoard->matchImagePoints(charucoCorners, charucoIds, objectPoints, imagePoints);
+    return (int)objectPoints.size() >= minimumCharucoCorners;
+}
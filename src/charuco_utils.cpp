@@ -0,0 +1,214 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: ChArUco board detection and calibration stream (img/opencv_charuco_board.png)
+
+#include <opencv2/aruco.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "calibration_file.h"
+#include "calibration_worker.h"
+#include "charuco_tracker.h"
+#include "charuco_utils.h"
+#include "frame_writer.h"
+#include "logger.h"
+#include "pose_estimator.h"
+#include "session_store.h"
+#include "stage_timer.h"
+
+using namespace std;
+using namespace cv;
+
+// Where the interactive ChArUco calibration is written
+static const char *charucoResultsFile = "charuco_calibration_results.xml";
+
+/**
+ * @brief Saves a calibration published by the background worker
+ */
+static void saveCharucoCalibration(const CalibrationSnapshot &snapshot)
+{
+    CalibrationData calibration;
+    calibration.cameraMatrix = snapshot.cameraMatrix;
+    calibration.distCoeffs = snapshot.distCoeffs;
+    calibration.imageSize = snapshot.imageSize;
+    calibration.reprojectionError = snapshot.reprojectionError;
+    for (size_t i = 0; i < snapshot.rvecs.size(); i++)
+    {
+        calibration.rvecs.push_back(Vec3f(Vec3d(snapshot.rvecs[i])));
+        calibration.tvecs.push_back(Vec3f(Vec3d(snapshot.tvecs[i])));
+    }
+    if (!saveCalibration(charucoResultsFile, calibration))
+    {
+        LOG_ERROR("Could not write " << charucoResultsFile);
+    }
+}
+
+int charucoDetectionAndCalibration(string calibrationFile, const StreamOptions &options)
+{
+    Ptr<FrameSource> source = openFrameSource(options.source);
+    if (!source->isOpened())
+    {
+        LOG_ERROR("Error opening video stream: " << source->describe());
+        return -1;
+    }
+
+    Mat cameraMatrix, distCoeffs;
+    if (calibrationFile != "")
+    {
+        CalibrationData calibration;
+        if (!loadCalibration(calibrationFile, calibration))
+        {
+            return -1;
+        }
+        cameraMatrix = calibration.cameraMatrix;
+        distCoeffs = calibration.distCoeffs;
+        LOG_INFO("Utilizing calibration file: " << calibrationFile);
+    }
+
+    LOG_INFO("\nWelcome to the Augmented Reality Application\n");
+    LOG_INFO("Press 'q' to quit the program");
+    LOG_INFO("Press 's' to save a calibration view (part of the board is enough)");
+    LOG_INFO("Press 'c' to calibrate the camera");
+    LOG_INFO("\n");
+
+    if (!options.headless)
+    {
+        namedWindow("ChArUco Detection", WINDOW_AUTOSIZE);
+    }
+
+    CharucoTracker tracker;
+    // Partial views carry fewer points each, but every one of them is exactly identified
+    CalibrationWorker calibration(0, 4);
+    int appliedCalibration = 0;
+    PoseEstimator boardPose;
+    PoseHistory poses(options.poseHistory > 0 ? options.poseHistory : defaultPoseHistoryCapacity);
+    if (!options.poseLog.empty() && !poses.streamTo(options.poseLog))
+    {
+        return -1;
+    }
+    FrameWriter writer;
+    configureFrameWriter(writer, options);
+    LOG_INFO("Reading frames from " << source->describe() << ", board has " << tracker.maxCorners() << " corners");
+
+    Mat frame, display;
+    vector<Point3f> objectPoints;
+    vector<Point2f> imagePoints;
+    long long frameNumber = 0;
+    int savedViews = 0;
+    FrameRateCounter frameRate;
+    while (!frameLimitReached(frameRate, options))
+    {
+        ScopedStageTimer frameTimer(STAGE_FRAME);
+        ScopedStageTimer captureTimer(STAGE_CAPTURE);
+        if (!source->read(frame))
+        {
+            if (source->isLive())
+            {
+                LOG_ERROR("Error: Could not capture frame");
+            }
+            break;
+        }
+        captureTimer.stop();
+        frame.copyTo(display);
+
+        ScopedStageTimer detectTimer(STAGE_DETECT);
+        int corners = tracker.detect(frame);
+        bool matched = tracker.matchPoints(objectPoints, imagePoints);
+        detectTimer.stop();
+
+        ScopedStageTimer drawTimer(STAGE_DRAW);
+        tracker.draw(display);
+        putText(display, "Corners: " + to_string(corners) + " of " + to_string(tracker.maxCorners()), Point(10, 30),
+                FONT_HERSHEY_SIMPLEX, .75, Scalar(0, 0, 255), 2);
+        drawTimer.stop();
+
+        // Pick up a finished background solve without waiting for one
+        shared_ptr<const CalibrationSnapshot> snapshot = calibration.latest();
+        if (snapshot && snapshot->version != appliedCalibration)
+        {
+            cameraMatrix = snapshot->cameraMatrix.clone();
+            distCoeffs = snapshot->distCoeffs.clone();
+            appliedCalibration = snapshot->version;
+            boardPose.reset();
+            LOG_INFO("\nCalibration " << snapshot->version << " (" << snapshot->usedViews << " of " << snapshot->views
+                     << " views, " << snapshot->solveMs << " ms in the background)");
+            LOG_INFO("Reprojection Error: " << snapshot->reprojectionError);
+            LOG_INFO("Camera Matrix:\n " << cameraMatrix);
+            LOG_INFO("Distortion Coefficients: " << distCoeffs.t());
+            saveCharucoCalibration(*snapshot);
+        }
+        if (calibration.solving())
+        {
+            putText(display, "Calibrating with " + to_string(calibration.views()) + " views...", Point(10, 60),
+                    FONT_HERSHEY_SIMPLEX, .75, Scalar(0, 0, 255), 2);
+        }
+
+        if (matched && !cameraMatrix.empty())
+        {
+            Mat rvec, tvec;
+            ScopedStageTimer poseTimer(STAGE_POSE);
+            bool found = boardPose.estimate(objectPoints, imagePoints, cameraMatrix, distCoeffs, rvec, tvec);
+            poseTimer.stop();
+            if (found)
+            {
+                poses.push(frameNumber, rvec, tvec);
+                ScopedStageTimer axesTimer(STAGE_DRAW);
+                drawFrameAxes(display, cameraMatrix, distCoeffs, rvec, tvec, 60, 3);
+            }
+        }
+        else
+        {
+            boardPose.reset();
+        }
+        frameNumber++;
+
+        ScopedStageTimer writeTimer(STAGE_WRITE);
+        writer.record(display);
+        writeTimer.stop();
+
+        frameRate.tick();
+        ScopedStageTimer displayTimer(STAGE_DISPLAY);
+        char key = presentFrame("ChArUco Detection", display, options);
+        displayTimer.stop();
+        if (key == 'q' || key == 'Q' || key == 27)
+        {
+            LOG_INFO("User terminated program");
+            break;
+        }
+        if (key == 's' || key == 'S')
+        {
+            if (!matched)
+            {
+                LOG_INFO("Need at least " << minimumCharucoCorners << " board corners to save a view");
+            }
+            else if (calibration.addView(objectPoints, imagePoints, frame.size()))
+            {
+                string filename = writer.saveImage(
+                    "../img/CameraCalibration/" + to_string(++savedViews) + "_charuco_image.jpg", frame);
+                LOG_INFO("Saved view with " << objectPoints.size() << " corners ("
+                         << calibration.views() << " views)" << (filename.empty() ? "" : ", image " + filename));
+            }
+        }
+        if (key == 'c' || key == 'C')
+        {
+            if (calibration.views() >= 4)
+            {
+                // Solves on the worker thread; every later 's' re-solves from the current intrinsics
+                LOG_INFO("Calibrating camera in the background...");
+                calibration.start();
+            }
+            else
+            {
+                LOG_INFO("Need at least 4 calibration views");
+            }
+        }
+    }
+
+    frameRate.report("ChArUco detection");
+    boardPose.stats().report();
+    poses.report();
+    reportSessionMemory();
+    writer.flush();
+    writer.stats().report();
+    finishStageTimes("ChArUco detection", options.statsFile);
+    return 0;
+}
@@ -0,0 +1,264 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Frame-to-frame chessboard corner tracking with pyramidal Lucas-Kanade optical flow
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#include "chessboard_tracker.h"
+#include "frame_context.h"
+#include "logger.h"
+#include "stage_timer.h"
+
+using namespace std;
+using namespace cv;
+
+// Optical flow settings: 21x21 window over a 3-level pyramid covers fast hand-held motion at 720p/1080p
+static const Size flowWindow(21, 21);
+static const int flowPyramidLevels = 3;
+
+// Same refinement as the full detection path so solvePnP sees the same corner quality either way
+static const Size subPixWindow(11, 11);
+
+// Longest side of the image findChessboardCorners is run on in the coarse-to-fine path
+static const int coarseSearchMaxSide = 960;
+
+static const int chessboardSearchFlags = CALIB_CB_ADAPTIVE_THRESH + CALIB_CB_NORMALIZE_IMAGE + CALIB_CB_FAST_CHECK;
+
+int chessboardPyramidLevels(const Size &imageSize)
+{
+    int longestSide = max(imageSize.width, imageSize.height);
+    int levels = 0;
+    while ((longestSide >> levels) > coarseSearchMaxSide)
+    {
+        levels++;
+    }
+    return levels;
+}
+
+bool findChessboardCornersSingleScale(const Mat &gray, Size patternSize, vector<Point2f> &corners)
+{
+    ScopedStageTimer detectTimer(STAGE_DETECT);
+    bool found = findChessboardCorners(gray, patternSize, corners, chessboardSearchFlags);
+    detectTimer.stop();
+    if (found)
+    {
+        ScopedStageTimer subPixTimer(STAGE_SUBPIX);
+        cornerSubPix(gray, corners, subPixWindow, Size(-1, -1),
+                     TermCriteria(TermCriteria::EPS + TermCriteria::COUNT, 30, 0.1));
+    }
+    return found;
+}
+
+/**
+ * @brief Searches coarse (gray downsampled levels times) and refines the hits on gray; falls back to gray
+ */
+static bool findChessboardCornersOnLevel(const Mat &gray, const Mat &coarse, int levels, Size patternSize,
+                                         vector<Point2f> &corners)
+{
+    ScopedStageTimer detectTimer(STAGE_DETECT);
+    bool found = findChessboardCorners(coarse, patternSize, corners, chessboardSearchFlags);
+    detectTimer.stop();
+    if (!found)
+    {
+        return findChessboardCornersSingleScale(gray, patternSize, corners);
+    }
+
+    // pyrDown maps pixel centres x -> x / 2, so scaling back is a plain multiply
+    float scale = (float)(1 << levels);
+    for (size_t i = 0; i < corners.size(); i++)
+    {
+        corners[i] *= scale;
+    }
+
+    // The upscaled corners can be off by about one coarse pixel, so widen the search window with the scale.
+    // cornerSubPix's winSize is already a half-window: never go below the single-scale path's 11.
+    int halfWindow = max(subPixWindow.width, 3 * (1 << levels));
+    ScopedStageTimer subPixTimer(STAGE_SUBPIX);
+    cornerSubPix(gray, corners, Size(halfWindow, halfWindow), Size(-1, -1),
+                 TermCriteria(TermCriteria::EPS + TermCriteria::COUNT, 30, 0.1));
+    return true;
+}
+
+bool findChessboardCornersMultiScale(const Mat &gray, Size patternSize, vector<Point2f> &corners, int levels)
+{
+    if (levels < 0)
+    {
+        levels = chessboardPyramidLevels(gray.size());
+    }
+    if (levels == 0)
+    {
+        return findChessboardCornersSingleScale(gray, patternSize, corners);
+    }
+
+    ScopedStageTimer pyramidTimer(STAGE_DETECT);
+    Mat coarse = gray;
+    for (int i = 0; i < levels; i++)
+    {
+        Mat next;
+        pyrDown(coarse, next);
+        coarse = next;
+    }
+    pyramidTimer.stop();
+    return findChessboardCornersOnLevel(gray, coarse, levels, patternSize, corners);
+}
+
+bool findChessboardCornersMultiScale(FrameContext &context, Size patternSize, vector<Point2f> &corners, int levels)
+{
+    const Mat &gray = context.gray();
+    if (levels < 0)
+    {
+        levels = chessboardPyramidLevels(gray.size());
+    }
+    levels = min(levels, FrameContext::maxPyramidLevels - 1);
+    if (levels == 0)
+    {
+        return findChessboardCornersSingleScale(gray, patternSize, corners);
+    }
+    return findChessboardCornersOnLevel(gray, context.pyramidLevel(levels), levels, patternSize, corners);
+}
+
+/**
+ * @brief Prints how often the tracker tracked vs. detected and what each cost
+ */
+void ChessboardTrackingStats::report() const
+{
+    LOG_INFO("Chessboard tracking: " << trackedFrames << " tracked frames, " << detectedFrames << " full detections, "
+             << trackingFailures << " tracking failures");
+    LOG_INFO("Mean cost: tracking " << (trackedFrames > 0 ? trackMs / trackedFrames : 0.0) << " ms, detection "
+             << (detectedFrames > 0 ? detectMs / detectedFrames : 0.0) << " ms");
+}
+
+ChessboardTracker::ChessboardTracker(Size patternSize, int redetectInterval, double maxHomographyError)
+    : patternSize(patternSize), redetectInterval(redetectInterval), maxHomographyError(maxHomographyError),
+      hasPrevious(false), wasTracked(false), framesSinceDetection(0)
+{
+    for (int i = 0; i < patternSize.height; i++)
+    {
+        for (int j = 0; j < patternSize.width; j++)
+        {
+            gridPoints.push_back(Point2f((float)j, (float)i));
+        }
+    }
+}
+
+void ChessboardTracker::reset()
+{
+    hasPrevious = false;
+    wasTracked = false;
+    framesSinceDetection = 0;
+}
+
+bool ChessboardTracker::detect(const Mat &gray, FrameContext *context, vector<Point2f> &corners)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    bool found = context ? findChessboardCornersMultiScale(*context, patternSize, corners)
+                         : findChessboardCornersMultiScale(gray, patternSize, corners);
+    trackingStats.detectMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    trackingStats.detectedFrames++;
+    return found;
+}
+
+double ChessboardTracker::homographyResidual(const vector<Point2f> &corners)
+{
+    Mat homography = findHomography(gridPoints, corners, 0);
+    if (homography.empty())
+    {
+        return HUGE_VAL;
+    }
+    perspectiveTransform(gridPoints, projectedGrid, homography);
+    double sumSquared = 0;
+    for (size_t i = 0; i < corners.size(); i++)
+    {
+        Point2f diff = corners[i] - projectedGrid[i];
+        sumSquared += diff.dot(diff);
+    }
+    return sqrt(sumSquared / corners.size());
+}
+
+bool ChessboardTracker::track(const Mat &gray, vector<Point2f> &corners)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    ScopedStageTimer trackTimer(STAGE_TRACK);
+    calcOpticalFlowPyrLK(previousPyramid, currentPyramid, previousCorners, corners, status, errors, flowWindow,
+                         flowPyramidLevels);
+    trackTimer.stop();
+
+    bool ok = corners.size() == gridPoints.size();
+    for (size_t i = 0; ok && i < status.size(); i++)
+    {
+        ok = status[i] != 0;
+    }
+    if (ok)
+    {
+        ScopedStageTimer subPixTimer(STAGE_SUBPIX);
+        cornerSubPix(gray, corners, subPixWindow, Size(-1, -1),
+                     TermCriteria(TermCriteria::EPS + TermCriteria::COUNT, 30, 0.1));
+        subPixTimer.stop();
+        ok = homographyResidual(corners) <= maxHomographyError;
+    }
+
+    trackingStats.trackMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    if (ok)
+    {
+        trackingStats.trackedFrames++;
+    }
+    else
+    {
+        trackingStats.trackingFailures++;
+    }
+    return ok;
+}
+
+bool ChessboardTracker::process(const Mat &gray, vector<Point2f> &corners)
+{
+    return processFrame(gray, 0, corners);
+}
+
+bool ChessboardTracker::process(FrameContext &context, vector<Point2f> &corners)
+{
+    return processFrame(context.gray(), &context, corners);
+}
+
+bool ChessboardTracker::processFrame(const Mat &gray, FrameContext *context, vector<Point2f> &corners)
+{
+    bool trackingEnabled = redetectInterval > 0;
+    if (trackingEnabled)
+    {
+        ScopedStageTimer pyramidTimer(STAGE_TRACK);
+        buildOpticalFlowPyramid(gray, currentPyramid, flowWindow, flowPyramidLevels);
+    }
+
+    wasTracked = false;
+    bool found = false;
+    if (trackingEnabled && hasPrevious && framesSinceDetection < redetectInterval)
+    {
+        found = track(gray, corners);
+        wasTracked = found;
+    }
+    if (!found)
+    {
+        found = detect(gray, context, corners);
+        framesSinceDetection = 0;
+    }
+    else
+    {
+        framesSinceDetection++;
+    }
+
+    if (!found)
+    {
+        corners.clear();
+    }
+
+    hasPrevious = found && trackingEnabled;
+    if (hasPrevious)
+    {
+        previousCorners = corners;
+        swap(previousPyramid, currentPyramid);
+    }
+    return found;
+}
@@ -6,66 +6,113 @@
 #include <opencv2/aruco.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "calibration_file.h"
+#include "calibration_worker.h"
+#include "chessboard_tracker.h"
 #include "chessboard_utils.h"
+#include "frame_source.h"
+#include "frame_writer.h"
+#include "logger.h"
+#include "obj_model.h"
+#include "overlay_renderer.h"
+#include "pose_estimator.h"
+#include "session_store.h"
+#include "software_rasterizer.h"
+#include "stage_timer.h"
+#include "undistortion.h"
 
 using namespace std;
 using namespace cv;
 
-Mat chessFrame, chessFrameCopy, camMatrix, dCoeffs;
-Size chessboardSize(10 - 1, 7 - 1);
-vector<vector<Point2f>> allImagePoints;
-vector<vector<Point3f>> allObjectPoints;
-vector<Point3f> objectPoints;
-vector<Point2f> imagePoints;
-vector<Mat> allCalibrationFrames;
-vector<Mat> rotationsVectors, translationsVectors;
-int chessBoard[2] = {9, 6};
-int squareSize = 25; // in mm
-int numImages = 0;
-bool cameraIsCalibrated = false;
+// 9x6 inner corners of 25 mm squares, the board every chessboard mode calibrates against
+static const Size chessboardSize(10 - 1, 7 - 1);
+static const int chessBoard[2] = {9, 6};
+static const int squareSize = 25; // in mm
+static const int chessboardCalibrationFlags =
+    CALIB_FIX_ASPECT_RATIO + CALIB_FIX_K3 + CALIB_ZERO_TANGENT_DIST + CALIB_FIX_PRINCIPAL_POINT;
+
+/**
+ * @brief Everything one -c stream owns: the current frame, the calibration and its saved views, the tracker, the
+ * overlay and the writer. chessboardDetectionAndCalibration builds one per call, so no state outlives the stream or
+ * is shared with another one.
+ */
+class ChessboardVideoSession
+{
+  public:
+    ChessboardVideoSession();
+
+    int run(FrameSource &source, const string &calibrationFile, const StreamOptions &options);
+
+  private:
+    bool loadCalibrationFile(string filename);
+    void saveChessBoardImageParameters(const Mat &frame, const UndistortMaps *undistortedWith);
+    void applyChessBoardCalibration(const CalibrationSnapshot &calibration);
+    void detectChessBoard();
+
+    Mat chessFrame, chessFrameCopy, camMatrix, dCoeffs;
+    vector<Point3f> objectPoints;
+    vector<Point2f> imagePoints;
+    int numImages;
+    bool cameraIsCalibrated;
+    ChessboardTracker chessboardTracker;
+    // Seeds each frame's pose with the previous one while the board stays in view
+    PoseEstimator chessboardPose;
+    OverlayRenderer chessboardOverlay;
+    int hourglassMesh;
+    // Optional OBJ model (--model) drawn in place of the hourglass
+    ObjModel chessboardModel;
+    SoftwareRasterizer chessboardRasterizer;
+    RasterShading chessboardShading;
+    // Bounded history of live board poses, optionally streamed to disk (--pose-history, --pose-log)
+    PoseHistory chessboardPoses;
+    long long chessboardFrameNumber;
+    // Saved calibration images and the --record video are encoded off the frame loop
+    FrameWriter chessboardWriter;
+    CalibrationWorker chessboardCalibration;
+    int appliedChessboardCalibration;
+    // True while chessFrame has already been undistorted, so pose estimation must not apply dCoeffs again
+    bool framesUndistorted;
+};
+
+ChessboardVideoSession::ChessboardVideoSession()
+    : numImages(0), cameraIsCalibrated(false), chessboardTracker(chessboardSize), hourglassMesh(0),
+      chessboardShading(SHADING_GOURAUD), chessboardFrameNumber(0),
+      chessboardCalibration(chessboardCalibrationFlags, 6), appliedChessboardCalibration(0), framesUndistorted(false)
+{
+    hourglassMesh = chessboardOverlay.addMesh(makeHourglassMesh(100), Scalar(0, 0, 255), 2);
+}
 
 void generateChessBoardImage()
 {
 }
 
 /**
- * @brief Loads the calibration file
+ * @brief Loads the calibration file (any XML layout or the binary format)
  *
  * @param filename path to the calibration file
+ * @return false if the file has no camera calibration
  */
-void loadCalibrationFile(string filename)
+bool ChessboardVideoSession::loadCalibrationFile(string filename)
 {
-    FileStorage fs(filename, FileStorage::READ);
-    fs["camera_matrix"] >> camMatrix;
-    fs["dist_coeffs"] >> dCoeffs;
-
-    rotationsVectors.clear();
-    FileNode rvecNode = fs["rotation_vectors"];
-    for (FileNodeIterator n = rvecNode.begin(); n != rvecNode.end(); ++n)
-    {
-        Mat tmp;
-        *n >> tmp;
-        rotationsVectors.push_back(tmp);
-    }
-
-    translationsVectors.clear();
-    FileNode tvecNode = fs["translation_vectors"];
-    for (FileNodeIterator n = tvecNode.begin(); n != tvecNode.end(); ++n)
+    CalibrationData calibration;
+    if (!loadCalibration(filename, calibration))
     {
-        Mat tmp;
-        *n >> tmp;
-        translationsVectors.push_back(tmp);
+        return false;
     }
+    camMatrix = calibration.cameraMatrix;
+    dCoeffs = calibration.distCoeffs;
 
-    fs.release();
+    // The stored poses are only reported; the live loop keeps its own
     cameraIsCalibrated = true;
 
-    cout << "Loading Parameters" << endl;
-    cout << "Camera Matrix: " << camMatrix << endl;
-    cout << "Distortion Coefficients: " << dCoeffs << endl;
-    cout << "Rotation Vectors: " << rotationsVectors.size() << endl;
-    cout << "Translation Vectors: " << translationsVectors.size() << endl;
-    cout << "Finished loading ...\n" << endl;
+    LOG_INFO("Loading Parameters");
+    LOG_INFO("Camera Matrix: " << camMatrix);
+    LOG_INFO("Distortion Coefficients: " << dCoeffs);
+    LOG_INFO("Rotation Vectors: " << calibration.rvecs.size());
+    LOG_INFO("Translation Vectors: " << calibration.tvecs.size());
+    LOG_INFO("Finished loading ...\n");
+    chessboardPose.reset();
+    return true;
 }
 
 /**
@@ -79,8 +126,9 @@ void loadCalibrationFile(string filename)
  * @param frameWidth frame width
  * @param frameHeight frame height
  */
-void saveCalibrationFile(const Mat &cameraMatrix, const Mat &distCoeffs, double reprojectionError,
-                         const std::vector<Mat> &rvecs, const std::vector<Mat> &tvecs, int frameWidth, int frameHeight)
+static void saveCalibrationFile(const Mat &cameraMatrix, const Mat &distCoeffs, double reprojectionError,
+                                const std::vector<Mat> &rvecs, const std::vector<Mat> &tvecs, int frameWidth,
+                                int frameHeight)
 {
     FileStorage fs("chessboard_calibration_results.xml", FileStorage::WRITE);
     fs << "frame_width" << frameWidth;
@@ -94,188 +142,342 @@ void saveCalibrationFile(const Mat &cameraMatrix, const Mat &distCoeffs, double
 }
 
 /**
- * @brief Saves the chessboard image parameters
+ * @brief Writes the frame to disk and stores its corners as a calibration view. Only the corners are kept in memory.
  *
  * @param frame frame to be saved
+ * @param undistortedWith Maps the frame was undistorted with (null for a raw frame); the view is mapped back to
+ * raw-frame points so the calibration never mixes raw and undistorted corners
  */
-void saveChessBoardImageParameters(Mat frame)
+void ChessboardVideoSession::saveChessBoardImageParameters(const Mat &frame, const UndistortMaps *undistortedWith)
 {
     string filename = "../img/CameraCalibration/" + to_string(++numImages) + "_chessboard_image.jpg";
-    imwrite(filename, frame);
-    cout << "Image saved as " << filename << endl;
+    filename = chessboardWriter.saveImage(filename, frame);
+    if (!filename.empty())
+    {
+        LOG_INFO("Image queued as " << filename);
+    }
 
-    allObjectPoints.push_back(objectPoints);
-    allImagePoints.push_back(imagePoints);
-    allCalibrationFrames.push_back(frame);
+    if (undistortedWith)
+    {
+        vector<Point2f> rawPoints;
+        undistortedWith->distortPoints(imagePoints, rawPoints);
+        chessboardCalibration.addView(objectPoints, rawPoints, frame.size());
+    }
+    else
+    {
+        chessboardCalibration.addView(objectPoints, imagePoints, frame.size());
+    }
 
-    cout << "Number of images: " << numImages << endl;
-    cout << "Number of object points: " << allObjectPoints.size() << endl;
-    cout << "Number of image points: " << allImagePoints.size() << endl;
-    cout << "Number of calibration frames: " << allCalibrationFrames.size() << endl;
+    LOG_INFO("Number of images: " << numImages);
+    LOG_INFO("Number of calibration views: " << chessboardCalibration.views());
 }
 
 /**
- * @brief Calibrates the camera using the chessboard images
+ * @brief Starts using a calibration published by the background worker and saves it
+ *
+ * @param calibration result of the latest background solve
  */
-double calibrateChessBoardCamera()
+void ChessboardVideoSession::applyChessBoardCalibration(const CalibrationSnapshot &calibration)
 {
-    Matx33f cameraMatrix(Matx33f::eye());
-    vector<float> distCoeffs(5, 0);
-    vector<Mat> rvecs, tvecs;
-    vector<double> intrinsics, extrinsics, reprojectionErrors;
-    int calibFlags = CALIB_FIX_ASPECT_RATIO + CALIB_FIX_K3 + CALIB_ZERO_TANGENT_DIST + CALIB_FIX_PRINCIPAL_POINT;
-    Size frameSize(chessFrame.size());
-
-    cout << "\nValues pre-calibration: " << endl;
-    cout << "Camera Matrix:\n " << cameraMatrix << endl;
-    cout << "Distortion Coefficients: ";
-    for (const auto &coeff : distCoeffs)
-    {
-        cout << coeff << " ";
-    }
-    cout << endl;
-    double rms =
-        calibrateCamera(allObjectPoints, allImagePoints, frameSize, cameraMatrix, distCoeffs, rvecs, tvecs, calibFlags);
-
-    cout << "\nValues post-calibration: " << endl;
-    cout << "Reprojection Error: " << rms << endl;
-    cout << "Camera Matrix:\n " << cameraMatrix << endl;
-    cout << "Distortion Coefficients: ";
-    for (const auto &coeff : distCoeffs)
-    {
-        cout << coeff << " ";
-    }
-    cout << endl;
-    cout << "Rotation Vectors: " << rvecs.size() << endl;
-    cout << "Translation Vectors: " << tvecs.size() << endl;
+    calibration.cameraMatrix.copyTo(camMatrix);
+    calibration.distCoeffs.copyTo(dCoeffs);
     cameraIsCalibrated = true;
+    appliedChessboardCalibration = calibration.version;
 
-    Mat matrix = Mat(cameraMatrix);
-    Mat distortion = Mat(distCoeffs);
-    saveCalibrationFile(matrix, distortion, rms, rvecs, tvecs, frameSize.width, frameSize.height);
+    LOG_INFO("\nCalibration " << calibration.version << " (" << calibration.usedViews << " of " << calibration.views
+             << " views, " << calibration.solveMs << " ms in the background)");
+    LOG_INFO("Reprojection Error: " << calibration.reprojectionError);
+    LOG_INFO("Camera Matrix:\n " << calibration.cameraMatrix);
+    LOG_INFO("Distortion Coefficients: " << calibration.distCoeffs.t());
 
-    return rms;
+    saveCalibrationFile(calibration.cameraMatrix, calibration.distCoeffs, calibration.reprojectionError,
+                        calibration.rvecs, calibration.tvecs, calibration.imageSize.width,
+                        calibration.imageSize.height);
 }
 
 /**
  * @brief Detects chessboard corners and draws a 3D pyramid on the chessboard
  */
-void detectChessBoard()
+void ChessboardVideoSession::detectChessBoard()
 {
     Mat gray;
+    ScopedStageTimer grayTimer(STAGE_GRAY);
     cvtColor(chessFrame, gray, COLOR_BGR2GRAY);
+    grayTimer.stop();
 
-    bool found = findChessboardCorners(gray, chessboardSize, imagePoints,
-                                       CALIB_CB_ADAPTIVE_THRESH + CALIB_CB_NORMALIZE_IMAGE + CALIB_CB_FAST_CHECK);
+    // Full findChessboardCorners search only when the board is not being tracked by optical flow
+    bool found = chessboardTracker.process(gray, imagePoints);
 
     if (found)
     {
-        cornerSubPix(gray, imagePoints, Size(11, 11), Size(-1, -1),
-                     TermCriteria(TermCriteria::EPS + TermCriteria::COUNT, 30, 0.1));
-
         if (cameraIsCalibrated)
         {
             Mat rvec, tvec;
+            Mat poseDistortion = framesUndistorted ? Mat() : dCoeffs;
             bool matchingPoints = objectPoints.size() == imagePoints.size();
             // cout << "Matching Points: " << matchingPoints << endl;
             if (matchingPoints)
             {
-                // cout << "Using solvePnP" << endl;
-                // cout << "cameraMatrix: " << camMatrix << endl;
-                // cout << "dCoeffs: " << dCoeffs << endl;
-                // cout << "objectPoints: " << objectPoints << endl;
-                // cout << "imagePoints: " << imagePoints << endl;
-                solvePnP(objectPoints, imagePoints, camMatrix, dCoeffs, rvec, tvec);
-                cout << "Rvec: " << rvec << endl;
-                cout << "Tvec: " << tvec << endl;
-                rotationsVectors.push_back(rvec);
-                translationsVectors.push_back(tvec);
-                drawFrameAxes(chessFrameCopy, camMatrix, dCoeffs, rvec, tvec, 30, 10);
-                projectPoints(objectPoints, rvec, tvec, camMatrix, dCoeffs, imagePoints);
-                int topLeftCorner = 0;
-                int topRightCorner = chessBoard[0] - 1;
-                int bottomLeftCorner = chessBoard[0] * (chessBoard[1] - 1);
-                int bottomRightCorner = chessBoard[0] * chessBoard[1] - 1;
-                vector<int> boardCorners = {topLeftCorner, topRightCorner, bottomLeftCorner, bottomRightCorner};
-
-                // 3D pyramid construction
-                vector<Point3f> pyramidPoints;
-                pyramidPoints.push_back(Point3f(0, 0, 0));     // 0
-                pyramidPoints.push_back(Point3f(0, 100, 0));   // 1
-                pyramidPoints.push_back(Point3f(100, 100, 0)); // 2
-                pyramidPoints.push_back(Point3f(100, 0, 0));   // 3
-
-                pyramidPoints.push_back(Point3f(50, 50, -100)); // 4 peak
-
-                pyramidPoints.push_back(Point3f(0, 0, -200));     // 5
-                pyramidPoints.push_back(Point3f(0, 100, -200));   // 6
-                pyramidPoints.push_back(Point3f(100, 100, -200)); // 7
-                pyramidPoints.push_back(Point3f(100, 0, -200));   // 8
-
-                vector<Point2f> projectedPoints;
-                projectPoints(pyramidPoints, rvec, tvec, camMatrix, dCoeffs, projectedPoints);
-                line(chessFrameCopy, projectedPoints[0], projectedPoints[1], Scalar(0, 0, 255), 2);
-                line(chessFrameCopy, projectedPoints[1], projectedPoints[2], Scalar(0, 0, 255), 2);
-                line(chessFrameCopy, projectedPoints[2], projectedPoints[3], Scalar(0, 0, 255), 2);
-                line(chessFrameCopy, projectedPoints[3], projectedPoints[0], Scalar(0, 0, 255), 2);
-
-                line(chessFrameCopy, projectedPoints[0], projectedPoints[4], Scalar(0, 0, 255), 2);
-                line(chessFrameCopy, projectedPoints[1], projectedPoints[4], Scalar(0, 0, 255), 2);
-                line(chessFrameCopy, projectedPoints[2], projectedPoints[4], Scalar(0, 0, 255), 2);
-                line(chessFrameCopy, projectedPoints[3], projectedPoints[4], Scalar(0, 0, 255), 2);
-
-                line(chessFrameCopy, projectedPoints[5], projectedPoints[6], Scalar(0, 0, 255), 2);
-                line(chessFrameCopy, projectedPoints[6], projectedPoints[7], Scalar(0, 0, 255), 2);
-                line(chessFrameCopy, projectedPoints[7], projectedPoints[8], Scalar(0, 0, 255), 2);
-                line(chessFrameCopy, projectedPoints[8], projectedPoints[5], Scalar(0, 0, 255), 2);
-
-                line(chessFrameCopy, projectedPoints[5], projectedPoints[4], Scalar(0, 0, 255), 2);
-                line(chessFrameCopy, projectedPoints[6], projectedPoints[4], Scalar(0, 0, 255), 2);
-                line(chessFrameCopy, projectedPoints[7], projectedPoints[4], Scalar(0, 0, 255), 2);
-                line(chessFrameCopy, projectedPoints[8], projectedPoints[4], Scalar(0, 0, 255), 2);
+                ScopedStageTimer poseTimer(STAGE_POSE);
+                if (!chessboardPose.estimate(objectPoints, imagePoints, camMatrix, poseDistortion, rvec, tvec))
+                {
+                    return;
+                }
+                poseTimer.stop();
+                // Every frame has a pose; printing each one would stall the loop on the terminal
+                LOG_EVERY_MS(LOG_LEVEL_DEBUG, 1000, "Rvec: " << rvec.t() << " Tvec: " << tvec.t());
+                chessboardPoses.push(chessboardFrameNumber, rvec, tvec);
+
+                ScopedStageTimer drawTimer(STAGE_DRAW);
+                drawFrameAxes(chessFrameCopy, camMatrix, poseDistortion, rvec, tvec, 30, 10);
+
+                if (!chessboardModel.empty())
+                {
+                    chessboardRasterizer.beginFrame(chessFrameCopy.size());
+                    chessboardRasterizer.draw(chessFrameCopy, chessboardModel, rvec, tvec, camMatrix, poseDistortion,
+                                              Scalar(80, 180, 255), chessboardShading);
+                }
+                else
+                {
+                    // 3D hourglass, built once and projected in one batch
+                    chessboardOverlay.clearInstances();
+                    chessboardOverlay.addInstance(hourglassMesh, rvec, tvec);
+                    chessboardOverlay.render(chessFrameCopy, camMatrix, poseDistortion);
+                }
             }
         }
 
         // drawChessboardCorners(chessFrameCopy, chessboardSize, Mat(imagePoints), found);
     }
+    else
+    {
+        chessboardPose.reset();
+    }
 }
 
 /**
- * @brief Opens video streaming, detects chessboard corners, and calibrates the camera. Once calibrated, the user can
- * save the calibration parameters to a file. It will also project a 3D hourglass on the chessboard.
+ * @brief Compares the single-scale chessboard detection with the coarse-to-fine path on a directory of images. Both
+ * are timed over several repeats; the corner difference is measured against the single-scale corners.
  *
- * @param calibrationFile path to the calibration file
+ * @param directory directory of chessboard images
+ * @param repeats number of timed runs per image and path
  */
-int chessboardDetectionAndCalibration(string calibrationFile)
+int benchmarkChessboardDetection(string directory, int repeats)
 {
-    VideoCapture cap(0);
-    if (!cap.isOpened())
+    ImageDirectoryFrameSource source(directory);
+    if (!source.isOpened())
     {
-        cerr << "Error opening video stream" << endl;
+        LOG_WARN("No images found in " << directory);
         return -1;
     }
 
-    cout << "\nWelcome to the Augmented Reality Application\n" << endl;
-    cout << "Press 'q' to quit the program" << endl;
-    cout << "Press 's' to save a calibration image" << endl;
-    cout << "Press 'c' to calibrate the camera" << endl;
-    cout << "\n" << endl;
+    LOG_INFO("Benchmarking chessboard detection on " << source.describe() << ", " << repeats << " repeats");
+    LOG_INFO("image\tsize\tlevels\tsingle_ms\tmulti_ms\tspeedup\tmean_px\tmax_px");
+
+    double totalSingleMs = 0, totalMultiMs = 0, worstDifference = 0;
+    int comparedImages = 0;
+    size_t index = 0;
+    Mat image, gray;
+    while (source.read(image))
+    {
+        string name = source.files()[index++];
+        cvtColor(image, gray, COLOR_BGR2GRAY);
+
+        vector<Point2f> singleCorners, multiCorners;
+        bool singleFound = false, multiFound = false;
+        double singleMs = 0, multiMs = 0;
+        for (int r = 0; r < repeats; r++)
+        {
+            int64 start = getTickCount();
+            singleFound = findChessboardCornersSingleScale(gray, chessboardSize, singleCorners);
+            singleMs += (getTickCount() - start) * 1000.0 / getTickFrequency();
+
+            start = getTickCount();
+            multiFound = findChessboardCornersMultiScale(gray, chessboardSize, multiCorners);
+            multiMs += (getTickCount() - start) * 1000.0 / getTickFrequency();
+        }
+        singleMs /= repeats;
+        multiMs /= repeats;
+
+        ostringstream row;
+        row << name << "\t" << gray.cols << "x" << gray.rows << "\t" << chessboardPyramidLevels(gray.size()) << "\t"
+            << singleMs << "\t" << multiMs << "\t" << singleMs / multiMs << "\t";
+        if (singleFound && multiFound)
+        {
+            double sum = 0, worst = 0;
+            for (size_t i = 0; i < singleCorners.size(); i++)
+            {
+                double distance = norm(singleCorners[i] - multiCorners[i]);
+                sum += distance;
+                worst = max(worst, distance);
+            }
+            row << sum / singleCorners.size() << "\t" << worst;
+            totalSingleMs += singleMs;
+            totalMultiMs += multiMs;
+            worstDifference = max(worstDifference, worst);
+            comparedImages++;
+        }
+        else
+        {
+            row << "single " << (singleFound ? "found" : "missed") << ", multi " << (multiFound ? "found" : "missed");
+        }
+        LOG_INFO(row.str());
+    }
+
+    if (comparedImages > 0)
+    {
+        LOG_INFO("\nBoards found by both paths: " << comparedImages);
+        LOG_INFO("Mean time: single " << totalSingleMs / comparedImages << " ms, multi "
+                 << totalMultiMs / comparedImages << " ms (" << totalSingleMs / totalMultiMs << "x)");
+        LOG_INFO("Largest corner difference: " << worstDifference << " px");
+    }
+    return 0;
+}
+
+/**
+ * @brief Compares the original per-frame pose path (solvePnP from scratch, then projectPoints over every corner) with
+ * the warm-started estimator on a stream of chessboard frames. Reports both solve times, the estimator's mode and
+ * iteration count for every frame, and how far the two poses are apart.
+ *
+ * @param source frame source spec (see StreamOptions::source)
+ * @param calibrationFile calibration to use; nominal intrinsics (focal length = width) when empty
+ * @param maxFrames stop after this many frames (0 = until the source is exhausted)
+ */
+int benchmarkPoseEstimation(string source, string calibrationFile, int maxFrames)
+{
+    Ptr<FrameSource> frames = openFrameSource(source);
+    if (!frames->isOpened())
+    {
+        LOG_ERROR("Error opening frame source: " << frames->describe());
+        return -1;
+    }
+
+    Mat cameraMatrix, distCoeffs;
+    if (!calibrationFile.empty())
+    {
+        CalibrationData calibration;
+        if (!loadCalibration(calibrationFile, calibration))
+        {
+            return -1;
+        }
+        cameraMatrix = calibration.cameraMatrix;
+        distCoeffs = calibration.distCoeffs;
+    }
+
+    vector<Point3f> boardPoints;
+    for (int i = 0; i < chessBoard[1]; i++)
+    {
+        for (int j = 0; j < chessBoard[0]; j++)
+        {
+            boardPoints.push_back(Point3f(j * squareSize, i * squareSize, 0));
+        }
+    }
+
+    LOG_INFO("Benchmarking pose estimation on " << frames->describe());
+    LOG_INFO("frame	solvepnp_ms	estimator_ms	mode	iterations	rms_px	rotation_diff_deg	translation_diff_mm");
+
+    ChessboardTracker tracker(chessboardSize);
+    PoseEstimator estimator;
+    double totalBaselineMs = 0, totalEstimatorMs = 0;
+    int posedFrames = 0, frameIndex = 0;
+    Mat frame, gray;
+    vector<Point2f> corners, reprojected;
+    while ((maxFrames <= 0 || frameIndex < maxFrames) && frames->read(frame))
+    {
+        frameIndex++;
+        cvtColor(frame, gray, COLOR_BGR2GRAY);
+        if (cameraMatrix.empty())
+        {
+            cameraMatrix = (Mat_<double>(3, 3) << gray.cols, 0, gray.cols / 2.0, 0, gray.cols, gray.rows / 2.0, 0,
+                            0, 1);
+        }
+        if (!tracker.process(gray, corners))
+        {
+            estimator.reset();
+            LOG_INFO(frameIndex << "	board not found");
+            continue;
+        }
+
+        // The path detectChessBoard used to take on every frame
+        Mat baselineRvec, baselineTvec;
+        int64 start = getTickCount();
+        solvePnP(boardPoints, corners, cameraMatrix, distCoeffs, baselineRvec, baselineTvec);
+        projectPoints(boardPoints, baselineRvec, baselineTvec, cameraMatrix, distCoeffs, reprojected);
+        double baselineMs = (getTickCount() - start) * 1000.0 / getTickFrequency();
+
+        Mat rvec, tvec;
+        start = getTickCount();
+        bool posed = estimator.estimate(boardPoints, corners, cameraMatrix, distCoeffs, rvec, tvec);
+        double estimatorMs = (getTickCount() - start) * 1000.0 / getTickFrequency();
+        if (!posed)
+        {
+            LOG_INFO(frameIndex << "	" << baselineMs << "	no pose");
+            continue;
+        }
+
+        // Angle of the rotation taking one pose to the other
+        Mat baselineRotation, rotation;
+        Rodrigues(baselineRvec, baselineRotation);
+        Rodrigues(rvec, rotation);
+        Mat relative;
+        Rodrigues(rotation * baselineRotation.t(), relative);
+        double rotationDiff = norm(relative) * 180.0 / CV_PI;
+        double translationDiff = norm(tvec, baselineTvec);
+
+        LOG_INFO(frameIndex << "	" << baselineMs << "	" << estimatorMs << "	"
+                 << (estimator.lastSolveWarm() ? "warm" : "cold") << "	" << estimator.lastIterations() << "	"
+                 << estimator.lastError() << "	" << rotationDiff << "	" << translationDiff);
+        totalBaselineMs += baselineMs;
+        totalEstimatorMs += estimatorMs;
+        posedFrames++;
+    }
+
+    if (posedFrames > 0)
+    {
+        LOG_INFO("\nFrames with a pose: " << posedFrames);
+        LOG_INFO("Mean time: solvePnP + projectPoints " << totalBaselineMs / posedFrames << " ms, estimator "
+                 << totalEstimatorMs / posedFrames << " ms (" << totalBaselineMs / totalEstimatorMs << "x)");
+    }
+    estimator.stats().report();
+    return 0;
+}
+
+/**
+ * @brief Runs the interactive detection and calibration loop over source
+ *
+ * @param source The frame source
+ * @param calibrationFile path to the calibration file
+ * @param options Frame source and headless settings
+ */
+int ChessboardVideoSession::run(FrameSource &source, const string &calibrationFile, const StreamOptions &options)
+{
+    LOG_INFO("\nWelcome to the Augmented Reality Application\n");
+    LOG_INFO("Press 'q' to quit the program");
+    LOG_INFO("Press 's' to save a calibration image");
+    LOG_INFO("Press 'c' to calibrate the camera");
+    LOG_INFO("\n");
 
     if (calibrationFile != "")
     {
-        cout << "Utilizing calibration file: " << calibrationFile << endl;
+        LOG_INFO("Utilizing calibration file: " << calibrationFile);
         try
         {
-            loadCalibrationFile(calibrationFile);
+            if (!loadCalibrationFile(calibrationFile))
+            {
+                return -1;
+            }
         }
         catch (const Exception &e)
         {
-            cerr << "Error loading calibration file: " << e.what() << endl;
+            LOG_ERROR("Error loading calibration file: " << e.what());
             return -1;
         }
     }
 
-    namedWindow("Chessboard Detection", WINDOW_AUTOSIZE);
+    if (!options.headless)
+    {
+        namedWindow("Chessboard Detection", WINDOW_AUTOSIZE);
+    }
 
     for (int i = 0; i < chessBoard[1]; i++)
     {
@@ -285,42 +487,147 @@ int chessboardDetectionAndCalibration(string calibrationFile)
         }
     }
 
-    while (true)
+    if (!options.modelFile.empty())
+    {
+        if (!loadObjModel(options.modelFile, chessboardModel))
+        {
+            return -1;
+        }
+        // Stands in the middle of the board, as tall as four squares
+        placeObjModel(chessboardModel, 4.0f * squareSize,
+                      Point2f((chessBoard[0] - 1) * squareSize / 2.0f, (chessBoard[1] - 1) * squareSize / 2.0f));
+        chessboardShading = options.flatShading ? SHADING_FLAT : SHADING_GOURAUD;
+        LOG_INFO("Loaded model " << options.modelFile << " (" << chessboardModel.triangles.size() << " triangles)");
+    }
+
+    chessboardPoses.setCapacity(options.poseHistory > 0 ? options.poseHistory : defaultPoseHistoryCapacity);
+    if (!options.poseLog.empty() && !chessboardPoses.streamTo(options.poseLog))
+    {
+        return -1;
+    }
+    configureFrameWriter(chessboardWriter, options);
+
+    LOG_INFO("Reading frames from " << source.describe());
+    chessboardTracker.setRedetectInterval(options.chessboardRedetectInterval);
+
+    Ptr<UndistortMaps> undistortMaps;
+    Mat undistorted;
+    UndistortTiming undistortTiming;
+    FrameRateCounter frameRate;
+    while (!frameLimitReached(frameRate, options))
     {
+        ScopedStageTimer frameTimer(STAGE_FRAME);
+        ScopedStageTimer captureTimer(STAGE_CAPTURE);
+        if (!source.read(chessFrame))
+        {
+            if (source.isLive())
+            {
+                LOG_ERROR("Error: Could not capture frame");
+            }
+            break;
+        }
+        captureTimer.stop();
 
-        cap >> chessFrame;
+        framesUndistorted = options.undistort && cameraIsCalibrated && !camMatrix.empty();
+        if (framesUndistorted)
+        {
+            ScopedStageTimer undistortTimer(STAGE_UNDISTORT);
+            if (!undistortMaps || !undistortMaps->matches(camMatrix, dCoeffs, chessFrame.size()))
+            {
+                undistortMaps = loadOrBuildUndistortMaps(camMatrix, dCoeffs, chessFrame.size(), calibrationFile);
+            }
+            int64 start = getTickCount();
+            undistortMaps->apply(chessFrame, undistorted);
+            swap(chessFrame, undistorted);
+            undistortTiming.add((getTickCount() - start) * 1000.0 / getTickFrequency());
+        }
         chessFrame.copyTo(chessFrameCopy);
 
+        chessboardFrameNumber++;
         detectChessBoard();
 
-        imshow("Chessboard Detection", chessFrameCopy);
+        // Pick up a finished background solve without waiting for one
+        shared_ptr<const CalibrationSnapshot> calibration = chessboardCalibration.latest();
+        if (calibration && calibration->version != appliedChessboardCalibration)
+        {
+            applyChessBoardCalibration(*calibration);
+        }
+        if (chessboardCalibration.solving())
+        {
+            putText(chessFrameCopy, "Calibrating with " + to_string(chessboardCalibration.views()) + " views...",
+                    Point(10, 30), FONT_HERSHEY_SIMPLEX, .75, Scalar(0, 0, 255), 2);
+        }
+
+        ScopedStageTimer writeTimer(STAGE_WRITE);
+        chessboardWriter.record(chessFrameCopy);
+        writeTimer.stop();
 
-        char key = (char)waitKey(10);
+        frameRate.tick();
+        ScopedStageTimer displayTimer(STAGE_DISPLAY);
+        char key = presentFrame("Chessboard Detection", chessFrameCopy, options);
+        displayTimer.stop();
         if (key == 'q' || key == 'Q' || key == 27)
         {
-            cout << "User terminated program" << endl;
+            LOG_INFO("User terminated program");
             break;
         }
         if (key == 's' || key == 'S')
         {
-            cout << "Saving frame..." << endl;
-            saveChessBoardImageParameters(chessFrameCopy);
-            waitKey(500);
+            LOG_INFO("Saving frame...");
+            saveChessBoardImageParameters(chessFrameCopy, framesUndistorted ? undistortMaps.get() : 0);
         }
         if (key == 'c' || key == 'C')
         {
-            if (allImagePoints.size() < 1)
+            if (chessboardCalibration.views() < 1)
             {
-                cout << "No images saved for calibration" << endl;
+                LOG_INFO("No images saved for calibration");
                 continue;
             }
-            else if (allImagePoints.size() > 5)
+            else if (chessboardCalibration.views() > 5)
             {
-                cout << "Calibrating camera..." << endl;
-                double error = calibrateChessBoardCamera();
+                // Solves on the worker thread; every later 's' re-solves from the current intrinsics
+                LOG_INFO("Calibrating camera in the background...");
+                chessboardCalibration.start();
+            }
+            else
+            {
+                LOG_INFO("Need at least 6 calibration images");
             }
         }
     }
 
+    frameRate.report("Chessboard detection");
+    undistortTiming.report();
+    chessboardTracker.stats().report();
+    chessboardPose.stats().report();
+    chessboardOverlay.stats().report();
+    if (!chessboardModel.empty())
+    {
+        chessboardRasterizer.stats().report();
+    }
+    chessboardPoses.report();
+    reportSessionMemory();
+    chessboardWriter.flush();
+    chessboardWriter.stats().report();
+    finishStageTimes("Chessboard detection", options.statsFile);
     return 0;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Opens video streaming, detects chessboard corners, and calibrates the camera. Once calibrated, the user can
+ * save the calibration parameters to a file. It will also project a 3D hourglass on the chessboard.
+ *
+ * @param calibrationFile path to the calibration file
+ * @param options Frame source and headless settings
+ */
+int chessboardDetectionAndCalibration(string calibrationFile, const StreamOptions &options)
+{
+    Ptr<FrameSource> source = openFrameSource(options.source);
+    if (!source->isOpened())
+    {
+        LOG_ERROR("Error opening video stream: " << source->describe());
+        return -1;
+    }
+    ChessboardVideoSession session;
+    return session.run(*source, calibrationFile, options);
+}
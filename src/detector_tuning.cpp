@@ -0,0 +1,383 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Offline search over Aruco DetectorParameters for the best detection time vs. recall/accuracy trade-off
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <opencv2/aruco.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "aruco_tracker.h"
+#include "detector_tuning.h"
+#include "frame_source.h"
+#include "logger.h"
+#include "thread_pool.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Adaptive threshold passes: window sizes min, min + step, ... up to max
+ */
+struct ThresholdSweep
+{
+    int minWindow;
+    int maxWindow;
+    int step;
+};
+
+// The first entry of each list is OpenCV's default, so the grid's first combination is the untuned detector
+static const ThresholdSweep thresholdSweeps[] = {{3, 23, 10}, {3, 33, 10}, {3, 23, 20}, {7, 17, 10}, {13, 13, 10},
+                                                 {23, 23, 10}};
+static const double perimeterRates[] = {0.03, 0.01, 0.05, 0.1};
+static const aruco::CornerRefineMethod refineMethods[] = {aruco::CORNER_REFINE_NONE, aruco::CORNER_REFINE_SUBPIX,
+                                                          aruco::CORNER_REFINE_CONTOUR};
+static const int pixelsPerCell[] = {4, 2, 8};
+
+/**
+ * @brief One parameter combination and how it did on the image set
+ *
+ * recall      - reference markers found, as a fraction of all reference markers
+ * refDeviation - mean distance in pixels between found corners and the reference corners of the same marker. The
+ *               reference refines with SUBPIX, so this measures agreement with SUBPIX corners, not accuracy: SUBPIX
+ *               entries score close to 0 and NONE or CONTOUR entries are charged for any difference, right or wrong
+ * extraMarkers - markers found that the reference did not find (false positives or markers the reference missed)
+ */
+struct DetectorTrial
+{
+    aruco::DetectorParameters params;
+    string label;
+    double meanMs;
+    double recall;
+    double refDeviation;
+    long long extraMarkers;
+    bool pareto;
+
+    DetectorTrial() : meanMs(0), recall(0), refDeviation(0), extraMarkers(0), pareto(false)
+    {
+    }
+};
+
+/**
+ * @brief Markers found in one image
+ */
+struct ImageMarkers
+{
+    vector<int> ids;
+    vector<vector<Point2f>> corners;
+};
+
+static const char *refineMethodName(int method)
+{
+    switch (method)
+    {
+    case aruco::CORNER_REFINE_SUBPIX:
+        return "subpix";
+    case aruco::CORNER_REFINE_CONTOUR:
+        return "contour";
+    case aruco::CORNER_REFINE_APRILTAG:
+        return "apriltag";
+    default:
+        return "none";
+    }
+}
+
+static string trialLabel(const aruco::DetectorParameters &params)
+{
+    ostringstream label;
+    label << "window " << params.adaptiveThreshWinSizeMin << "-" << params.adaptiveThreshWinSizeMax << "/"
+          << params.adaptiveThreshWinSizeStep << ", perimeter " << params.minMarkerPerimeterRate << ", refine "
+          << refineMethodName(params.cornerRefinementMethod) << ", " << params.perspectiveRemovePixelPerCell
+          << " px/cell";
+    return label.str();
+}
+
+static vector<DetectorTrial> buildTrials()
+{
+    vector<DetectorTrial> trials;
+    for (size_t w = 0; w < sizeof(thresholdSweeps) / sizeof(thresholdSweeps[0]); w++)
+    {
+        for (size_t p = 0; p < sizeof(perimeterRates) / sizeof(perimeterRates[0]); p++)
+        {
+            for (size_t r = 0; r < sizeof(refineMethods) / sizeof(refineMethods[0]); r++)
+            {
+                for (size_t c = 0; c < sizeof(pixelsPerCell) / sizeof(pixelsPerCell[0]); c++)
+                {
+                    DetectorTrial trial;
+                    trial.params.adaptiveThreshWinSizeMin = thresholdSweeps[w].minWindow;
+                    trial.params.adaptiveThreshWinSizeMax = thresholdSweeps[w].maxWindow;
+                    trial.params.adaptiveThreshWinSizeStep = thresholdSweeps[w].step;
+                    trial.params.minMarkerPerimeterRate = perimeterRates[p];
+                    trial.params.cornerRefinementMethod = refineMethods[r];
+                    trial.params.perspectiveRemovePixelPerCell = pixelsPerCell[c];
+                    trial.label = trialLabel(trial.params);
+                    trials.push_back(trial);
+                }
+            }
+        }
+    }
+    return trials;
+}
+
+/**
+ * @brief The most thorough settings in the grid: every threshold window, the smallest markers, sub-pixel corners
+ */
+static aruco::DetectorParameters referenceParameters()
+{
+    aruco::DetectorParameters params;
+    params.adaptiveThreshWinSizeMin = 3;
+    params.adaptiveThreshWinSizeMax = 33;
+    params.adaptiveThreshWinSizeStep = 5;
+    params.minMarkerPerimeterRate = 0.01;
+    params.cornerRefinementMethod = aruco::CORNER_REFINE_SUBPIX;
+    params.perspectiveRemovePixelPerCell = 8;
+    return params;
+}
+
+static void detectReference(ArucoTracker &tracker, const Mat &image, ImageMarkers &markers)
+{
+    tracker.detect(image);
+    markers.ids = tracker.ids();
+    markers.corners = tracker.corners();
+}
+
+/**
+ * @brief Runs one trial over every image and scores it against the reference markers
+ */
+static void runTrial(DetectorTrial &trial, const vector<Mat> &images, const vector<ImageMarkers> &reference)
+{
+    ArucoTracker tracker(aruco::DICT_6X6_250, Size(5, 7), 10, 10, trial.params);
+    // Untimed first run so one-off allocations are not charged to the first image
+    tracker.detect(images[0]);
+
+    double totalMs = 0, totalDeviation = 0;
+    long long referenceMarkers = 0, foundMarkers = 0, matchedCorners = 0;
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        tracker.detect(images[i]);
+        totalMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        const ImageMarkers &expected = reference[i];
+        referenceMarkers += expected.ids.size();
+        for (size_t m = 0; m < tracker.ids().size(); m++)
+        {
+            vector<int>::const_iterator match = find(expected.ids.begin(), expected.ids.end(), tracker.ids()[m]);
+            if (match == expected.ids.end())
+            {
+                trial.extraMarkers++;
+                continue;
+            }
+            foundMarkers++;
+            const vector<Point2f> &expectedCorners = expected.corners[match - expected.ids.begin()];
+            for (size_t c = 0; c < expectedCorners.size(); c++)
+            {
+                totalDeviation += norm(tracker.corners()[m][c] - expectedCorners[c]);
+                matchedCorners++;
+            }
+        }
+    }
+    trial.meanMs = totalMs / images.size();
+    trial.recall = referenceMarkers > 0 ? (double)foundMarkers / referenceMarkers : 0.0;
+    trial.refDeviation = matchedCorners > 0 ? totalDeviation / matchedCorners : 0.0;
+}
+
+/**
+ * @brief True if a is at least as good as b on time, recall and reference deviation, and better on one of them
+ */
+static bool dominates(const DetectorTrial &a, const DetectorTrial &b)
+{
+    bool noWorse = a.meanMs <= b.meanMs && a.recall >= b.recall && a.refDeviation <= b.refDeviation;
+    bool better = a.meanMs < b.meanMs || a.recall > b.recall || a.refDeviation < b.refDeviation;
+    return noWorse && better;
+}
+
+static bool fasterTrial(const DetectorTrial &a, const DetectorTrial &b)
+{
+    return a.meanMs < b.meanMs;
+}
+
+bool loadDetectorParameters(const string &filename, aruco::DetectorParameters &params)
+{
+    FileStorage fs(filename, FileStorage::READ);
+    if (!fs.isOpened())
+    {
+        LOG_ERROR("Could not open detector parameters file: " << filename);
+        return false;
+    }
+    aruco::DetectorParameters loaded;
+    if (!loaded.readDetectorParameters(fs.root()))
+    {
+        LOG_ERROR("No detector parameters in " << filename);
+        return false;
+    }
+    params = loaded;
+    return true;
+}
+
+bool saveDetectorParameters(const string &filename, const aruco::DetectorParameters &params, const string &comment)
+{
+    FileStorage fs(filename, FileStorage::WRITE);
+    if (!fs.isOpened())
+    {
+        LOG_ERROR("Could not write " << filename);
+        return false;
+    }
+    if (!comment.empty())
+    {
+        fs.writeComment(comment);
+    }
+    return params.writeDetectorParameters(fs);
+}
+
+int tuneDetectorParameters(const string &directory, const string &outputFile, int threads, double minRecall,
+                           double maxRefDeviation)
+{
+    ImageDirectoryFrameSource source(directory);
+    if (!source.isOpened())
+    {
+        LOG_WARN("No images found in " << directory);
+        return -1;
+    }
+    // Decoded once up front so the trials time detection only
+    vector<Mat> images;
+    Mat image;
+    while (source.read(image))
+    {
+        Mat gray;
+        cvtColor(image, gray, COLOR_BGR2GRAY);
+        images.push_back(gray);
+    }
+    if (images.empty())
+    {
+        LOG_WARN("No images could be decoded in " << directory);
+        return -1;
+    }
+
+    ThreadPool pool(threads);
+    // The trials are the parallelism, and single-thread detection times are what the stream loop sees per worker
+    int openCvThreads = getNumThreads();
+    setNumThreads(1);
+
+    vector<ImageMarkers> reference(images.size());
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        pool.submit([&, i]() {
+            ArucoTracker tracker(aruco::DICT_6X6_250, Size(5, 7), 10, 10, referenceParameters());
+            detectReference(tracker, images[i], reference[i]);
+        });
+    }
+    pool.wait();
+    long long referenceMarkers = 0;
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        referenceMarkers += reference[i].ids.size();
+    }
+    LOG_INFO("Tuning detector parameters on " << images.size() << " images from " << source.describe() << ", "
+             << referenceMarkers << " reference markers");
+    if (referenceMarkers == 0)
+    {
+        setNumThreads(openCvThreads);
+        LOG_ERROR("The reference detection found no markers; nothing to tune against");
+        return -1;
+    }
+
+    vector<DetectorTrial> trials = buildTrials();
+    LOG_INFO("Running " << trials.size() << " parameter combinations on " << pool.size() << " workers");
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0; i < trials.size(); i++)
+    {
+        pool.submit([&, i]() { runTrial(trials[i], images, reference); });
+    }
+    pool.wait();
+    double elapsedSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    setNumThreads(openCvThreads);
+
+    // The grid's first entry is OpenCV's default; keep it for comparison before the trials are reordered
+    DetectorTrial defaults = trials[0];
+    vector<DetectorTrial> front;
+    for (size_t i = 0; i < trials.size(); i++)
+    {
+        trials[i].pareto = true;
+        for (size_t j = 0; j < trials.size() && trials[i].pareto; j++)
+        {
+            trials[i].pareto = !dominates(trials[j], trials[i]);
+        }
+        if (trials[i].pareto)
+        {
+            front.push_back(trials[i]);
+        }
+    }
+    sort(front.begin(), front.end(), fasterTrial);
+
+    // Fastest entry that keeps enough recall and stays close to the reference corners; failing that the fastest one
+    // with enough recall, failing that the highest recall
+    int chosen = -1, fastestWithRecall = -1, highestRecall = 0;
+    for (size_t i = 0; i < front.size(); i++)
+    {
+        if (front[i].recall >= minRecall)
+        {
+            if (fastestWithRecall < 0)
+            {
+                fastestWithRecall = (int)i;
+            }
+            if (chosen < 0 && front[i].refDeviation <= maxRefDeviation)
+            {
+                chosen = (int)i;
+            }
+        }
+        if (front[i].recall > front[highestRecall].recall)
+        {
+            highestRecall = (int)i;
+        }
+    }
+    bool recallMet = fastestWithRecall >= 0;
+    bool deviationMet = chosen >= 0;
+    if (!deviationMet)
+    {
+        chosen = recallMet ? fastestWithRecall : highestRecall;
+    }
+
+    LOG_INFO("Searched in " << elapsedSeconds << " s. Pareto front (" << front.size() << " of " << trials.size()
+             << " combinations):");
+    LOG_INFO("  ms/image\trecall\tref dev px\textra\tparameters");
+    for (size_t i = 0; i < front.size(); i++)
+    {
+        LOG_INFO(((int)i == chosen ? "* " : "  ") << fixed << setprecision(2) << front[i].meanMs << "\t\t"
+                 << setprecision(3) << front[i].recall << "\t" << front[i].refDeviation << "\t\t"
+                 << front[i].extraMarkers << "\t" << front[i].label);
+    }
+    LOG_INFO("OpenCV defaults: " << fixed << setprecision(2) << defaults.meanMs << " ms/image, recall "
+             << setprecision(3) << defaults.recall << ", " << defaults.refDeviation
+             << " px from the reference corners");
+    LOG_INFO("ref dev is the distance to the reference's SUBPIX corners, so it measures agreement with SUBPIX "
+             << "refinement rather than accuracy");
+    if (!recallMet)
+    {
+        LOG_WARN("No combination reached a recall of " << minRecall << "; choosing the highest recall instead");
+    }
+    else if (!deviationMet)
+    {
+        LOG_WARN("No combination with a recall of " << minRecall << " stays within " << maxRefDeviation
+                 << " px of the reference corners; choosing the fastest one with that recall instead");
+    }
+    else if (chosen != fastestWithRecall)
+    {
+        const DetectorTrial &fastest = front[fastestWithRecall];
+        LOG_INFO("Trade-off: " << fastest.label << " is faster (" << fixed << setprecision(2) << fastest.meanMs
+                 << " ms/image) but its corners are " << setprecision(3) << fastest.refDeviation
+                 << " px from the reference, above the " << maxRefDeviation << " px bound");
+    }
+
+    const DetectorTrial &best = front[chosen];
+    LOG_INFO("Chosen: " << best.label << " (" << (best.meanMs > 0 ? defaults.meanMs / best.meanMs : 0.0)
+             << "x the default speed)");
+    if (!saveDetectorParameters(outputFile, best.params, "Tuned on " + directory + ": " + best.label))
+    {
+        return -1;
+    }
+    LOG_INFO("Detector parameters written to " << outputFile << " (use with --detector-params " << outputFile
+             << " in -v, -ms or -bcal aruco)");
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Per-frame cache of derived images (gray, pyramid levels, blurred gray) shared by every detector
+
+#include <chrono>
+
+#include "frame_context.h"
+#include "logger.h"
+#include "stage_timer.h"
+
+using namespace std;
+using namespace cv;
+
+const int FrameContext::maxPyramidLevels;
+
+void FrameContextStats::report() const
+{
+    LOG_INFO("Frame context: " << requests << " derived images requested over " << frames << " frames, "
+             << computations << " computed (" << (frames > 0 ? (double)computations / frames : 0.0)
+             << " per frame, " << (computations > 0 ? computeMs / computations : 0.0) << " ms each), "
+             << requests - computations << " served from the cache");
+}
+
+FrameContext::FrameContext()
+    : hasGray(false), pyramidLevels(0), frameCount(0), requestCount(0), computationCount(0), computeMicros(0)
+{
+}
+
+void FrameContext::reset(const Mat &newFrame)
+{
+    frame = newFrame;
+    hasGray = false;
+    pyramidLevels = 0;
+    for (map<int, bool>::iterator it = blurValid.begin(); it != blurValid.end(); ++it)
+    {
+        it->second = false;
+    }
+    frameCount++;
+}
+
+void FrameContext::countRequest(bool computed, double ms)
+{
+    requestCount.fetch_add(1, memory_order_relaxed);
+    if (computed)
+    {
+        computationCount.fetch_add(1, memory_order_relaxed);
+        computeMicros.fetch_add((long long)(ms * 1000), memory_order_relaxed);
+    }
+}
+
+const Mat &FrameContext::gray()
+{
+    lock_guard<mutex> guard(grayLock);
+    bool computed = !hasGray;
+    double ms = 0;
+    if (computed)
+    {
+        ScopedStageTimer grayTimer(STAGE_GRAY);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        if (frame.channels() == 1)
+        {
+            grayFrame = frame;
+        }
+        else
+        {
+            cvtColor(frame, grayFrame, frame.channels() == 4 ? COLOR_BGRA2GRAY : COLOR_BGR2GRAY);
+        }
+        hasGray = true;
+        ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+    countRequest(computed, ms);
+    return grayFrame;
+}
+
+const Mat &FrameContext::pyramidLevel(int level)
+{
+    level = max(0, min(level, maxPyramidLevels - 1));
+    if (level == 0)
+    {
+        return gray();
+    }
+    const Mat &base = gray();
+
+    lock_guard<mutex> guard(pyramidLock);
+    bool computed = pyramidLevels <= level;
+    double ms = 0;
+    if (computed)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        // Each level is built from the one above, so asking for level 2 also caches level 1
+        for (int i = max(1, pyramidLevels); i <= level; i++)
+        {
+            pyrDown(i == 1 ? base : pyramid[i - 1], pyramid[i]);
+        }
+        pyramidLevels = level + 1;
+        ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+    countRequest(computed, ms);
+    return pyramid[level];
+}
+
+const Mat &FrameContext::blurred(int kernelSize)
+{
+    kernelSize = max(1, kernelSize | 1);
+    const Mat &base = gray();
+
+    lock_guard<mutex> guard(blurLock);
+    // std::map never moves its elements, so references handed out earlier stay valid as entries are added
+    Mat &blurredFrame = blurredFrames[kernelSize];
+    bool &valid = blurValid[kernelSize];
+    bool computed = !valid;
+    double ms = 0;
+    if (computed)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        GaussianBlur(base, blurredFrame, Size(kernelSize, kernelSize), 0);
+        valid = true;
+        ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+    countRequest(computed, ms);
+    return blurredFrame;
+}
+
+FrameContextStats FrameContext::stats() const
+{
+    FrameContextStats stats;
+    stats.frames = frameCount.load();
+    stats.requests = requestCount.load();
+    stats.computations = computationCount.load();
+    stats.computeMs = computeMicros.load() / 1000.0;
+    return stats;
+}
@@ -0,0 +1,272 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Frame sources (camera, video file, image directory, memory) and headless stream helpers
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <opencv2/core/utils/filesystem.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.h"
+#include "logger.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Checks whether a file name has one of the image extensions imread understands
+ *
+ * @param filename file name to check
+ */
+static bool isImageFile(const string &filename)
+{
+    size_t dot = filename.find_last_of('.');
+    if (dot == string::npos)
+    {
+        return false;
+    }
+    string extension = filename.substr(dot + 1);
+    transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "bmp" ||
+           extension == "tif" || extension == "tiff" || extension == "ppm" || extension == "pgm";
+}
+
+/**
+ * @brief Checks whether a source spec is a camera device index
+ *
+ * @param spec source spec
+ */
+static bool isDeviceIndex(const string &spec)
+{
+    if (spec.empty())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < spec.size(); i++)
+    {
+        if (!isdigit((unsigned char)spec[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//--------------------- CameraFrameSource ---------------------//
+
+CameraFrameSource::CameraFrameSource(int deviceId) : cap(deviceId), deviceId(deviceId)
+{
+}
+
+bool CameraFrameSource::read(Mat &frame)
+{
+    cap >> frame;
+    return !frame.empty();
+}
+
+bool CameraFrameSource::isOpened() const
+{
+    return cap.isOpened();
+}
+
+bool CameraFrameSource::isLive() const
+{
+    return true;
+}
+
+string CameraFrameSource::describe() const
+{
+    return "camera " + to_string(deviceId);
+}
+
+//--------------------- VideoFileFrameSource ---------------------//
+
+VideoFileFrameSource::VideoFileFrameSource(const string &path) : cap(path), path(path)
+{
+}
+
+bool VideoFileFrameSource::read(Mat &frame)
+{
+    cap >> frame;
+    return !frame.empty();
+}
+
+bool VideoFileFrameSource::isOpened() const
+{
+    return cap.isOpened();
+}
+
+string VideoFileFrameSource::describe() const
+{
+    return "video file " + path;
+}
+
+//--------------------- ImageDirectoryFrameSource ---------------------//
+
+ImageDirectoryFrameSource::ImageDirectoryFrameSource(const string &directory) : directory(directory), nextIndex(0)
+{
+    vector<String> allFiles;
+    glob(directory, allFiles, false);
+    for (size_t i = 0; i < allFiles.size(); i++)
+    {
+        if (isImageFile(allFiles[i]))
+        {
+            imageFiles.push_back(allFiles[i]);
+        }
+    }
+}
+
+bool ImageDirectoryFrameSource::read(Mat &frame)
+{
+    while (nextIndex < imageFiles.size())
+    {
+        frame = imread(imageFiles[nextIndex++], IMREAD_COLOR);
+        if (!frame.empty())
+        {
+            return true;
+        }
+        LOG_WARN("Could not decode " << imageFiles[nextIndex - 1]);
+    }
+    return false;
+}
+
+bool ImageDirectoryFrameSource::isOpened() const
+{
+    return !imageFiles.empty();
+}
+
+string ImageDirectoryFrameSource::describe() const
+{
+    return "image directory " + directory + " (" + to_string(imageFiles.size()) + " images)";
+}
+
+//--------------------- MemoryFrameSource ---------------------//
+
+MemoryFrameSource::MemoryFrameSource(const vector<Mat> &frames) : frames(frames), nextIndex(0)
+{
+}
+
+MemoryFrameSource::MemoryFrameSource(const unsigned char *data, int width, int height, int type, size_t step,
+                                     int frameCount)
+    : nextIndex(0)
+{
+    // Wraps the caller's buffer without copying, the buffer must outlive the source
+    size_t frameBytes = step * height;
+    for (int i = 0; i < frameCount; i++)
+    {
+        frames.push_back(Mat(height, width, type, (void *)(data + i * frameBytes), step));
+    }
+}
+
+bool MemoryFrameSource::read(Mat &frame)
+{
+    if (nextIndex >= frames.size())
+    {
+        return false;
+    }
+    // Hand out a copy so the loops can draw on the frame without corrupting the next replay
+    frames[nextIndex++].copyTo(frame);
+    return true;
+}
+
+bool MemoryFrameSource::isOpened() const
+{
+    return !frames.empty();
+}
+
+string MemoryFrameSource::describe() const
+{
+    return "memory (" + to_string(frames.size()) + " frames)";
+}
+
+//--------------------- Factory ---------------------//
+
+/**
+ * @brief Opens the frame source described by spec
+ *
+ * @param spec "" or digits for a camera, "mem:<dir>" to preload a directory, a directory of images, or a video file
+ */
+Ptr<FrameSource> openFrameSource(const string &spec)
+{
+    if (spec.empty())
+    {
+        return makePtr<CameraFrameSource>(0);
+    }
+    if (isDeviceIndex(spec))
+    {
+        return makePtr<CameraFrameSource>(stoi(spec));
+    }
+    if (spec.compare(0, 4, "mem:") == 0)
+    {
+        ImageDirectoryFrameSource directorySource(spec.substr(4));
+        vector<Mat> frames;
+        Mat frame;
+        while (directorySource.read(frame))
+        {
+            frames.push_back(frame.clone());
+        }
+        LOG_INFO("Preloaded " << frames.size() << " frames into memory");
+        return makePtr<MemoryFrameSource>(frames);
+    }
+    if (utils::fs::isDirectory(spec))
+    {
+        return makePtr<ImageDirectoryFrameSource>(spec);
+    }
+    return makePtr<VideoFileFrameSource>(spec);
+}
+
+//--------------------- FrameRateCounter ---------------------//
+
+FrameRateCounter::FrameRateCounter() : startTime(chrono::steady_clock::now()), frameCount(0)
+{
+}
+
+void FrameRateCounter::start()
+{
+    startTime = chrono::steady_clock::now();
+    frameCount = 0;
+}
+
+void FrameRateCounter::tick()
+{
+    frameCount++;
+}
+
+int FrameRateCounter::frames() const
+{
+    return frameCount;
+}
+
+double FrameRateCounter::elapsedSeconds() const
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+}
+
+double FrameRateCounter::fps() const
+{
+    double elapsed = elapsedSeconds();
+    return elapsed > 0 ? frameCount / elapsed : 0.0;
+}
+
+void FrameRateCounter::report(const string &label) const
+{
+    LOG_INFO(label << ": " << frameCount << " frames in " << elapsedSeconds() << " s (" << fps() << " fps)");
+}
+
+//--------------------- Stream helpers ---------------------//
+
+char presentFrame(const string &windowName, const Mat &image, const StreamOptions &options, int delay)
+{
+    if (options.headless)
+    {
+        return -1;
+    }
+    imshow(windowName, image);
+    return (char)waitKey(delay);
+}
+
+bool frameLimitReached(const FrameRateCounter &counter, const StreamOptions &options)
+{
+    return options.maxFrames > 0 && counter.frames() >= options.maxFrames;
+}
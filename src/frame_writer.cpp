@@ -0,0 +1,308 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Background writer for saved frames and recorded video, so encoding and disk I/O stay off the frame loop
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#include "frame_writer.h"
+#include "logger.h"
+
+using namespace std;
+using namespace cv;
+
+void FrameWriterStats::report() const
+{
+    if (imagesQueued + imagesDropped > 0)
+    {
+        ostringstream line;
+        line << "Frame writer: " << imagesWritten << " of " << imagesQueued << " images written";
+        if (imagesWritten > 0)
+        {
+            line << ", " << encodeMs / imagesWritten << " ms to encode and write";
+        }
+        line << ", " << imagesDropped << " dropped (queue full), " << imagesFailed << " failed";
+        LOG_INFO(line.str());
+    }
+    if (framesRecorded + framesDropped > 0)
+    {
+        ostringstream line;
+        line << "Recording: " << framesRecorded << " frames";
+        if (framesRecorded > 0)
+        {
+            line << ", " << recordMs / framesRecorded << " ms per frame";
+        }
+        line << ", " << framesDropped << " dropped";
+        LOG_INFO(line.str());
+    }
+}
+
+/**
+ * @brief Lower-cased extension of a file name, "" if it has none
+ */
+static string fileExtension(const string &filename)
+{
+    size_t dot = filename.find_last_of('.');
+    if (dot == string::npos || filename.find_first_of("/\\", dot) != string::npos)
+    {
+        return "";
+    }
+    string extension = filename.substr(dot + 1);
+    transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension;
+}
+
+FrameWriter::FrameWriter(int encoders, int queueCapacity)
+    : encoderCount(max(1, encoders)), queueCapacity((size_t)max(1, queueCapacity)), rawImages(false), stopping(false),
+      stopRecorder(false)
+{
+}
+
+FrameWriter::~FrameWriter()
+{
+    flush();
+}
+
+void FrameWriter::setPngCompression(int level)
+{
+    lock_guard<mutex> guard(lock);
+    imageParams.clear();
+    if (level >= 0)
+    {
+        imageParams.push_back(IMWRITE_PNG_COMPRESSION);
+        imageParams.push_back(min(level, 9));
+    }
+}
+
+void FrameWriter::setRawImages(bool raw)
+{
+    lock_guard<mutex> guard(lock);
+    rawImages = raw;
+}
+
+string FrameWriter::saveImage(const string &filename, const Mat &image)
+{
+    ImageJob job;
+    job.filename = filename;
+    {
+        lock_guard<mutex> guard(lock);
+        if (rawImages)
+        {
+            string extension = fileExtension(filename);
+            size_t stem = filename.size() - (extension.empty() ? 0 : extension.size() + 1);
+            job.filename = filename.substr(0, stem) + ".ppm";
+        }
+        if (images.size() >= queueCapacity)
+        {
+            writerStats.imagesDropped++;
+            LOG_WARN("Warning: frame writer queue full, " << job.filename << " dropped");
+            return "";
+        }
+    }
+
+    // Copy outside the lock; the caller keeps drawing into its frame
+    job.image = image.clone();
+
+    lock_guard<mutex> guard(lock);
+    if (encoders.empty())
+    {
+        stopping = false;
+        for (int i = 0; i < encoderCount; i++)
+        {
+            encoders.push_back(thread(&FrameWriter::encoderLoop, this));
+        }
+    }
+    writerStats.imagesQueued++;
+    string written = job.filename;
+    images.push_back(job);
+    workReady.notify_all();
+    return written;
+}
+
+void FrameWriter::startRecording(const string &filename, double fps)
+{
+    stopRecording();
+    lock_guard<mutex> guard(lock);
+    recordFile = filename;
+    stopRecorder = false;
+    recorder = thread(&FrameWriter::recorderLoop, this, filename, fps > 0 ? fps : 30.0);
+    LOG_INFO("Recording to " << filename);
+}
+
+bool FrameWriter::record(const Mat &frame)
+{
+    if (!recording() || frame.empty())
+    {
+        return true;
+    }
+    {
+        lock_guard<mutex> guard(lock);
+        if (frames.size() >= queueCapacity)
+        {
+            writerStats.framesDropped++;
+            return false;
+        }
+    }
+    Mat copy = frame.clone();
+    lock_guard<mutex> guard(lock);
+    frames.push_back(copy);
+    workReady.notify_all();
+    return true;
+}
+
+void FrameWriter::stopRecording()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        if (!recorder.joinable())
+        {
+            return;
+        }
+        stopRecorder = true;
+        workReady.notify_all();
+    }
+    recorder.join();
+    lock_guard<mutex> guard(lock);
+    recordFile.clear();
+}
+
+void FrameWriter::flush()
+{
+    vector<thread> running;
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+        workReady.notify_all();
+        running.swap(encoders);
+    }
+    for (size_t i = 0; i < running.size(); i++)
+    {
+        running[i].join();
+    }
+    stopRecording();
+}
+
+FrameWriterStats FrameWriter::stats()
+{
+    lock_guard<mutex> guard(lock);
+    return writerStats;
+}
+
+void FrameWriter::encoderLoop()
+{
+    while (true)
+    {
+        ImageJob job;
+        vector<int> params;
+        {
+            unique_lock<mutex> guard(lock);
+            workReady.wait(guard, [this] { return !images.empty() || stopping; });
+            // Drain the queue before stopping
+            if (images.empty())
+            {
+                return;
+            }
+            job = images.front();
+            images.pop_front();
+            params = imageParams;
+        }
+
+        if (fileExtension(job.filename) == "ppm")
+        {
+            params.clear();
+            params.push_back(IMWRITE_PXM_BINARY);
+            params.push_back(1);
+        }
+        int64 start = getTickCount();
+        bool written = false;
+        try
+        {
+            written = imwrite(job.filename, job.image, params);
+        }
+        catch (const Exception &e)
+        {
+            LOG_ERROR("Error writing " << job.filename << ": " << e.what());
+        }
+        double elapsedMs = (getTickCount() - start) * 1000.0 / getTickFrequency();
+        if (!written)
+        {
+            LOG_ERROR("Error: could not write " << job.filename);
+        }
+
+        lock_guard<mutex> guard(lock);
+        if (written)
+        {
+            writerStats.imagesWritten++;
+            writerStats.encodeMs += elapsedMs;
+        }
+        else
+        {
+            writerStats.imagesFailed++;
+        }
+    }
+}
+
+void FrameWriter::recorderLoop(string filename, double fps)
+{
+    VideoWriter video;
+    bool openFailed = false;
+    Size frameSize;
+    string extension = fileExtension(filename);
+    int fourcc = (extension == "mp4" || extension == "mov") ? VideoWriter::fourcc('m', 'p', '4', 'v')
+                                                            : VideoWriter::fourcc('M', 'J', 'P', 'G');
+    while (true)
+    {
+        Mat frame;
+        {
+            unique_lock<mutex> guard(lock);
+            workReady.wait(guard, [this] { return !frames.empty() || stopRecorder; });
+            if (frames.empty())
+            {
+                break;
+            }
+            frame = frames.front();
+            frames.pop_front();
+        }
+
+        if (!video.isOpened() && !openFailed)
+        {
+            frameSize = frame.size();
+            openFailed = !video.open(filename, fourcc, fps, frameSize, frame.channels() == 3);
+            if (openFailed)
+            {
+                LOG_ERROR("Error: could not open " << filename << " for recording");
+            }
+        }
+        if (openFailed)
+        {
+            lock_guard<mutex> guard(lock);
+            writerStats.framesDropped++;
+            continue;
+        }
+
+        int64 start = getTickCount();
+        if (frame.size() != frameSize)
+        {
+            resize(frame, frame, frameSize);
+        }
+        video.write(frame);
+        double elapsedMs = (getTickCount() - start) * 1000.0 / getTickFrequency();
+
+        lock_guard<mutex> guard(lock);
+        writerStats.framesRecorded++;
+        writerStats.recordMs += elapsedMs;
+    }
+    video.release();
+}
+
+void configureFrameWriter(FrameWriter &writer, const StreamOptions &options)
+{
+    writer.setPngCompression(options.pngCompression);
+    writer.setRawImages(options.rawImages);
+    if (!options.recordFile.empty())
+    {
+        writer.startRecording(options.recordFile, options.recordFps);
+    }
+}
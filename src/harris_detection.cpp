@@ -2,108 +2,418 @@
 // Date: March 18, 2024
 // Purpose: A collection of utils used for Harris Corner Detection
 
+#include <algorithm>
+#include <cmath>
 #include <opencv2/aruco.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "frame_context.h"
+#include "frame_source.h"
+#include "frame_writer.h"
 #include "harris_detection.h"
+#include "harris_kernel.h"
+#include "harris_keypoints.h"
+#include "logger.h"
+#include "stage_timer.h"
 
 using namespace std;
 using namespace cv;
 
-// ----------------- Global Variables ----------------- //
-Mat src, grayImage;
-const char *source_window = "Original image";
-const char *corners_window = "Harris Corner Detection";
-// ---------------------------------------------------- //
+static const char *source_window = "Original image";
+static const char *corners_window = "Harris Corner Detection";
+
+// A corner is kept when its response is above this fraction of the same frame's strongest response. This replaces the
+// original rule (min-max normalize the response to 0..255, keep pixels above 225), which depended on the weakest
+// response as well; the cut is now 0.1 x max instead of roughly 0.88 x max + 0.12 x min.
+static const float harrisQualityLevel = 0.1f;
+
+/**
+ * @brief Harris corners through cv::cornerHarris, for aperture sizes the fused kernel does not cover
+ *
+ * @param gray 8-bit grayscale image
+ * @param blockSize neighborhood size
+ * @param apertureSize Sobel aperture
+ * @param k Harris free parameter
+ * @param corners corners above harrisQualityLevel times the strongest response
+ */
+static void harrisCornersOpenCV(const Mat &gray, int blockSize, int apertureSize, double k,
+                                vector<HarrisCorner> &corners)
+{
+    Mat response;
+    cornerHarris(gray, response, blockSize, apertureSize, k);
+    double maxResponse = 0;
+    minMaxLoc(response, 0, &maxResponse);
+
+    corners.clear();
+    float threshold = harrisQualityLevel * (float)maxResponse;
+    for (int i = 0; maxResponse > 0 && i < response.rows; i++)
+    {
+        const float *row = response.ptr<float>(i);
+        for (int j = 0; j < response.cols; j++)
+        {
+            if (row[j] > threshold)
+            {
+                HarrisCorner corner = {j, i, row[j]};
+                corners.push_back(corner);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Detection state of one -hc stream: the extractor and the current frame's corners, so startVideoStream owns
+ * them for the length of the stream and nothing is shared with another one
+ */
+class HarrisVideoSession
+{
+  public:
+    HarrisVideoSession(int blockSize, int apertureSize, double k);
+
+    Mat harrisCornerDetection(FrameContext &context);
+
+  private:
+    int blockSize;
+    int apertureSize;
+    double k;
+    vector<HarrisCorner> harrisCorners;
+    vector<KeyPoint> harrisKeypoints;
+    HarrisKeypointExtractor harrisExtractor;
+};
+
+/**
+ * @brief Sets the Harris parameters used for every frame of the stream
+ *
+ * @param blockSize neighborhood size
+ * @param apertureSize Sobel aperture
+ * @param k Harris free parameter
+ */
+HarrisVideoSession::HarrisVideoSession(int blockSize, int apertureSize, double k)
+    : blockSize(blockSize), apertureSize(apertureSize), k(k)
+{
+}
 
 /**
  * @brief This function is used to detect corners in an image using the Harris Corner Detection algorithm
  *
- * @param inputImage
- * @param blockSize
- * @param apertureSize
- * @param k
+ * With a 3x3 aperture the frame goes through the tiled keypoint extractor, so the output is at most a few of the
+ * strongest local maxima per tile instead of every pixel above a global threshold. Both paths threshold at
+ * harrisQualityLevel times this frame's strongest response, found before any corner is kept, so nothing depends on
+ * the previous frame.
+ *
+ * @param context current frame; its gray image is computed here if nobody asked for it yet
  *
  */
-Mat harrisCornerDetection(Mat &inputImage, int blockSize, int apertureSize, double k)
+Mat HarrisVideoSession::harrisCornerDetection(FrameContext &context)
 {
-    Mat dst, dst_norm, dst_norm_scaled, outputImage;
-    // int threshold = 200;
-    int maxThreshold = 255;
-    cvtColor(inputImage, grayImage, COLOR_BGR2GRAY);
-    dst = Mat::zeros(grayImage.size(), CV_32FC1);
-    cornerHarris(grayImage, dst, blockSize, apertureSize, k);
-    cornerSubPix(grayImage, dst, Size(5, 5), Size(-1, -1),
-                 TermCriteria(TermCriteria::EPS + TermCriteria::COUNT, 30, 0.01));
+    Mat outputImage;
+    const Mat &grayImage = context.gray();
+
+    ScopedStageTimer detectTimer(STAGE_DETECT);
+    harrisKeypoints.clear();
+    if (apertureSize == 3)
+    {
+        HarrisKeypointParams params = harrisExtractor.parameters();
+        if (params.blockSize != blockSize || params.k != (float)k || params.qualityLevel != harrisQualityLevel)
+        {
+            params.blockSize = blockSize;
+            params.k = (float)k;
+            params.qualityLevel = harrisQualityLevel;
+            harrisExtractor.setParameters(params);
+        }
+        harrisExtractor.detect(grayImage, harrisKeypoints);
+    }
+    else
+    {
+        harrisCornersOpenCV(grayImage, blockSize, apertureSize, k, harrisCorners);
+        for (size_t i = 0; i < harrisCorners.size(); i++)
+        {
+            harrisKeypoints.push_back(KeyPoint((float)harrisCorners[i].x, (float)harrisCorners[i].y, (float)blockSize,
+                                               -1, harrisCorners[i].response));
+        }
+    }
+
+    detectTimer.stop();
+
+    ScopedStageTimer drawTimer(STAGE_DRAW);
+    outputImage = context.image().clone();
+    for (size_t i = 0; i < harrisKeypoints.size(); i++)
+    {
+        circle(outputImage, harrisKeypoints[i].pt, 5, Scalar(0, 0, 255), 2);
+    }
+
+    return outputImage;
+}
+
+/**
+ * @brief The original four-pass path (cornerHarris, normalize, convertScaleAbs, per-pixel threshold), kept as the
+ * baseline for benchmarkHarrisKernel
+ *
+ * @return number of pixels above the normalized threshold
+ */
+static int harrisCornersFourPass(const Mat &gray, int blockSize, int apertureSize, double k)
+{
+    Mat dst, dst_norm, dst_norm_scaled;
+    dst = Mat::zeros(gray.size(), CV_32FC1);
+    cornerHarris(gray, dst, blockSize, apertureSize, k);
     normalize(dst, dst_norm, 0, 255, NORM_MINMAX, CV_32FC1, Mat());
     convertScaleAbs(dst_norm, dst_norm_scaled);
-    outputImage = inputImage.clone();
     int threshold = 225;
-
+    int count = 0;
     for (int i = 0; i < dst_norm.rows; i++)
     {
         for (int j = 0; j < dst.cols; j++)
         {
             if ((int)dst_norm.at<float>(i, j) > threshold)
             {
-                circle(outputImage, Point(j, i), 5, Scalar(0, 0, 255), 2);
+                count++;
             }
         }
     }
+    return count;
+}
 
-    return outputImage;
+/**
+ * @brief Checks the fused kernel against cv::cornerHarris and times it against the four-pass path
+ *
+ * For every image the fused response map is compared with cornerHarris (largest difference relative to the
+ * strongest response) and the corner sets at the default quality level are compared pixel by pixel. Each instruction
+ * set the machine supports is then timed.
+ *
+ * @param directory folder of images
+ * @param repeats timed runs per image and path
+ * @return 0 when every image matched, 1 when a mismatch was found, -1 when no image was found
+ */
+int benchmarkHarrisKernel(string directory, int repeats)
+{
+    ImageDirectoryFrameSource source(directory);
+    if (!source.isOpened())
+    {
+        LOG_WARN("No images found in " << directory);
+        return -1;
+    }
+
+    const int blockSize = 2;
+    const double k = 0.04;
+    const HarrisKernelIsa isas[] = {HARRIS_ISA_SCALAR, HARRIS_ISA_SSE2, HARRIS_ISA_AVX2};
+    const int isaCount = 3;
+    // Float sums in a different order than OpenCV's box filter; anything above this is a real bug
+    const double maxRelativeError = 1e-4;
+
+    LOG_INFO("Benchmarking Harris corners on " << source.describe() << ", " << repeats << " repeats");
+    LOG_INFO("Fused kernel instruction set: " << harrisKernelIsaName());
+    ostringstream header;
+    header << "image\tsize\trel_err\tcorners\tmismatched\tfour_pass_ms";
+    for (int i = 0; i < isaCount; i++)
+    {
+        header << "\t" << harrisKernelIsaName(isas[i]) << "_ms";
+    }
+    header << "\ttiled_1t_ms\ttiled_ms\tkeypoints";
+    LOG_INFO(header.str());
+
+    double totalFourPassMs = 0;
+    double totalIsaMs[isaCount] = {0, 0, 0};
+    double totalTiledSerialMs = 0, totalTiledMs = 0;
+    HarrisKeypointExtractor extractor;
+    vector<KeyPoint> keypoints;
+    const int threads = getNumThreads();
+    double worstError = 0;
+    bool allMatched = true;
+    int images = 0;
+    size_t index = 0;
+    Mat image, gray, expected;
+    while (source.read(image))
+    {
+        string name = source.files()[index++];
+        cvtColor(image, gray, COLOR_BGR2GRAY);
+
+        // Correctness: full response map and corner set against cornerHarris
+        cornerHarris(gray, expected, blockSize, 3, k);
+        double expectedMax = 0;
+        minMaxLoc(expected, 0, &expectedMax);
+
+        Mat response(gray.size(), CV_32FC1);
+        HarrisKernelParams params;
+        params.blockSize = blockSize;
+        params.k = (float)k;
+        params.threshold = harrisQualityLevel * (float)expectedMax;
+        vector<HarrisCorner> corners;
+        harrisCornersRegion(gray.data, gray.cols, gray.rows, gray.step, 0, 0, gray.cols, gray.rows, params, corners, 0,
+                            response.ptr<float>(), response.step / sizeof(float));
+
+        double relativeError = norm(response, expected, NORM_INF) / max(expectedMax, 1e-12);
+        int mismatched = 0;
+        size_t next = 0;
+        for (int i = 0; i < expected.rows; i++)
+        {
+            const float *row = expected.ptr<float>(i);
+            for (int j = 0; j < expected.cols; j++)
+            {
+                bool inExpected = row[j] > params.threshold;
+                bool inFused = next < corners.size() && corners[next].y == i && corners[next].x == j;
+                if (inFused)
+                {
+                    next++;
+                }
+                if (inExpected != inFused)
+                {
+                    // Pixels sitting right on the threshold may legitimately fall either way
+                    if (fabs(row[j] - params.threshold) > maxRelativeError * expectedMax)
+                    {
+                        mismatched++;
+                    }
+                }
+            }
+        }
+        size_t fusedCorners = corners.size();
+        bool matched = relativeError <= maxRelativeError && mismatched == 0;
+        allMatched = allMatched && matched;
+        worstError = max(worstError, relativeError);
+
+        // Throughput
+        double fourPassMs = 0;
+        double isaMs[isaCount] = {0, 0, 0};
+        for (int r = 0; r < repeats; r++)
+        {
+            int64 start = getTickCount();
+            harrisCornersFourPass(gray, blockSize, 3, k);
+            fourPassMs += (getTickCount() - start) * 1000.0 / getTickFrequency();
+
+            for (int i = 0; i < isaCount; i++)
+            {
+                params.isa = isas[i];
+                start = getTickCount();
+                harrisCornersFused(gray.data, gray.cols, gray.rows, gray.step, params, corners);
+                isaMs[i] += (getTickCount() - start) * 1000.0 / getTickFrequency();
+                corners.clear();
+            }
+        }
+
+        // Tiled keypoints on one thread and on every core
+        double tiledSerialMs = 0, tiledMs = 0;
+        for (int r = 0; r < repeats; r++)
+        {
+            setNumThreads(1);
+            int64 start = getTickCount();
+            extractor.detect(gray, keypoints);
+            tiledSerialMs += (getTickCount() - start) * 1000.0 / getTickFrequency();
+
+            setNumThreads(threads);
+            start = getTickCount();
+            extractor.detect(gray, keypoints);
+            tiledMs += (getTickCount() - start) * 1000.0 / getTickFrequency();
+        }
+
+        ostringstream row;
+        row << name << "\t" << gray.cols << "x" << gray.rows << "\t" << relativeError << "\t" << fusedCorners << "\t"
+            << mismatched << "\t" << fourPassMs / repeats;
+        totalFourPassMs += fourPassMs / repeats;
+        for (int i = 0; i < isaCount; i++)
+        {
+            row << "\t" << isaMs[i] / repeats;
+            totalIsaMs[i] += isaMs[i] / repeats;
+        }
+        row << "\t" << tiledSerialMs / repeats << "\t" << tiledMs / repeats << "\t" << keypoints.size();
+        totalTiledSerialMs += tiledSerialMs / repeats;
+        totalTiledMs += tiledMs / repeats;
+        row << (matched ? "" : "\tMISMATCH");
+        LOG_INFO(row.str());
+        images++;
+    }
+
+    LOG_INFO("\nImages: " << images << ", largest relative response error: " << worstError);
+    ostringstream means;
+    means << "Mean time: four-pass " << totalFourPassMs / images << " ms";
+    for (int i = 0; i < isaCount; i++)
+    {
+        means << ", " << harrisKernelIsaName(isas[i]) << " " << totalIsaMs[i] / images << " ms ("
+              << totalFourPassMs / totalIsaMs[i] << "x)";
+    }
+    LOG_INFO(means.str());
+    LOG_INFO("Tiled keypoints: " << totalTiledSerialMs / images << " ms on 1 thread, " << totalTiledMs / images
+             << " ms on " << threads << " threads");
+    LOG_INFO((allMatched ? "Fused kernel matches cornerHarris" : "Fused kernel does NOT match cornerHarris"));
+    return allMatched ? 0 : 1;
 }
 
+
 /**
  * @brief This function is used to start the video stream and apply the Harris Corner Detection algorithm
  *
  * @param calibrationFileName
+ * @param options Frame source and headless settings
  */
-int startVideoStream(string calibrationFileName)
+int startVideoStream(string calibrationFileName, const StreamOptions &options)
 {
-    VideoCapture cap(0);
-    if (!cap.isOpened())
+    Ptr<FrameSource> source = openFrameSource(options.source);
+    if (!source->isOpened())
     {
-        cerr << "Error opening video stream or file" << endl;
+        LOG_ERROR("Error opening video stream or file: " << source->describe());
         return -1;
     }
-    int blockSize = 2;
-    int apertureSize = 3;
-    double k = 0.04;
+    HarrisVideoSession session(2, 3, 0.04);
 
-    namedWindow(source_window, WINDOW_AUTOSIZE);
-    namedWindow(corners_window, WINDOW_AUTOSIZE);
+    if (!options.headless)
+    {
+        namedWindow(source_window, WINDOW_AUTOSIZE);
+        namedWindow(corners_window, WINDOW_AUTOSIZE);
+    }
+    LOG_INFO("Reading frames from " << source->describe());
 
+    FrameWriter writer;
+    configureFrameWriter(writer, options);
     Mat frame, harrisFrame;
-    while (true)
+    FrameContext harrisFrameContext;
+    FrameRateCounter frameRate;
+    while (!frameLimitReached(frameRate, options))
     {
-        cap >> frame;
-        if (frame.empty())
+        ScopedStageTimer frameTimer(STAGE_FRAME);
+        ScopedStageTimer captureTimer(STAGE_CAPTURE);
+        if (!source->read(frame))
         {
-            cerr << "Error: frame is empty" << endl;
+            if (source->isLive())
+            {
+                LOG_ERROR("Error: frame is empty");
+            }
             break;
         }
+        captureTimer.stop();
 
-        harrisFrame = harrisCornerDetection(frame, blockSize, apertureSize, k);
-
-        cvtColor(frame, grayImage, COLOR_BGR2GRAY);
+        harrisFrameContext.reset(frame);
+        harrisFrame = session.harrisCornerDetection(harrisFrameContext);
 
-        imshow(source_window, frame);
-        imshow(corners_window, harrisFrame);
+        ScopedStageTimer writeTimer(STAGE_WRITE);
+        writer.record(harrisFrame);
+        writeTimer.stop();
 
-        char key = (char)waitKey(10);
+        frameRate.tick();
+        ScopedStageTimer displayTimer(STAGE_DISPLAY);
+        if (!options.headless)
+        {
+            imshow(source_window, frame);
+        }
+        char key = presentFrame(corners_window, harrisFrame, options);
+        displayTimer.stop();
         if (key == 'q' || key == 'Q')
         {
-            cout << "User terminated program" << endl;
+            LOG_INFO("User terminated program");
             break;
         }
         if (key == 's' || key == 'S')
         {
-            imwrite("harris_corner_detection.jpg", harrisFrame);
-            cout << "Image saved as 'harris_corner_detection.jpg'" << endl;
+            string filename = writer.saveImage("harris_corner_detection.jpg", harrisFrame);
+            if (!filename.empty())
+            {
+                LOG_INFO("Image queued as '" << filename << "'");
+            }
         }
     }
-    cap.release();
-    destroyAllWindows();
+    frameRate.report("Harris corner detection");
+    writer.flush();
+    writer.stats().report();
+    finishStageTimes("Harris corner detection", options.statsFile);
+    if (!options.headless)
+    {
+        destroyAllWindows();
+    }
     return 0;
 }
\ No newline at end of file
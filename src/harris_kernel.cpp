@@ -0,0 +1,489 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Fused single-pass Harris response + threshold kernel (AVX2 / SSE2 / scalar, picked at runtime)
+
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+#include "harris_kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HARRIS_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+typedef unsigned char uchar;
+
+/**
+ * @brief Row functions for one instruction set
+ *
+ * products    - Sobel dx/dy of n contiguous interior pixels and their structure tensor products (dx*dx, dx*dy,
+ *               dy*dy). prev/cur/next point at the first pixel; columns -1 .. n are read.
+ * boxRow      - out[j] = in[j] + ... + in[j + blockSize - 1] for n outputs
+ * responseRow - sums the blockSize tensor rows, computes the response and appends the pixels above the threshold;
+ *               returns the largest response of the row
+ */
+struct HarrisRowKernels
+{
+    void (*products)(const uchar *prev, const uchar *cur, const uchar *next, int n, float scale, float *a, float *b,
+                     float *c);
+    void (*boxRow)(const float *in, int n, int blockSize, float *out);
+    float (*responseRow)(const float *const *rowsA, const float *const *rowsB, const float *const *rowsC,
+                         int blockSize, int n, float k, float threshold, int x0, int y, vector<HarrisCorner> &corners,
+                         float *response);
+    const char *name;
+};
+
+/**
+ * @brief Index of p in a line of len pixels under BORDER_REFLECT_101 (gfedcb|abcdefgh|gfedcba)
+ */
+static inline int reflect101(int p, int len)
+{
+    if (len == 1)
+    {
+        return 0;
+    }
+    while (p < 0 || p >= len)
+    {
+        p = p < 0 ? -p : 2 * len - 2 - p;
+    }
+    return p;
+}
+
+//--------------------- Scalar ---------------------//
+
+/**
+ * @brief Structure tensor products of one pixel whose neighbours are at columns left/centre/right
+ */
+static inline void productsAt(const uchar *prev, const uchar *cur, const uchar *next, int left, int centre, int right,
+                              float scale, float &a, float &b, float &c)
+{
+    int dx = (prev[right] - prev[left]) + 2 * (cur[right] - cur[left]) + (next[right] - next[left]);
+    int dy = (next[left] + 2 * next[centre] + next[right]) - (prev[left] + 2 * prev[centre] + prev[right]);
+    float fx = dx * scale;
+    float fy = dy * scale;
+    a = fx * fx;
+    b = fx * fy;
+    c = fy * fy;
+}
+
+static void productsScalar(const uchar *prev, const uchar *cur, const uchar *next, int n, float scale, float *a,
+                           float *b, float *c)
+{
+    for (int i = 0; i < n; i++)
+    {
+        productsAt(prev, cur, next, i - 1, i, i + 1, scale, a[i], b[i], c[i]);
+    }
+}
+
+static void boxRowScalar(const float *in, int n, int blockSize, float *out)
+{
+    for (int j = 0; j < n; j++)
+    {
+        float sum = in[j];
+        for (int t = 1; t < blockSize; t++)
+        {
+            sum += in[j + t];
+        }
+        out[j] = sum;
+    }
+}
+
+static float responseRowScalar(const float *const *rowsA, const float *const *rowsB, const float *const *rowsC,
+                               int blockSize, int n, float k, float threshold, int x0, int y,
+                               vector<HarrisCorner> &corners, float *response)
+{
+    float rowMax = -FLT_MAX;
+    for (int j = 0; j < n; j++)
+    {
+        float a = rowsA[0][j], b = rowsB[0][j], c = rowsC[0][j];
+        for (int r = 1; r < blockSize; r++)
+        {
+            a += rowsA[r][j];
+            b += rowsB[r][j];
+            c += rowsC[r][j];
+        }
+        float trace = a + c;
+        float value = a * c - b * b - k * (trace * trace);
+        if (response)
+        {
+            response[j] = value;
+        }
+        rowMax = max(rowMax, value);
+        if (value > threshold)
+        {
+            HarrisCorner corner = {x0 + j, y, value};
+            corners.push_back(corner);
+        }
+    }
+    return rowMax;
+}
+
+static const HarrisRowKernels scalarKernels = {productsScalar, boxRowScalar, responseRowScalar, "scalar"};
+
+#ifdef HARRIS_KERNEL_X86
+
+//--------------------- SSE2 ---------------------//
+
+static void productsSse2(const uchar *prev, const uchar *cur, const uchar *next, int n, float scale, float *a,
+                         float *b, float *c)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 vscale = _mm_set1_ps(scale);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i pl = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(prev + i - 1)), zero);
+        __m128i pc = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(prev + i)), zero);
+        __m128i pr = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(prev + i + 1)), zero);
+        __m128i cl = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(cur + i - 1)), zero);
+        __m128i cr = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(cur + i + 1)), zero);
+        __m128i nl = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(next + i - 1)), zero);
+        __m128i nc = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(next + i)), zero);
+        __m128i nr = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(next + i + 1)), zero);
+
+        // 16-bit is enough: |dx|, |dy| <= 4 * 255
+        __m128i dx = _mm_add_epi16(_mm_add_epi16(_mm_sub_epi16(pr, pl), _mm_sub_epi16(nr, nl)),
+                                   _mm_slli_epi16(_mm_sub_epi16(cr, cl), 1));
+        __m128i dy = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(nl, nr), _mm_slli_epi16(nc, 1)),
+                                   _mm_add_epi16(_mm_add_epi16(pl, pr), _mm_slli_epi16(pc, 1)));
+
+        // Sign-extend to 32-bit and convert, four lanes at a time
+        __m128 dxLo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(dx, dx), 16)), vscale);
+        __m128 dxHi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(dx, dx), 16)), vscale);
+        __m128 dyLo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(dy, dy), 16)), vscale);
+        __m128 dyHi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(dy, dy), 16)), vscale);
+
+        _mm_storeu_ps(a + i, _mm_mul_ps(dxLo, dxLo));
+        _mm_storeu_ps(a + i + 4, _mm_mul_ps(dxHi, dxHi));
+        _mm_storeu_ps(b + i, _mm_mul_ps(dxLo, dyLo));
+        _mm_storeu_ps(b + i + 4, _mm_mul_ps(dxHi, dyHi));
+        _mm_storeu_ps(c + i, _mm_mul_ps(dyLo, dyLo));
+        _mm_storeu_ps(c + i + 4, _mm_mul_ps(dyHi, dyHi));
+    }
+    for (; i < n; i++)
+    {
+        productsAt(prev, cur, next, i - 1, i, i + 1, scale, a[i], b[i], c[i]);
+    }
+}
+
+static void boxRowSse2(const float *in, int n, int blockSize, float *out)
+{
+    int j = 0;
+    for (; j + 4 <= n; j += 4)
+    {
+        __m128 sum = _mm_loadu_ps(in + j);
+        for (int t = 1; t < blockSize; t++)
+        {
+            sum = _mm_add_ps(sum, _mm_loadu_ps(in + j + t));
+        }
+        _mm_storeu_ps(out + j, sum);
+    }
+    boxRowScalar(in + j, n - j, blockSize, out + j);
+}
+
+static float responseRowSse2(const float *const *rowsA, const float *const *rowsB, const float *const *rowsC,
+                             int blockSize, int n, float k, float threshold, int x0, int y,
+                             vector<HarrisCorner> &corners, float *response)
+{
+    const __m128 vk = _mm_set1_ps(k);
+    const __m128 vthreshold = _mm_set1_ps(threshold);
+    __m128 vmax = _mm_set1_ps(-FLT_MAX);
+    float values[4];
+    int j = 0;
+    for (; j + 4 <= n; j += 4)
+    {
+        __m128 a = _mm_loadu_ps(rowsA[0] + j);
+        __m128 b = _mm_loadu_ps(rowsB[0] + j);
+        __m128 c = _mm_loadu_ps(rowsC[0] + j);
+        for (int r = 1; r < blockSize; r++)
+        {
+            a = _mm_add_ps(a, _mm_loadu_ps(rowsA[r] + j));
+            b = _mm_add_ps(b, _mm_loadu_ps(rowsB[r] + j));
+            c = _mm_add_ps(c, _mm_loadu_ps(rowsC[r] + j));
+        }
+        __m128 trace = _mm_add_ps(a, c);
+        __m128 value = _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(a, c), _mm_mul_ps(b, b)), _mm_mul_ps(vk, _mm_mul_ps(trace, trace)));
+        if (response)
+        {
+            _mm_storeu_ps(response + j, value);
+        }
+        vmax = _mm_max_ps(vmax, value);
+
+        int mask = _mm_movemask_ps(_mm_cmpgt_ps(value, vthreshold));
+        if (mask)
+        {
+            _mm_storeu_ps(values, value);
+            for (int lane = 0; lane < 4; lane++)
+            {
+                if (mask & (1 << lane))
+                {
+                    HarrisCorner corner = {x0 + j + lane, y, values[lane]};
+                    corners.push_back(corner);
+                }
+            }
+        }
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, vmax);
+    float rowMax = max(max(lanes[0], lanes[1]), max(lanes[2], lanes[3]));
+    if (j < n)
+    {
+        const float *tailA[16], *tailB[16], *tailC[16];
+        for (int r = 0; r < blockSize && r < 16; r++)
+        {
+            tailA[r] = rowsA[r] + j;
+            tailB[r] = rowsB[r] + j;
+            tailC[r] = rowsC[r] + j;
+        }
+        rowMax = max(rowMax, responseRowScalar(tailA, tailB, tailC, blockSize, n - j, k, threshold, x0 + j, y,
+                                               corners, response ? response + j : 0));
+    }
+    return rowMax;
+}
+
+static const HarrisRowKernels sse2Kernels = {productsSse2, boxRowSse2, responseRowSse2, "sse2"};
+
+//--------------------- AVX2 ---------------------//
+
+__attribute__((target("avx2"))) static void productsAvx2(const uchar *prev, const uchar *cur, const uchar *next, int n,
+                                                         float scale, float *a, float *b, float *c)
+{
+    const __m256 vscale = _mm256_set1_ps(scale);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i pl = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(prev + i - 1)));
+        __m256i pc = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(prev + i)));
+        __m256i pr = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(prev + i + 1)));
+        __m256i cl = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(cur + i - 1)));
+        __m256i cr = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(cur + i + 1)));
+        __m256i nl = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(next + i - 1)));
+        __m256i nc = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(next + i)));
+        __m256i nr = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(next + i + 1)));
+
+        __m256i dx = _mm256_add_epi32(_mm256_add_epi32(_mm256_sub_epi32(pr, pl), _mm256_sub_epi32(nr, nl)),
+                                      _mm256_slli_epi32(_mm256_sub_epi32(cr, cl), 1));
+        __m256i dy = _mm256_sub_epi32(_mm256_add_epi32(_mm256_add_epi32(nl, nr), _mm256_slli_epi32(nc, 1)),
+                                      _mm256_add_epi32(_mm256_add_epi32(pl, pr), _mm256_slli_epi32(pc, 1)));
+
+        __m256 fx = _mm256_mul_ps(_mm256_cvtepi32_ps(dx), vscale);
+        __m256 fy = _mm256_mul_ps(_mm256_cvtepi32_ps(dy), vscale);
+        _mm256_storeu_ps(a + i, _mm256_mul_ps(fx, fx));
+        _mm256_storeu_ps(b + i, _mm256_mul_ps(fx, fy));
+        _mm256_storeu_ps(c + i, _mm256_mul_ps(fy, fy));
+    }
+    for (; i < n; i++)
+    {
+        productsAt(prev, cur, next, i - 1, i, i + 1, scale, a[i], b[i], c[i]);
+    }
+}
+
+__attribute__((target("avx2"))) static void boxRowAvx2(const float *in, int n, int blockSize, float *out)
+{
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        __m256 sum = _mm256_loadu_ps(in + j);
+        for (int t = 1; t < blockSize; t++)
+        {
+            sum = _mm256_add_ps(sum, _mm256_loadu_ps(in + j + t));
+        }
+        _mm256_storeu_ps(out + j, sum);
+    }
+    boxRowScalar(in + j, n - j, blockSize, out + j);
+}
+
+__attribute__((target("avx2"))) static float responseRowAvx2(const float *const *rowsA, const float *const *rowsB,
+                                                             const float *const *rowsC, int blockSize, int n, float k,
+                                                             float threshold, int x0, int y,
+                                                             vector<HarrisCorner> &corners, float *response)
+{
+    const __m256 vk = _mm256_set1_ps(k);
+    const __m256 vthreshold = _mm256_set1_ps(threshold);
+    __m256 vmax = _mm256_set1_ps(-FLT_MAX);
+    float values[8];
+    int j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        __m256 a = _mm256_loadu_ps(rowsA[0] + j);
+        __m256 b = _mm256_loadu_ps(rowsB[0] + j);
+        __m256 c = _mm256_loadu_ps(rowsC[0] + j);
+        for (int r = 1; r < blockSize; r++)
+        {
+            a = _mm256_add_ps(a, _mm256_loadu_ps(rowsA[r] + j));
+            b = _mm256_add_ps(b, _mm256_loadu_ps(rowsB[r] + j));
+            c = _mm256_add_ps(c, _mm256_loadu_ps(rowsC[r] + j));
+        }
+        __m256 trace = _mm256_add_ps(a, c);
+        __m256 value = _mm256_sub_ps(_mm256_sub_ps(_mm256_mul_ps(a, c), _mm256_mul_ps(b, b)),
+                                     _mm256_mul_ps(vk, _mm256_mul_ps(trace, trace)));
+        if (response)
+        {
+            _mm256_storeu_ps(response + j, value);
+        }
+        vmax = _mm256_max_ps(vmax, value);
+
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(value, vthreshold, _CMP_GT_OQ));
+        if (mask)
+        {
+            _mm256_storeu_ps(values, value);
+            for (int lane = 0; lane < 8; lane++)
+            {
+                if (mask & (1 << lane))
+                {
+                    HarrisCorner corner = {x0 + j + lane, y, values[lane]};
+                    corners.push_back(corner);
+                }
+            }
+        }
+    }
+
+    float lanes[8];
+    _mm256_storeu_ps(lanes, vmax);
+    float rowMax = lanes[0];
+    for (int lane = 1; lane < 8; lane++)
+    {
+        rowMax = max(rowMax, lanes[lane]);
+    }
+    if (j < n)
+    {
+        const float *tailA[16], *tailB[16], *tailC[16];
+        for (int r = 0; r < blockSize && r < 16; r++)
+        {
+            tailA[r] = rowsA[r] + j;
+            tailB[r] = rowsB[r] + j;
+            tailC[r] = rowsC[r] + j;
+        }
+        rowMax = max(rowMax, responseRowScalar(tailA, tailB, tailC, blockSize, n - j, k, threshold, x0 + j, y,
+                                               corners, response ? response + j : 0));
+    }
+    return rowMax;
+}
+
+static const HarrisRowKernels avx2Kernels = {productsAvx2, boxRowAvx2, responseRowAvx2, "avx2"};
+
+#endif
+
+//--------------------- Dispatch ---------------------//
+
+/**
+ * @brief Picks the row functions for the requested instruction set, falling back to what the CPU supports
+ */
+static const HarrisRowKernels &selectKernels(HarrisKernelIsa isa)
+{
+#ifdef HARRIS_KERNEL_X86
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    static const bool hasSse2 = __builtin_cpu_supports("sse2");
+    if ((isa == HARRIS_ISA_AUTO || isa == HARRIS_ISA_AVX2) && hasAvx2)
+    {
+        return avx2Kernels;
+    }
+    if ((isa == HARRIS_ISA_AUTO || isa == HARRIS_ISA_AVX2 || isa == HARRIS_ISA_SSE2) && hasSse2)
+    {
+        return sse2Kernels;
+    }
+#else
+    (void)isa;
+#endif
+    return scalarKernels;
+}
+
+const char *harrisKernelIsaName(HarrisKernelIsa isa)
+{
+    return selectKernels(isa).name;
+}
+
+// Box filters larger than this are not worth streaming; the tail helpers above also assume it
+static const int maxBlockSize = 16;
+
+void harrisCornersRegion(const uchar *image, int width, int height, size_t step, int x, int y, int regionWidth,
+                         int regionHeight, const HarrisKernelParams &params, vector<HarrisCorner> &corners,
+                         float *maxResponse, float *response, size_t responseStride)
+{
+    const HarrisRowKernels &kernels = selectKernels(params.isa);
+    const int blockSize = max(1, min(params.blockSize, maxBlockSize));
+    const int anchor = blockSize / 2;
+    // Same scale cv::cornerHarris uses for 8-bit input with a 3x3 Sobel
+    const float scale = (float)(1.0 / (4.0 * blockSize * 255.0));
+
+    // Virtual columns: every column the box filter touches, before reflection
+    const int firstColumn = x - anchor;
+    const int virtualWidth = regionWidth + blockSize - 1;
+
+    vector<float> productA(virtualWidth), productB(virtualWidth), productC(virtualWidth);
+    vector<float> ring(3 * blockSize * (size_t)regionWidth);
+    const float *rowsA[maxBlockSize], *rowsB[maxBlockSize], *rowsC[maxBlockSize];
+
+    // Interior columns can use the contiguous SIMD path, the reflected border columns go one at a time
+    const int interiorBegin = max(0, min(virtualWidth, 1 - firstColumn));
+    const int interiorEnd = max(interiorBegin, min(virtualWidth, width - 1 - firstColumn));
+
+    float largest = -FLT_MAX;
+    int nextVirtualRow = y - anchor;
+    for (int row = y; row < y + regionHeight; row++)
+    {
+        // Bring every tensor row this output row needs into the ring (all of them on the first row, one afterwards)
+        int lastVirtualRow = row - anchor + blockSize - 1;
+        for (; nextVirtualRow <= lastVirtualRow; nextVirtualRow++)
+        {
+            int source = reflect101(nextVirtualRow, height);
+            const uchar *prev = image + reflect101(source - 1, height) * step;
+            const uchar *cur = image + source * step;
+            const uchar *next = image + reflect101(source + 1, height) * step;
+
+            for (int i = 0; i < interiorBegin; i++)
+            {
+                int column = reflect101(firstColumn + i, width);
+                productsAt(prev, cur, next, reflect101(column - 1, width), column, reflect101(column + 1, width),
+                           scale, productA[i], productB[i], productC[i]);
+            }
+            if (interiorEnd > interiorBegin)
+            {
+                int interiorColumn = firstColumn + interiorBegin;
+                kernels.products(prev + interiorColumn, cur + interiorColumn, next + interiorColumn,
+                                 interiorEnd - interiorBegin, scale, &productA[interiorBegin],
+                                 &productB[interiorBegin], &productC[interiorBegin]);
+            }
+            for (int i = interiorEnd; i < virtualWidth; i++)
+            {
+                int column = reflect101(firstColumn + i, width);
+                productsAt(prev, cur, next, reflect101(column - 1, width), column, reflect101(column + 1, width),
+                           scale, productA[i], productB[i], productC[i]);
+            }
+
+            int slot = ((nextVirtualRow % blockSize) + blockSize) % blockSize;
+            float *ringRow = &ring[3 * slot * (size_t)regionWidth];
+            kernels.boxRow(&productA[0], regionWidth, blockSize, ringRow);
+            kernels.boxRow(&productB[0], regionWidth, blockSize, ringRow + regionWidth);
+            kernels.boxRow(&productC[0], regionWidth, blockSize, ringRow + 2 * regionWidth);
+        }
+
+        for (int r = 0; r < blockSize; r++)
+        {
+            const float *ringRow = &ring[3 * r * (size_t)regionWidth];
+            rowsA[r] = ringRow;
+            rowsB[r] = ringRow + regionWidth;
+            rowsC[r] = ringRow + 2 * regionWidth;
+        }
+        float *responseRow = response ? response + (row - y) * responseStride : 0;
+        float rowMax = kernels.responseRow(rowsA, rowsB, rowsC, blockSize, regionWidth, params.k, params.threshold, x,
+                                           row, corners, responseRow);
+        largest = max(largest, rowMax);
+    }
+
+    if (maxResponse)
+    {
+        *maxResponse = largest;
+    }
+}
+
+void harrisCornersFused(const uchar *image, int width, int height, size_t step, const HarrisKernelParams &params,
+                        vector<HarrisCorner> &corners, float *maxResponse)
+{
+    harrisCornersRegion(image, width, height, step, 0, 0, width, height, params, corners, maxResponse);
+}
@@ -0,0 +1,170 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Tiled, parallel Harris keypoint extraction with per-tile non-maximum suppression and top-K bucketing
+
+#include <algorithm>
+#include <cfloat>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#include "harris_keypoints.h"
+#include "logger.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Orders corners strongest first
+ */
+static bool strongerCorner(const HarrisCorner &a, const HarrisCorner &b)
+{
+    return a.response > b.response;
+}
+
+HarrisKeypointExtractor::HarrisKeypointExtractor(const HarrisKeypointParams &params)
+{
+    setParameters(params);
+}
+
+void HarrisKeypointExtractor::setParameters(const HarrisKeypointParams &params)
+{
+    this->params = params;
+    this->params.tileSize = max(8, params.tileSize);
+    this->params.maxPerTile = max(1, params.maxPerTile);
+    this->params.nmsRadius = max(0, params.nmsRadius);
+    tiles.clear();
+    tiledSize = Size();
+}
+
+void HarrisKeypointExtractor::layoutTiles(const Size &imageSize)
+{
+    tiles.clear();
+    for (int y = 0; y < imageSize.height; y += params.tileSize)
+    {
+        for (int x = 0; x < imageSize.width; x += params.tileSize)
+        {
+            Tile tile;
+            tile.area = Rect(x, y, min(params.tileSize, imageSize.width - x), min(params.tileSize, imageSize.height - y));
+            tile.maxResponse = 0;
+            tiles.push_back(tile);
+        }
+    }
+    tiledSize = imageSize;
+}
+
+void HarrisKeypointExtractor::processTile(const Mat &gray, Tile &tile) const
+{
+    const int radius = params.nmsRadius;
+    Rect halo(tile.area.x - radius, tile.area.y - radius, tile.area.width + 2 * radius,
+              tile.area.height + 2 * radius);
+    halo &= Rect(0, 0, gray.cols, gray.rows);
+
+    // Response only: the threshold is applied after every tile is done and the frame's maximum is known
+    HarrisKernelParams kernelParams;
+    kernelParams.blockSize = params.blockSize;
+    kernelParams.k = params.k;
+    kernelParams.threshold = FLT_MAX;
+    tile.response.resize(halo.area());
+    tile.unused.clear();
+    harrisCornersRegion(gray.data, gray.cols, gray.rows, gray.step, halo.x, halo.y, halo.width, halo.height,
+                        kernelParams, tile.unused, &tile.maxResponse, &tile.response[0], halo.width);
+
+    tile.candidates.clear();
+    for (int y = tile.area.y; y < tile.area.y + tile.area.height; y++)
+    {
+        const float *row = &tile.response[(y - halo.y) * halo.width];
+        for (int x = tile.area.x; x < tile.area.x + tile.area.width; x++)
+        {
+            float value = row[x - halo.x];
+            if (value <= 0)
+            {
+                continue;
+            }
+
+            // Ties go to the first pixel in raster order, so neighboring tiles never both keep a plateau
+            bool isMaximum = true;
+            for (int dy = -radius; dy <= radius && isMaximum; dy++)
+            {
+                int ny = y + dy;
+                if (ny < halo.y || ny >= halo.y + halo.height)
+                {
+                    continue;
+                }
+                const float *neighborRow = &tile.response[(ny - halo.y) * halo.width];
+                for (int dx = -radius; dx <= radius; dx++)
+                {
+                    int nx = x + dx;
+                    if ((dx == 0 && dy == 0) || nx < halo.x || nx >= halo.x + halo.width)
+                    {
+                        continue;
+                    }
+                    float neighbor = neighborRow[nx - halo.x];
+                    bool earlier = dy < 0 || (dy == 0 && dx < 0);
+                    if (earlier ? neighbor >= value : neighbor > value)
+                    {
+                        isMaximum = false;
+                        break;
+                    }
+                }
+            }
+
+            if (isMaximum)
+            {
+                HarrisCorner corner = {x, y, value};
+                tile.candidates.push_back(corner);
+            }
+        }
+    }
+
+    // The quality threshold is monotonic, so keeping the top K now and thresholding later gives the same result
+    size_t keep = (size_t)params.maxPerTile;
+    if (tile.candidates.size() > keep)
+    {
+        nth_element(tile.candidates.begin(), tile.candidates.begin() + keep, tile.candidates.end(), strongerCorner);
+        tile.candidates.resize(keep);
+    }
+    sort(tile.candidates.begin(), tile.candidates.end(), strongerCorner);
+}
+
+void HarrisKeypointExtractor::detect(const Mat &gray, vector<KeyPoint> &keypoints)
+{
+    keypoints.clear();
+    if (gray.empty() || gray.type() != CV_8UC1)
+    {
+        LOG_EVERY_MS(LOG_LEVEL_WARN, 1000, "HarrisKeypointExtractor expects a non-empty 8-bit grayscale image");
+        return;
+    }
+
+    if (tiles.empty() || gray.size() != tiledSize)
+    {
+        layoutTiles(gray.size());
+    }
+
+    parallel_for_(Range(0, (int)tiles.size()), [&](const Range &range) {
+        for (int i = range.start; i < range.end; i++)
+        {
+            processTile(gray, tiles[i]);
+        }
+    });
+
+    float maxResponse = 0;
+    for (size_t i = 0; i < tiles.size(); i++)
+    {
+        maxResponse = max(maxResponse, tiles[i].maxResponse);
+    }
+    if (maxResponse <= 0)
+    {
+        return;
+    }
+
+    float threshold = params.qualityLevel * maxResponse;
+    for (size_t i = 0; i < tiles.size(); i++)
+    {
+        const vector<HarrisCorner> &candidates = tiles[i].candidates;
+        for (size_t j = 0; j < candidates.size() && candidates[j].response > threshold; j++)
+        {
+            keypoints.push_back(KeyPoint((float)candidates[j].x, (float)candidates[j].y, (float)params.blockSize, -1,
+                                         candidates[j].response));
+        }
+    }
+}
@@ -0,0 +1,353 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Asynchronous leveled logger: per-thread lock-free buffers drained by a background thread
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "logger.h"
+#include "ring_buffer.h"
+
+using namespace std;
+
+atomic<int> runtimeLogLevel(LOG_LEVEL_INFO);
+
+// Messages a thread can have waiting before new ones are dropped
+static const size_t logRingCapacity = 4096;
+// How often the background thread looks for messages when nobody is waiting on a flush
+static const int logDrainIntervalMs = 5;
+
+struct LogRecord
+{
+    unsigned long long sequence;
+    LogLevel level;
+    string text;
+
+    LogRecord() : sequence(0), level(LOG_LEVEL_INFO)
+    {
+    }
+};
+
+/**
+ * @brief One thread's queue of messages; pushed only by that thread, popped only by the background thread. Set
+ * retired when the thread exits; the background thread frees it once it has drained it.
+ */
+struct ThreadLog
+{
+    RingBuffer<LogRecord> ring;
+    atomic<bool> retired;
+
+    ThreadLog() : ring(logRingCapacity), retired(false)
+    {
+    }
+};
+
+/**
+ * @brief State shared by the log calls and the background thread. Allocated once and never freed, so globals that
+ * log from their destructors still find it.
+ */
+struct LoggerState
+{
+    mutex lock;
+    condition_variable wakeUp;
+    condition_variable drained;
+    vector<unique_ptr<ThreadLog>> threadLogs;
+    atomic<unsigned long long> nextSequence;
+    atomic<long long> dropped;
+    // Cleared at exit, after which messages are written synchronously
+    atomic<bool> asynchronous;
+    long long flushRequested;
+    long long flushCompleted;
+    bool running;
+    bool stopping;
+    thread drainer;
+    mutex writeLock;
+
+    LoggerState()
+        : nextSequence(0), dropped(0), asynchronous(true), flushRequested(0), flushCompleted(0), running(false),
+          stopping(false)
+    {
+    }
+};
+
+static LoggerState &loggerState()
+{
+    static LoggerState *state = new LoggerState();
+    return *state;
+}
+
+static thread_local ThreadLog *threadLog = 0;
+// Set once the thread's owner is destroyed; anything the thread logs after that is written synchronously
+static thread_local bool threadLogRetired = false;
+
+/**
+ * @brief Retires the thread's ThreadLog when the thread exits, so short-lived threads (pipeline stages, pools,
+ * restarted frame writers) do not leave a 4096-slot ring behind each
+ */
+struct ThreadLogOwner
+{
+    ThreadLog *log;
+
+    ThreadLogOwner() : log(0)
+    {
+    }
+
+    ~ThreadLogOwner()
+    {
+        if (log)
+        {
+            log->retired.store(true, memory_order_release);
+        }
+        threadLog = 0;
+        threadLogRetired = true;
+    }
+};
+
+static thread_local ThreadLogOwner threadLogOwner;
+
+void setLogLevel(LogLevel level)
+{
+    runtimeLogLevel.store(level, memory_order_relaxed);
+}
+
+bool parseLogLevel(const string &name, LogLevel &level)
+{
+    static const char *names[] = {"trace", "debug", "info", "warn", "error", "off"};
+    for (int i = 0; i <= LOG_LEVEL_OFF; i++)
+    {
+        if (name == names[i])
+        {
+            level = (LogLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Writes messages in sequence order
+ */
+static void writeRecords(vector<LogRecord> &records)
+{
+    if (records.empty())
+    {
+        return;
+    }
+    LoggerState &state = loggerState();
+    sort(records.begin(), records.end(),
+         [](const LogRecord &a, const LogRecord &b) { return a.sequence < b.sequence; });
+    lock_guard<mutex> guard(state.writeLock);
+    bool wroteOut = false, wroteErr = false;
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        if (records[i].level >= LOG_LEVEL_WARN)
+        {
+            if (wroteOut)
+            {
+                // Keep stdout and stderr in order when both go to the same terminal
+                cout.flush();
+                wroteOut = false;
+            }
+            cerr << records[i].text << '\n';
+            wroteErr = true;
+        }
+        else
+        {
+            if (wroteErr)
+            {
+                cerr.flush();
+                wroteErr = false;
+            }
+            cout << records[i].text << '\n';
+            wroteOut = true;
+        }
+    }
+    cout.flush();
+    cerr.flush();
+}
+
+/**
+ * @brief Pops everything queued so far and writes it
+ */
+static void drainLogs()
+{
+    LoggerState &state = loggerState();
+    vector<ThreadLog *> logs;
+    {
+        lock_guard<mutex> guard(state.lock);
+        for (size_t i = 0; i < state.threadLogs.size(); i++)
+        {
+            logs.push_back(state.threadLogs[i].get());
+        }
+    }
+    vector<LogRecord> records;
+    vector<ThreadLog *> finished;
+    LogRecord record;
+    for (size_t i = 0; i < logs.size(); i++)
+    {
+        // Checked before popping: a log retired by then gets no more pushes, so this pass empties it for good
+        bool retired = logs[i]->retired.load(memory_order_acquire);
+        while (logs[i]->ring.tryPop(record))
+        {
+            records.push_back(record);
+        }
+        if (retired)
+        {
+            finished.push_back(logs[i]);
+        }
+    }
+    writeRecords(records);
+
+    if (!finished.empty())
+    {
+        lock_guard<mutex> guard(state.lock);
+        for (size_t i = 0; i < state.threadLogs.size();)
+        {
+            if (find(finished.begin(), finished.end(), state.threadLogs[i].get()) != finished.end())
+            {
+                state.threadLogs.erase(state.threadLogs.begin() + i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+}
+
+static void drainerLoop()
+{
+    LoggerState &state = loggerState();
+    unique_lock<mutex> guard(state.lock);
+    while (true)
+    {
+        state.wakeUp.wait_for(guard, chrono::milliseconds(logDrainIntervalMs),
+                              [&state] { return state.stopping || state.flushRequested > state.flushCompleted; });
+        long long target = state.flushRequested;
+        bool stop = state.stopping;
+        guard.unlock();
+        drainLogs();
+        guard.lock();
+        state.flushCompleted = max(state.flushCompleted, target);
+        state.drained.notify_all();
+        if (stop)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Drains the buffers and stops the background thread at exit; later messages are written synchronously
+ */
+static void stopLogger()
+{
+    LoggerState &state = loggerState();
+    {
+        lock_guard<mutex> guard(state.lock);
+        if (!state.running)
+        {
+            return;
+        }
+        state.stopping = true;
+        state.asynchronous.store(false);
+        state.wakeUp.notify_all();
+    }
+    state.drainer.join();
+    // Anything pushed while the thread was finishing its last pass
+    drainLogs();
+    lock_guard<mutex> guard(state.lock);
+    state.running = false;
+    if (state.dropped.load() > 0)
+    {
+        cerr << "Logger: " << state.dropped.load() << " messages dropped (buffer full)" << endl;
+    }
+}
+
+/**
+ * @brief Starts the background thread on first use. Returns false once the logger has been stopped at exit.
+ */
+static bool startLogger(LoggerState &state)
+{
+    lock_guard<mutex> guard(state.lock);
+    if (state.stopping)
+    {
+        return false;
+    }
+    if (!state.running)
+    {
+        state.running = true;
+        state.drainer = thread(drainerLoop);
+        // Registered after every global is constructed, so it runs before their destructors
+        atexit(stopLogger);
+    }
+    if (!threadLog)
+    {
+        state.threadLogs.push_back(unique_ptr<ThreadLog>(new ThreadLog()));
+        threadLog = state.threadLogs.back().get();
+        threadLogOwner.log = threadLog;
+    }
+    return true;
+}
+
+void logWrite(LogLevel level, const string &message)
+{
+    LoggerState &state = loggerState();
+    LogRecord record;
+    record.sequence = state.nextSequence.fetch_add(1, memory_order_relaxed);
+    record.level = level;
+    record.text = message;
+
+    if (!state.asynchronous.load(memory_order_acquire) || threadLogRetired || (!threadLog && !startLogger(state)))
+    {
+        vector<LogRecord> records(1, record);
+        writeRecords(records);
+        return;
+    }
+    if (!threadLog->ring.tryPush(record))
+    {
+        if (level >= LOG_LEVEL_WARN)
+        {
+            // Warnings and errors are worth a stall; chatter is not
+            vector<LogRecord> records(1, record);
+            writeRecords(records);
+            return;
+        }
+        state.dropped.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+void logFlush()
+{
+    LoggerState &state = loggerState();
+    unique_lock<mutex> guard(state.lock);
+    if (!state.running || state.stopping)
+    {
+        return;
+    }
+    long long target = ++state.flushRequested;
+    state.wakeUp.notify_all();
+    state.drained.wait(guard, [&state, target] { return state.flushCompleted >= target || !state.running; });
+}
+
+bool logRateAllows(LogRateLimit &limit, int intervalMs, long long &suppressed)
+{
+    long long nowMs =
+        chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    long long next = limit.nextMs.load(memory_order_relaxed);
+    if (nowMs < next || !limit.nextMs.compare_exchange_strong(next, nowMs + intervalMs, memory_order_relaxed))
+    {
+        limit.suppressed.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    suppressed = limit.suppressed.exchange(0, memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,180 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Combined mode that runs the Aruco, chessboard and Harris detectors concurrently on one shared frame
+
+#include <algorithm>
+#include <chrono>
+#include <opencv2/aruco.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "aruco_tracker.h"
+#include "chessboard_tracker.h"
+#include "frame_context.h"
+#include "frame_writer.h"
+#include "harris_keypoints.h"
+#include "logger.h"
+#include "multi_detector.h"
+#include "session_store.h"
+#include "stage_timer.h"
+#include "thread_pool.h"
+
+using namespace std;
+using namespace cv;
+
+enum Detector
+{
+    DETECTOR_ARUCO,
+    DETECTOR_CHESSBOARD,
+    DETECTOR_HARRIS,
+    DETECTOR_COUNT
+};
+
+static const char *detectorNames[DETECTOR_COUNT] = {"Aruco", "Chessboard", "Harris"};
+
+static double millisecondsSince(const chrono::steady_clock::time_point &start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+int multiDetectorStream(const StreamOptions &options)
+{
+    Ptr<FrameSource> source = openFrameSource(options.source);
+    if (!source->isOpened())
+    {
+        LOG_ERROR("Error opening video stream: " << source->describe());
+        return -1;
+    }
+    if (!options.headless)
+    {
+        namedWindow("Multi-detector", WINDOW_AUTOSIZE);
+    }
+    LOG_INFO("Reading frames from " << source->describe());
+    LOG_INFO("Press 'q' to quit the program");
+
+    // Each detector keeps its own state and is only ever run by one task at a time
+    const Size chessboardPattern(9, 6);
+    ArucoTracker arucoTracker;
+    arucoTracker.setRoiTracking(options.roiTracking, options.fullSearchInterval);
+    ChessboardTracker chessboardTracker(chessboardPattern, options.chessboardRedetectInterval);
+    HarrisKeypointExtractor harrisExtractor;
+    vector<Point2f> chessboardCorners;
+    vector<KeyPoint> keypoints;
+    bool chessboardFound = false;
+
+    // Two workers for two of the detectors; the frame loop's own thread runs the third
+    ThreadPool pool(DETECTOR_COUNT - 1, options.pinThreads);
+    FrameContext context;
+    FrameWriter writer;
+    configureFrameWriter(writer, options);
+
+    double detectorMs[DETECTOR_COUNT];
+    double totalDetectorMs[DETECTOR_COUNT] = {0, 0, 0};
+    double totalWallMs = 0;
+    long long detectedFrames = 0;
+    Mat frame, display;
+    FrameRateCounter frameRate;
+    while (!frameLimitReached(frameRate, options))
+    {
+        ScopedStageTimer frameTimer(STAGE_FRAME);
+        ScopedStageTimer captureTimer(STAGE_CAPTURE);
+        if (!source->read(frame))
+        {
+            if (source->isLive())
+            {
+                LOG_ERROR("Error: Could not capture frame");
+            }
+            break;
+        }
+        captureTimer.stop();
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        context.reset(frame);
+        pool.submit([&]() {
+            chrono::steady_clock::time_point detectorStart = chrono::steady_clock::now();
+            ScopedStageTimer detectTimer(STAGE_DETECT);
+            arucoTracker.detect(context.gray());
+            detectorMs[DETECTOR_ARUCO] = millisecondsSince(detectorStart);
+        });
+        pool.submit([&]() {
+            chrono::steady_clock::time_point detectorStart = chrono::steady_clock::now();
+            chessboardFound = chessboardTracker.process(context, chessboardCorners);
+            detectorMs[DETECTOR_CHESSBOARD] = millisecondsSince(detectorStart);
+        });
+        chrono::steady_clock::time_point harrisStart = chrono::steady_clock::now();
+        {
+            ScopedStageTimer detectTimer(STAGE_DETECT);
+            harrisExtractor.detect(context.gray(), keypoints);
+        }
+        detectorMs[DETECTOR_HARRIS] = millisecondsSince(harrisStart);
+        pool.wait();
+        totalWallMs += millisecondsSince(start);
+        for (int i = 0; i < DETECTOR_COUNT; i++)
+        {
+            totalDetectorMs[i] += detectorMs[i];
+        }
+        detectedFrames++;
+
+        ScopedStageTimer drawTimer(STAGE_DRAW);
+        frame.copyTo(display);
+        for (size_t i = 0; i < keypoints.size(); i++)
+        {
+            circle(display, keypoints[i].pt, 5, Scalar(0, 0, 255), 2);
+        }
+        if (chessboardFound)
+        {
+            drawChessboardCorners(display, chessboardPattern, chessboardCorners, true);
+        }
+        arucoTracker.draw(display);
+        putText(display,
+                "Markers: " + to_string(arucoTracker.ids().size()) + "  Chessboard: " +
+                    (chessboardFound ? "yes" : "no") + "  Harris: " + to_string(keypoints.size()),
+                Point(10, 30), FONT_HERSHEY_SIMPLEX, .75, Scalar(0, 255, 0), 2);
+        drawTimer.stop();
+
+        ScopedStageTimer writeTimer(STAGE_WRITE);
+        writer.record(display);
+        writeTimer.stop();
+
+        frameRate.tick();
+        ScopedStageTimer displayTimer(STAGE_DISPLAY);
+        char key = presentFrame("Multi-detector", display, options);
+        displayTimer.stop();
+        if (key == 'q' || key == 'Q' || key == 27)
+        {
+            LOG_INFO("User terminated program");
+            break;
+        }
+    }
+
+    frameRate.report("Multi-detector");
+    if (detectedFrames > 0)
+    {
+        ostringstream means;
+        means << "Mean detector cost:";
+        double slowestMs = 0, sumMs = 0;
+        for (int i = 0; i < DETECTOR_COUNT; i++)
+        {
+            double meanMs = totalDetectorMs[i] / detectedFrames;
+            means << " " << detectorNames[i] << " " << meanMs << " ms" << (i + 1 < DETECTOR_COUNT ? "," : "");
+            slowestMs = max(slowestMs, meanMs);
+            sumMs += meanMs;
+        }
+        LOG_INFO(means.str());
+        // The wall time includes the shared gray conversion, which whichever detector got there first paid for
+        double wallMs = totalWallMs / detectedFrames;
+        LOG_INFO("Detection wall time " << wallMs << " ms per frame: " << sumMs << " ms run one after another, "
+                 << slowestMs << " ms for the slowest detector alone (" << (wallMs > 0 ? sumMs / wallMs : 0.0)
+                 << "x speedup)");
+    }
+    context.stats().report();
+    chessboardTracker.stats().report();
+    reportSessionMemory();
+    writer.flush();
+    writer.stats().report();
+    finishStageTimes("Multi-detector", options.statsFile);
+    if (!options.headless)
+    {
+        destroyAllWindows();
+    }
+    return 0;
+}
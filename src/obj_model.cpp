@@ -0,0 +1,230 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Wavefront OBJ loading and placement of triangle meshes on a board
+
+#include <algorithm>
+#include <cctype>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#include "logger.h"
+#include "obj_model.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Resolves one face vertex token ("7", "7/2", "7//3", "7/2/3", or negative for relative) to a 0-based index
+ *
+ * @param token start of the token
+ * @param end receives the first character after the token
+ * @param vertexCount vertices defined so far
+ * @return the index, or -1 if the token is not a valid reference
+ */
+static int parseFaceIndex(const char *token, char **end, int vertexCount)
+{
+    long index = strtol(token, end, 10);
+    if (*end == token)
+    {
+        return -1;
+    }
+    // Skip the texture and normal references
+    while (**end != '\0' && !isspace((unsigned char)**end))
+    {
+        (*end)++;
+    }
+    if (index < 0)
+    {
+        index += vertexCount;
+    }
+    else
+    {
+        index -= 1;
+    }
+    return index >= 0 && index < vertexCount ? (int)index : -1;
+}
+
+bool loadObjModel(const string &filename, ObjModel &model)
+{
+    ifstream file(filename.c_str());
+    if (!file.is_open())
+    {
+        LOG_ERROR("Could not open model " << filename);
+        return false;
+    }
+
+    model = ObjModel();
+    string line;
+    vector<int> face;
+    int lineNumber = 0, skippedFaces = 0;
+    while (getline(file, line))
+    {
+        lineNumber++;
+        const char *text = line.c_str();
+        while (*text == ' ' || *text == '\t')
+        {
+            text++;
+        }
+
+        if (text[0] == 'v' && (text[1] == ' ' || text[1] == '\t'))
+        {
+            char *end = 0;
+            float x = strtof(text + 2, &end);
+            float y = strtof(end, &end);
+            float z = strtof(end, &end);
+            model.vertices.push_back(Point3f(x, y, z));
+        }
+        else if (text[0] == 'f' && (text[1] == ' ' || text[1] == '\t'))
+        {
+            face.clear();
+            const char *token = text + 2;
+            bool valid = true;
+            while (valid)
+            {
+                while (*token == ' ' || *token == '\t')
+                {
+                    token++;
+                }
+                if (*token == '\0' || *token == '\r')
+                {
+                    break;
+                }
+                char *end = 0;
+                int index = parseFaceIndex(token, &end, (int)model.vertices.size());
+                valid = index >= 0;
+                face.push_back(index);
+                token = end;
+            }
+            if (!valid || face.size() < 3)
+            {
+                skippedFaces++;
+                continue;
+            }
+            for (size_t i = 1; i + 1 < face.size(); i++)
+            {
+                model.triangles.push_back(Vec3i(face[0], face[i], face[i + 1]));
+            }
+        }
+    }
+
+    if (skippedFaces > 0)
+    {
+        LOG_WARN("Skipped " << skippedFaces << " invalid faces in " << filename << " (" << lineNumber << " lines)");
+    }
+    if (model.empty())
+    {
+        LOG_ERROR("No faces found in model " << filename);
+        return false;
+    }
+    computeObjNormals(model);
+    return true;
+}
+
+void computeObjNormals(ObjModel &model)
+{
+    model.normals.assign(model.vertices.size(), Point3f(0, 0, 0));
+    for (size_t i = 0; i < model.triangles.size(); i++)
+    {
+        const Vec3i &t = model.triangles[i];
+        // Unnormalized, so larger faces weigh more
+        const Point3f &a = model.vertices[t[0]];
+        Point3f normal = (model.vertices[t[1]] - a).cross(model.vertices[t[2]] - a);
+        for (int v = 0; v < 3; v++)
+        {
+            model.normals[t[v]] += normal;
+        }
+    }
+    for (size_t i = 0; i < model.normals.size(); i++)
+    {
+        float length = (float)norm(model.normals[i]);
+        model.normals[i] = length > 0 ? model.normals[i] * (1.0f / length) : Point3f(0, 0, -1);
+    }
+}
+
+void placeObjModel(ObjModel &model, float size, const Point2f &center)
+{
+    if (model.vertices.empty())
+    {
+        return;
+    }
+
+    // (x, y, z) -> (x, z, -y) is a rotation, so the winding (and with it back-face culling) is preserved
+    Point3f low(FLT_MAX, FLT_MAX, FLT_MAX), high(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (size_t i = 0; i < model.vertices.size(); i++)
+    {
+        Point3f &v = model.vertices[i];
+        v = Point3f(v.x, v.z, -v.y);
+        low = Point3f(min(low.x, v.x), min(low.y, v.y), min(low.z, v.z));
+        high = Point3f(max(high.x, v.x), max(high.y, v.y), max(high.z, v.z));
+    }
+    for (size_t i = 0; i < model.normals.size(); i++)
+    {
+        Point3f &n = model.normals[i];
+        n = Point3f(n.x, n.z, -n.y);
+    }
+
+    float extent = max(high.x - low.x, max(high.y - low.y, high.z - low.z));
+    float scale = extent > 0 ? size / extent : 1.0f;
+    Point3f middle((low.x + high.x) / 2, (low.y + high.y) / 2, high.z);
+    for (size_t i = 0; i < model.vertices.size(); i++)
+    {
+        Point3f &v = model.vertices[i];
+        v = Point3f((v.x - middle.x) * scale + center.x, (v.y - middle.y) * scale + center.y, (v.z - middle.z) * scale);
+    }
+}
+
+ObjModel makeSphereModel(float radius, int segments, int rings, const Point2f &center)
+{
+    ObjModel model;
+    segments = max(3, segments);
+    rings = max(2, rings);
+    // Ring 0 is the top pole (z = -2 * radius), ring `rings` the bottom pole touching the board
+    for (int r = 0; r <= rings; r++)
+    {
+        double polar = CV_PI * r / rings;
+        int count = (r == 0 || r == rings) ? 1 : segments;
+        for (int s = 0; s < count; s++)
+        {
+            double azimuth = 2 * CV_PI * s / segments;
+            Point3f unit((float)(sin(polar) * cos(azimuth)), (float)(sin(polar) * sin(azimuth)), (float)-cos(polar));
+            model.vertices.push_back(Point3f(center.x + radius * unit.x, center.y + radius * unit.y,
+                                             radius * unit.z - radius));
+            model.normals.push_back(unit);
+        }
+    }
+
+    // Ring r (1 <= r < rings) starts at vertex 1 + (r - 1) * segments
+    int bottom = (int)model.vertices.size() - 1;
+    for (int s = 0; s < segments; s++)
+    {
+        int next = (s + 1) % segments;
+        int top = 1 + s, topNext = 1 + next;
+        model.triangles.push_back(Vec3i(0, topNext, top));
+        for (int r = 1; r + 1 < rings; r++)
+        {
+            int a = 1 + (r - 1) * segments + s, b = 1 + (r - 1) * segments + next;
+            int c = 1 + r * segments + s, d = 1 + r * segments + next;
+            model.triangles.push_back(Vec3i(a, b, d));
+            model.triangles.push_back(Vec3i(a, d, c));
+        }
+        int last = 1 + (rings - 2) * segments;
+        model.triangles.push_back(Vec3i(bottom, last + s, last + next));
+    }
+
+    // Make sure every triangle winds outward, whatever the azimuth direction works out to
+    Point3f middle(center.x, center.y, -radius);
+    for (size_t i = 0; i < model.triangles.size(); i++)
+    {
+        Vec3i &t = model.triangles[i];
+        Point3f a = model.vertices[t[0]], b = model.vertices[t[1]], c = model.vertices[t[2]];
+        if ((b - a).cross(c - a).dot((a + b + c) * (1.0f / 3) - middle) < 0)
+        {
+            swap(t[1], t[2]);
+        }
+    }
+    return model;
+}
@@ -0,0 +1,481 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Batched AR overlay renderer for pre-built wireframe and solid meshes
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#include "logger.h"
+#include "overlay_renderer.h"
+
+using namespace std;
+using namespace cv;
+
+// Vertices closer to the camera than this (in board units) are treated as behind it
+static const float nearPlane = 1.0f;
+
+// Fractional bits of the fixed-point coordinates handed to polylines/fillPoly
+static const int drawShift = 4;
+static const float drawScale = (float)(1 << drawShift);
+
+// Projected coordinates beyond this are dropped rather than risking overflow in the fixed-point conversion
+static const float maxCoordinate = 1e6f;
+
+/**
+ * @brief Milliseconds elapsed since start
+ */
+static double overlayMillisecondsSince(const chrono::steady_clock::time_point &start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Converts a projected point to the fixed-point form used with drawShift
+ */
+static Point toFixedPoint(const Point2f &point)
+{
+    return Point(cvRound(point.x * drawScale), cvRound(point.y * drawScale));
+}
+
+/**
+ * @brief Checks whether a primitive's vertices can be drawn and whether any part of its bounding box is on screen
+ *
+ * @param camera camera-space vertices of the primitive
+ * @param projected projected vertices of the primitive
+ * @param count number of vertices
+ * @param imageRect frame bounds
+ */
+static bool primitiveOnScreen(const Point3f *const *camera, const Point2f *const *projected, int count,
+                              const Rect &imageRect)
+{
+    float minX = maxCoordinate, minY = maxCoordinate, maxX = -maxCoordinate, maxY = -maxCoordinate;
+    for (int i = 0; i < count; i++)
+    {
+        const Point2f &point = *projected[i];
+        if (camera[i]->z < nearPlane || !(fabs(point.x) < maxCoordinate && fabs(point.y) < maxCoordinate))
+        {
+            return false;
+        }
+        minX = min(minX, point.x);
+        minY = min(minY, point.y);
+        maxX = max(maxX, point.x);
+        maxY = max(maxY, point.y);
+    }
+    return maxX >= imageRect.x && maxY >= imageRect.y && minX < imageRect.x + imageRect.width &&
+           minY < imageRect.y + imageRect.height;
+}
+
+OverlayMeshData makeHourglassMesh(float size)
+{
+    OverlayMeshData mesh;
+    float half = size / 2;
+    mesh.vertices.push_back(Point3f(0, 0, 0));       // 0
+    mesh.vertices.push_back(Point3f(0, size, 0));    // 1
+    mesh.vertices.push_back(Point3f(size, size, 0)); // 2
+    mesh.vertices.push_back(Point3f(size, 0, 0));    // 3
+
+    mesh.vertices.push_back(Point3f(half, half, -size)); // 4 peak
+
+    mesh.vertices.push_back(Point3f(0, 0, -2 * size));       // 5
+    mesh.vertices.push_back(Point3f(0, size, -2 * size));    // 6
+    mesh.vertices.push_back(Point3f(size, size, -2 * size)); // 7
+    mesh.vertices.push_back(Point3f(size, 0, -2 * size));    // 8
+
+    for (int i = 0; i < 4; i++)
+    {
+        mesh.edges.push_back(Vec2i(i, (i + 1) % 4));         // base
+        mesh.edges.push_back(Vec2i(i, 4));                   // lower sides
+        mesh.edges.push_back(Vec2i(5 + i, 5 + (i + 1) % 4)); // top
+        mesh.edges.push_back(Vec2i(5 + i, 4));               // upper sides
+    }
+    return mesh;
+}
+
+OverlayMeshData makeCubeMesh(float side, float x, float y)
+{
+    OverlayMeshData mesh;
+    // Vertex i has bit 0 set for +x, bit 1 for +y and bit 2 for the top (z = -side)
+    for (int i = 0; i < 8; i++)
+    {
+        mesh.vertices.push_back(Point3f(x + (i & 1 ? side : 0), y + (i & 2 ? side : 0), i & 4 ? -side : 0));
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        for (int bit = 1; bit < 8; bit <<= 1)
+        {
+            if (!(i & bit))
+            {
+                mesh.edges.push_back(Vec2i(i, i | bit));
+            }
+        }
+    }
+
+    // Each face holds the vertices with one bit fixed; split it along a diagonal and wind both halves outward
+    Point3f center(x + side / 2, y + side / 2, -side / 2);
+    for (int bit = 1; bit < 8; bit <<= 1)
+    {
+        for (int value = 0; value <= bit; value += bit)
+        {
+            vector<int> face;
+            for (int i = 0; i < 8; i++)
+            {
+                if ((i & bit) == value)
+                {
+                    face.push_back(i);
+                }
+            }
+            // face[0] and face[3] differ in both free bits, so they are the diagonal
+            int halves[2][3] = {{face[0], face[1], face[3]}, {face[0], face[3], face[2]}};
+            for (int h = 0; h < 2; h++)
+            {
+                Point3f a = mesh.vertices[halves[h][0]];
+                Point3f b = mesh.vertices[halves[h][1]];
+                Point3f c = mesh.vertices[halves[h][2]];
+                Point3f normal = (b - a).cross(c - a);
+                Point3f centroid = (a + b + c) * (1.0f / 3);
+                if (normal.dot(centroid - center) < 0)
+                {
+                    swap(halves[h][1], halves[h][2]);
+                }
+                mesh.triangles.push_back(Vec3i(halves[h][0], halves[h][1], halves[h][2]));
+            }
+        }
+    }
+    return mesh;
+}
+
+/**
+ * @brief Prints how many instances were drawn, how much was culled, and what projection and drawing cost
+ */
+void OverlayRenderStats::report() const
+{
+    long long primitives = drawnPrimitives + culledPrimitives;
+    LOG_INFO("Overlay rendering: " << instances << " instances over " << frames << " frames, " << drawnPrimitives
+             << " primitives drawn, " << culledPrimitives << " culled ("
+             << (primitives > 0 ? culledPrimitives * 100.0 / primitives : 0.0) << "%)");
+    LOG_INFO("Mean cost per frame: projection " << (frames > 0 ? projectMs / frames : 0.0) << " ms, drawing "
+             << (frames > 0 ? drawMs / frames : 0.0) << " ms");
+}
+
+OverlayRenderer::OverlayRenderer()
+{
+}
+
+int OverlayRenderer::addMesh(const OverlayMeshData &mesh, const Scalar &color, int thickness, bool filled,
+                             const Scalar &fillColor)
+{
+    MeshRange range;
+    range.vertexOffset = (int)vertexX.size();
+    range.vertexCount = (int)mesh.vertices.size();
+    range.edgeOffset = (int)edgeStart.size();
+    range.edgeCount = (int)mesh.edges.size();
+    range.triangleOffset = (int)triangleA.size();
+    range.triangleCount = (int)mesh.triangles.size();
+    range.color = color;
+    range.fillColor = fillColor;
+    range.thickness = thickness;
+    range.filled = filled && !mesh.triangles.empty();
+
+    for (size_t i = 0; i < mesh.vertices.size(); i++)
+    {
+        vertexX.push_back(mesh.vertices[i].x);
+        vertexY.push_back(mesh.vertices[i].y);
+        vertexZ.push_back(mesh.vertices[i].z);
+    }
+    // Indices stay local to the mesh; the instance's vertex offset is added when drawing
+    for (size_t i = 0; i < mesh.edges.size(); i++)
+    {
+        edgeStart.push_back(mesh.edges[i][0]);
+        edgeEnd.push_back(mesh.edges[i][1]);
+    }
+    for (size_t i = 0; i < mesh.triangles.size(); i++)
+    {
+        triangleA.push_back(mesh.triangles[i][0]);
+        triangleB.push_back(mesh.triangles[i][1]);
+        triangleC.push_back(mesh.triangles[i][2]);
+    }
+    meshes.push_back(range);
+    return (int)meshes.size() - 1;
+}
+
+void OverlayRenderer::clearInstances()
+{
+    instanceMesh.clear();
+    instanceRotation.clear();
+    instanceTranslation.clear();
+}
+
+void OverlayRenderer::addInstance(int mesh, const Mat &rvec, const Mat &tvec)
+{
+    CV_Assert(mesh >= 0 && mesh < (int)meshes.size());
+    Mat rotation, translation;
+    Rodrigues(rvec, rotation);
+    rotation.convertTo(rotation, CV_32F);
+    tvec.reshape(1, 3).convertTo(translation, CV_32F);
+
+    instanceMesh.push_back(mesh);
+    instanceRotation.push_back(Matx33f((const float *)rotation.data));
+    instanceTranslation.push_back(Vec3f(translation.at<float>(0), translation.at<float>(1), translation.at<float>(2)));
+}
+
+void OverlayRenderer::projectInstances(const Mat &cameraMatrix, const Mat &distCoeffs)
+{
+    size_t instances = instanceMesh.size();
+    instanceVertexOffset.resize(instances);
+    instanceDepth.resize(instances);
+
+    int totalVertices = 0;
+    for (size_t i = 0; i < instances; i++)
+    {
+        instanceVertexOffset[i] = totalVertices;
+        totalVertices += meshes[instanceMesh[i]].vertexCount;
+    }
+    cameraPoints.resize(totalVertices);
+
+    for (size_t i = 0; i < instances; i++)
+    {
+        const MeshRange &mesh = meshes[instanceMesh[i]];
+        const Matx33f &r = instanceRotation[i];
+        const Vec3f &t = instanceTranslation[i];
+        const float *x = &vertexX[mesh.vertexOffset];
+        const float *y = &vertexY[mesh.vertexOffset];
+        const float *z = &vertexZ[mesh.vertexOffset];
+        Point3f *out = &cameraPoints[instanceVertexOffset[i]];
+        float depth = 0;
+        for (int v = 0; v < mesh.vertexCount; v++)
+        {
+            out[v].x = r(0, 0) * x[v] + r(0, 1) * y[v] + r(0, 2) * z[v] + t[0];
+            out[v].y = r(1, 0) * x[v] + r(1, 1) * y[v] + r(1, 2) * z[v] + t[1];
+            out[v].z = r(2, 0) * x[v] + r(2, 1) * y[v] + r(2, 2) * z[v] + t[2];
+            depth += out[v].z;
+        }
+        instanceDepth[i] = mesh.vertexCount > 0 ? depth / mesh.vertexCount : 0;
+    }
+
+    // The points are already in camera space, so one call with an identity pose projects every instance
+    if (totalVertices > 0)
+    {
+        projectPoints(cameraPoints, Vec3d(0, 0, 0), Vec3d(0, 0, 0), cameraMatrix, distCoeffs, projectedPoints);
+    }
+    else
+    {
+        projectedPoints.clear();
+    }
+}
+
+void OverlayRenderer::collectInstance(int instance, const Rect &imageRect)
+{
+    const MeshRange &mesh = meshes[instanceMesh[instance]];
+    const Point3f *camera = &cameraPoints[instanceVertexOffset[instance]];
+    const Point2f *projected = &projectedPoints[instanceVertexOffset[instance]];
+    int culled = 0;
+
+    if (mesh.filled)
+    {
+        vertexVisible.assign(mesh.vertexCount, 0);
+        for (int t = 0; t < mesh.triangleCount; t++)
+        {
+            int index[3] = {triangleA[mesh.triangleOffset + t], triangleB[mesh.triangleOffset + t],
+                            triangleC[mesh.triangleOffset + t]};
+            const Point3f *cameraVertex[3] = {&camera[index[0]], &camera[index[1]], &camera[index[2]]};
+            const Point2f *projectedVertex[3] = {&projected[index[0]], &projected[index[1]], &projected[index[2]]};
+            if (!primitiveOnScreen(cameraVertex, projectedVertex, 3, imageRect))
+            {
+                culled++;
+                continue;
+            }
+            // The camera sits at the origin, so a triangle faces it when its normal points back along the view ray
+            Point3f normal = (*cameraVertex[1] - *cameraVertex[0]).cross(*cameraVertex[2] - *cameraVertex[0]);
+            if (normal.dot(*cameraVertex[0]) >= 0)
+            {
+                culled++;
+                continue;
+            }
+            for (int v = 0; v < 3; v++)
+            {
+                fillPoints.push_back(toFixedPoint(*projectedVertex[v]));
+                vertexVisible[index[v]] = 1;
+            }
+        }
+    }
+
+    for (int e = 0; e < mesh.edgeCount; e++)
+    {
+        int start = edgeStart[mesh.edgeOffset + e];
+        int end = edgeEnd[mesh.edgeOffset + e];
+        const Point3f *cameraVertex[2] = {&camera[start], &camera[end]};
+        const Point2f *projectedVertex[2] = {&projected[start], &projected[end]};
+        bool hidden = mesh.filled && !(vertexVisible[start] && vertexVisible[end]);
+        if (hidden || !primitiveOnScreen(cameraVertex, projectedVertex, 2, imageRect))
+        {
+            culled++;
+            continue;
+        }
+        linePoints.push_back(toFixedPoint(projected[start]));
+        linePoints.push_back(toFixedPoint(projected[end]));
+    }
+
+    renderStats.culledPrimitives += culled;
+}
+
+void OverlayRenderer::flushBatch(Mat &image, const MeshRange &mesh)
+{
+    // The point buffers are complete, so their addresses are stable while the contour lists are built
+    if (!fillPoints.empty())
+    {
+        contourStarts.clear();
+        contourSizes.assign(fillPoints.size() / 3, 3);
+        for (size_t i = 0; i < fillPoints.size(); i += 3)
+        {
+            contourStarts.push_back(&fillPoints[i]);
+        }
+        fillPoly(image, &contourStarts[0], &contourSizes[0], (int)contourSizes.size(), mesh.fillColor, LINE_8,
+                 drawShift);
+        renderStats.drawnPrimitives += contourSizes.size();
+    }
+    if (!linePoints.empty())
+    {
+        contourStarts.clear();
+        contourSizes.assign(linePoints.size() / 2, 2);
+        for (size_t i = 0; i < linePoints.size(); i += 2)
+        {
+            contourStarts.push_back(&linePoints[i]);
+        }
+        polylines(image, &contourStarts[0], &contourSizes[0], (int)contourSizes.size(), false, mesh.color,
+                  mesh.thickness, LINE_8, drawShift);
+        renderStats.drawnPrimitives += contourSizes.size();
+    }
+    fillPoints.clear();
+    linePoints.clear();
+}
+
+int OverlayRenderer::render(Mat &image, const Mat &cameraMatrix, const Mat &distCoeffs)
+{
+    long long drawnBefore = renderStats.drawnPrimitives;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    projectInstances(cameraMatrix, distCoeffs);
+    renderStats.projectMs += overlayMillisecondsSince(start);
+
+    start = chrono::steady_clock::now();
+    drawOrder.resize(instanceMesh.size());
+    for (size_t i = 0; i < drawOrder.size(); i++)
+    {
+        drawOrder[i] = (int)i;
+    }
+    // Far to near; ties keep insertion order so runs of the same mesh stay together
+    stable_sort(drawOrder.begin(), drawOrder.end(),
+                [this](int a, int b) { return instanceDepth[a] > instanceDepth[b]; });
+
+    // Instances of a wireframe mesh are batched until the mesh changes. A solid instance is flushed on its own: one
+    // fillPoly over two overlapping instances would leave holes where they cross.
+    Rect imageRect(0, 0, image.cols, image.rows);
+    int batchMesh = -1;
+    for (size_t i = 0; i < drawOrder.size(); i++)
+    {
+        int mesh = instanceMesh[drawOrder[i]];
+        if (batchMesh >= 0 && (batchMesh != mesh || meshes[batchMesh].filled))
+        {
+            flushBatch(image, meshes[batchMesh]);
+        }
+        collectInstance(drawOrder[i], imageRect);
+        batchMesh = mesh;
+    }
+    if (batchMesh >= 0)
+    {
+        flushBatch(image, meshes[batchMesh]);
+    }
+    renderStats.drawMs += overlayMillisecondsSince(start);
+    renderStats.instances += instanceMesh.size();
+    renderStats.frames++;
+    return (int)(renderStats.drawnPrimitives - drawnBefore);
+}
+
+/**
+ * @brief The overlay code detectChessBoard used to run for one hourglass: rebuild the points, project them, and
+ * draw 16 separate lines
+ */
+static void drawHourglassPerObject(Mat &image, const Mat &rvec, const Mat &tvec, const Mat &cameraMatrix,
+                                   const Mat &distCoeffs)
+{
+    vector<Point3f> pyramidPoints;
+    pyramidPoints.push_back(Point3f(0, 0, 0));
+    pyramidPoints.push_back(Point3f(0, 100, 0));
+    pyramidPoints.push_back(Point3f(100, 100, 0));
+    pyramidPoints.push_back(Point3f(100, 0, 0));
+    pyramidPoints.push_back(Point3f(50, 50, -100));
+    pyramidPoints.push_back(Point3f(0, 0, -200));
+    pyramidPoints.push_back(Point3f(0, 100, -200));
+    pyramidPoints.push_back(Point3f(100, 100, -200));
+    pyramidPoints.push_back(Point3f(100, 0, -200));
+
+    vector<Point2f> projectedPoints;
+    projectPoints(pyramidPoints, rvec, tvec, cameraMatrix, distCoeffs, projectedPoints);
+    for (int i = 0; i < 4; i++)
+    {
+        line(image, projectedPoints[i], projectedPoints[(i + 1) % 4], Scalar(0, 0, 255), 2);
+        line(image, projectedPoints[i], projectedPoints[4], Scalar(0, 0, 255), 2);
+        line(image, projectedPoints[5 + i], projectedPoints[5 + (i + 1) % 4], Scalar(0, 0, 255), 2);
+        line(image, projectedPoints[5 + i], projectedPoints[4], Scalar(0, 0, 255), 2);
+    }
+}
+
+int benchmarkOverlayRenderer(int maxObjects, int repeats)
+{
+    Size frameSize(1280, 720);
+    Mat cameraMatrix = (Mat_<double>(3, 3) << 1000, 0, frameSize.width / 2.0, 0, 1000, frameSize.height / 2.0, 0, 0,
+                        1);
+    Mat distCoeffs = (Mat_<double>(5, 1) << -0.1, 0.05, 0, 0, 0);
+    Mat frame(frameSize, CV_8UC3);
+
+    OverlayRenderer renderer;
+    int hourglass = renderer.addMesh(makeHourglassMesh(100), Scalar(0, 0, 255), 2);
+
+    LOG_INFO("Benchmarking overlay drawing on a " << frameSize.width << "x" << frameSize.height << " frame, " << repeats
+             << " frames per count");
+    LOG_INFO("objects\tper_object_ms\tbatched_ms\tper_object_us_each\tbatched_us_each\tspeedup");
+
+    for (int objects = 1; objects <= maxObjects; objects *= 2)
+    {
+        // A grid of tilted boards spread over the frame, a few of them partly off screen
+        vector<Mat> rvecs, tvecs;
+        int columns = (int)ceil(sqrt((double)objects));
+        for (int i = 0; i < objects; i++)
+        {
+            double x = -900 + 1800.0 * (i % columns + 0.5) / columns;
+            double y = -500 + 1000.0 * (i / columns + 0.5) / columns;
+            rvecs.push_back((Mat_<double>(3, 1) << 0.4, 0.1 * (i % 3), 0.05 * i));
+            tvecs.push_back((Mat_<double>(3, 1) << x, y, 1500 + 20 * (i % 5)));
+        }
+
+        double perObjectMs = 0, batchedMs = 0;
+        for (int r = 0; r < repeats; r++)
+        {
+            frame.setTo(Scalar::all(0));
+            int64 start = getTickCount();
+            for (int i = 0; i < objects; i++)
+            {
+                drawHourglassPerObject(frame, rvecs[i], tvecs[i], cameraMatrix, distCoeffs);
+            }
+            perObjectMs += (getTickCount() - start) * 1000.0 / getTickFrequency();
+
+            frame.setTo(Scalar::all(0));
+            start = getTickCount();
+            renderer.clearInstances();
+            for (int i = 0; i < objects; i++)
+            {
+                renderer.addInstance(hourglass, rvecs[i], tvecs[i]);
+            }
+            renderer.render(frame, cameraMatrix, distCoeffs);
+            batchedMs += (getTickCount() - start) * 1000.0 / getTickFrequency();
+        }
+        perObjectMs /= repeats;
+        batchedMs /= repeats;
+        LOG_INFO(objects << "\t" << perObjectMs << "\t" << batchedMs << "\t" << perObjectMs * 1000.0 / objects << "\t"
+                 << batchedMs * 1000.0 / objects << "\t" << perObjectMs / batchedMs);
+    }
+    renderer.stats().report();
+    return 0;
+}
@@ -0,0 +1,185 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Planar board pose estimation, warm-started from the previous frame's pose
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <opencv2/aruco.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "logger.h"
+#include "pose_estimator.h"
+
+using namespace std;
+using namespace cv;
+
+// Relative step below which the refinement has converged
+static const double convergedStep = 1e-6;
+
+/**
+ * @brief Prints how often the estimator warm-started and what each kind of solve cost
+ */
+void PoseEstimatorStats::report() const
+{
+    LOG_INFO("Pose estimation: " << warmSolves << " warm solves, " << coldSolves << " cold solves (" << rejectedWarm
+             << " after a rejected warm start), " << failures << " failures");
+    LOG_INFO("Mean cost: warm " << (warmSolves > 0 ? warmMs / warmSolves : 0.0) << " ms / "
+             << (warmSolves > 0 ? (double)warmIterations / warmSolves : 0.0) << " iterations, cold "
+             << (coldSolves > 0 ? coldMs / coldSolves : 0.0) << " ms / "
+             << (coldSolves > 0 ? (double)coldIterations / coldSolves : 0.0) << " iterations");
+}
+
+PoseEstimator::PoseEstimator(double maxReprojectionError, int maxIterations)
+    : maxReprojectionError(maxReprojectionError), maxIterations(maxIterations), hasPrior(false), lastWarm(false),
+      iterations(0), error(0)
+{
+}
+
+double PoseEstimator::reprojectionError(const vector<Point3f> &objectPoints, const vector<Point2f> &imagePoints,
+                                        const Mat &cameraMatrix, const Mat &distCoeffs, const Mat &pose)
+{
+    projectPoints(objectPoints, pose.rowRange(0, 3), pose.rowRange(3, 6), cameraMatrix, distCoeffs, projected);
+    double sumSquared = 0;
+    for (size_t i = 0; i < imagePoints.size(); i++)
+    {
+        Point2f diff = projected[i] - imagePoints[i];
+        sumSquared += diff.dot(diff);
+    }
+    return sqrt(sumSquared / imagePoints.size());
+}
+
+double PoseEstimator::refine(const vector<Point3f> &objectPoints, const vector<Point2f> &imagePoints,
+                             const Mat &cameraMatrix, const Mat &distCoeffs, Mat &pose)
+{
+    int pointCount = (int)objectPoints.size();
+    Mat jacobian, residual(2 * pointCount, 1, CV_64F), step, candidate;
+    double lambda = 1e-3;
+    double currentError = -1;
+    iterations = 0;
+
+    while (iterations < maxIterations)
+    {
+        // The Jacobian columns are d(rvec), d(tvec), then the intrinsics, which stay fixed
+        projectPoints(objectPoints, pose.rowRange(0, 3), pose.rowRange(3, 6), cameraMatrix, distCoeffs, projected,
+                      jacobian);
+        double sumSquared = 0;
+        for (int i = 0; i < pointCount; i++)
+        {
+            Point2f diff = projected[i] - imagePoints[i];
+            residual.at<double>(2 * i) = diff.x;
+            residual.at<double>(2 * i + 1) = diff.y;
+            sumSquared += diff.dot(diff);
+        }
+        currentError = sqrt(sumSquared / pointCount);
+        iterations++;
+
+        Mat poseJacobian = jacobian.colRange(0, 6);
+        Mat normal = poseJacobian.t() * poseJacobian;
+        Mat gradient = poseJacobian.t() * residual;
+
+        // Damp until a step lowers the error (or the damping gives up)
+        bool improved = false;
+        while (!improved && lambda < 1e8)
+        {
+            Mat damped = normal.clone();
+            for (int i = 0; i < 6; i++)
+            {
+                damped.at<double>(i, i) *= 1.0 + lambda;
+            }
+            if (!solve(damped, -gradient, step, DECOMP_CHOLESKY))
+            {
+                lambda *= 10;
+                continue;
+            }
+            candidate = pose + step;
+            double candidateError = reprojectionError(objectPoints, imagePoints, cameraMatrix, distCoeffs, candidate);
+            if (candidateError < currentError)
+            {
+                candidate.copyTo(pose);
+                currentError = candidateError;
+                lambda = max(lambda / 10, 1e-7);
+                improved = true;
+            }
+            else
+            {
+                lambda *= 10;
+            }
+        }
+        if (!improved || norm(step) <= convergedStep * (norm(pose) + convergedStep))
+        {
+            break;
+        }
+    }
+    return currentError;
+}
+
+bool PoseEstimator::estimate(const vector<Point3f> &objectPoints, const vector<Point2f> &imagePoints,
+                             const Mat &cameraMatrix, const Mat &distCoeffs, Mat &rvec, Mat &tvec)
+{
+    if (objectPoints.size() < 4 || objectPoints.size() != imagePoints.size() || cameraMatrix.empty())
+    {
+        hasPrior = false;
+        poseStats.failures++;
+        return false;
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Mat pose;
+    lastWarm = false;
+    if (hasPrior)
+    {
+        pose = prior.clone();
+        error = refine(objectPoints, imagePoints, cameraMatrix, distCoeffs, pose);
+        if (error <= maxReprojectionError)
+        {
+            lastWarm = true;
+            poseStats.warmSolves++;
+            poseStats.warmIterations += iterations;
+            poseStats.warmMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        }
+        else
+        {
+            poseStats.rejectedWarm++;
+            start = chrono::steady_clock::now();
+        }
+    }
+
+    if (!lastWarm)
+    {
+        Mat coldRvec, coldTvec;
+        if (!solvePnP(objectPoints, imagePoints, cameraMatrix, distCoeffs, coldRvec, coldTvec, false, SOLVEPNP_IPPE))
+        {
+            hasPrior = false;
+            poseStats.failures++;
+            return false;
+        }
+        coldRvec.convertTo(coldRvec, CV_64F);
+        coldTvec.convertTo(coldTvec, CV_64F);
+        vconcat(coldRvec.reshape(1, 3), coldTvec.reshape(1, 3), pose);
+        error = refine(objectPoints, imagePoints, cameraMatrix, distCoeffs, pose);
+        poseStats.coldSolves++;
+        poseStats.coldIterations += iterations;
+        poseStats.coldMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    pose.copyTo(prior);
+    hasPrior = true;
+    pose.rowRange(0, 3).copyTo(rvec);
+    pose.rowRange(3, 6).copyTo(tvec);
+    return true;
+}
+
+bool PoseEstimator::estimateBoard(const Ptr<aruco::Board> &board, const vector<vector<Point2f>> &corners,
+                                  const vector<int> &ids, const Mat &cameraMatrix, const Mat &distCoeffs, Mat &rvec,
+                                  Mat &tvec)
+{
+    boardObjectPoints.clear();
+    boardImagePoints.clear();
+    if (!ids.empty())
+    {
+        board->matchImagePoints(corners, ids, boardObjectPoints, boardImagePoints);
+    }
+    return estimate(boardObjectPoints, boardImagePoints, cameraMatrix, distCoeffs, rvec, tvec);
+}
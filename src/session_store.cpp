@@ -0,0 +1,145 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Bounded per-session state: pose history ring buffer and session memory accounting
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "logger.h"
+#include "session_store.h"
+
+using namespace std;
+using namespace cv;
+
+// Constant-initialized, so views and histories can be tracked from other globals' constructors and destructors
+static atomic<long long> sessionBytes(0);
+static atomic<long long> sessionPeakBytes(0);
+
+void trackSessionMemory(long long deltaBytes)
+{
+    long long now = sessionBytes.fetch_add(deltaBytes) + deltaBytes;
+    long long peak = sessionPeakBytes.load();
+    while (now > peak && !sessionPeakBytes.compare_exchange_weak(peak, now))
+    {
+    }
+}
+
+long long sessionMemoryBytes()
+{
+    return sessionBytes.load();
+}
+
+long long sessionMemoryPeakBytes()
+{
+    return sessionPeakBytes.load();
+}
+
+long processPeakResidentKb()
+{
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+#ifdef __APPLE__
+        // Reported in bytes on macOS
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return -1;
+}
+
+void reportSessionMemory()
+{
+    ostringstream line;
+    line << "Session memory: " << sessionMemoryBytes() / 1024.0 << " KB held, high-water mark "
+         << sessionMemoryPeakBytes() / 1024.0 << " KB";
+    long residentKb = processPeakResidentKb();
+    if (residentKb >= 0)
+    {
+        line << ", process peak resident " << residentKb / 1024.0 << " MB";
+    }
+    LOG_INFO(line.str());
+}
+
+PoseHistory::PoseHistory(size_t capacity) : head(0), count(0), total(0), start(chrono::steady_clock::now())
+{
+    setCapacity(capacity);
+}
+
+PoseHistory::~PoseHistory()
+{
+    trackSessionMemory(-(long long)(records.size() * sizeof(PoseRecord)));
+}
+
+void PoseHistory::setCapacity(size_t capacity)
+{
+    capacity = max<size_t>(1, capacity);
+    trackSessionMemory((long long)capacity * sizeof(PoseRecord) - (long long)(records.size() * sizeof(PoseRecord)));
+    // Swap rather than resize so the old ring's memory is actually released
+    vector<PoseRecord>(capacity).swap(records);
+    head = 0;
+    count = 0;
+}
+
+bool PoseHistory::streamTo(const string &filename)
+{
+    if (stream.is_open())
+    {
+        stream.close();
+    }
+    stream.open(filename.c_str(), ios::out | ios::trunc);
+    if (!stream.is_open())
+    {
+        LOG_ERROR("Could not open pose log " << filename);
+        streamFile.clear();
+        return false;
+    }
+    streamFile = filename;
+    stream << "frame,time_ms,rx,ry,rz,tx,ty,tz\n" << setprecision(9);
+    return true;
+}
+
+void PoseHistory::push(long long frame, const Mat &rvec, const Mat &tvec)
+{
+    PoseRecord &record = records[head];
+    record.frame = frame;
+    record.timeMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    Mat r, t;
+    rvec.reshape(1, 3).convertTo(r, CV_64F);
+    tvec.reshape(1, 3).convertTo(t, CV_64F);
+    record.rvec = Vec3d(r.at<double>(0), r.at<double>(1), r.at<double>(2));
+    record.tvec = Vec3d(t.at<double>(0), t.at<double>(1), t.at<double>(2));
+
+    head = (head + 1) % records.size();
+    count = min(count + 1, records.size());
+    total++;
+
+    if (stream.is_open())
+    {
+        // The stream buffers internally; a line per frame is far below the disk's bandwidth
+        stream << record.frame << ',' << record.timeMs << ',' << record.rvec[0] << ',' << record.rvec[1] << ','
+               << record.rvec[2] << ',' << record.tvec[0] << ',' << record.tvec[1] << ',' << record.tvec[2] << '\n';
+    }
+}
+
+void PoseHistory::report() const
+{
+    ostringstream line;
+    line << "Pose history: " << total << " poses recorded, last " << count << " kept (capacity " << records.size()
+         << ", " << records.size() * sizeof(PoseRecord) / 1024.0 << " KB)";
+    if (!streamFile.empty())
+    {
+        line << ", full history in " << streamFile;
+    }
+    LOG_INFO(line.str());
+}
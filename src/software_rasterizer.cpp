@@ -0,0 +1,574 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Multithreaded tiled z-buffer software rasterizer for posed triangle meshes
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#include "logger.h"
+#include "obj_model.h"
+#include "software_rasterizer.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RASTERIZER_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+using namespace cv;
+
+// Tiles are square; one thread owns a tile's pixels and depth values while it is rasterized
+static const int tileSize = 64;
+
+// Vertices closer to the camera than this (in board units) drop their triangles
+static const float rasterNearPlane = 1.0f;
+
+// Projected coordinates beyond this are culled rather than fed into the float edge functions
+static const float rasterMaxCoordinate = 1e6f;
+
+// Headlight lighting: intensity = ambient + diffuse * cos(angle between the normal and the view ray)
+static const float ambientLight = 0.3f;
+static const float diffuseLight = 0.7f;
+
+/**
+ * @brief One row of a triangle inside a tile: the value of every plane at the first pixel and its step per pixel
+ */
+struct RasterSpan
+{
+    float w0, w1, w2;
+    float dw0, dw1, dw2;
+    float depth, dDepth;
+    float shade, dShade;
+};
+
+/**
+ * @brief Tests n pixels for coverage and depth. Covered pixels nearer than depth[i] update depth[i], get their
+ * intensity in shade[i] and covered[i] = 1; the rest get covered[i] = 0.
+ *
+ * @return number of covered pixels
+ */
+typedef int (*RasterSpanKernel)(const RasterSpan &span, int n, float *depth, float *shade, uchar *covered);
+
+/**
+ * @brief Scalar span test over pixels [begin, end). Every plane is evaluated as start + i * step, the same way the
+ * SIMD kernels do, so all kernels produce identical frames.
+ */
+static int spanRangeScalar(const RasterSpan &span, int begin, int end, float *depth, float *shade, uchar *covered)
+{
+    int count = 0;
+    for (int i = begin; i < end; i++)
+    {
+        float x = (float)i;
+        float w0 = span.w0 + x * span.dw0;
+        float w1 = span.w1 + x * span.dw1;
+        float w2 = span.w2 + x * span.dw2;
+        float z = span.depth + x * span.dDepth;
+        bool inside = w0 >= 0 && w1 >= 0 && w2 >= 0 && z > depth[i];
+        covered[i] = inside ? 1 : 0;
+        if (inside)
+        {
+            depth[i] = z;
+            shade[i] = span.shade + x * span.dShade;
+            count++;
+        }
+    }
+    return count;
+}
+
+static int spanScalar(const RasterSpan &span, int n, float *depth, float *shade, uchar *covered)
+{
+    return spanRangeScalar(span, 0, n, depth, shade, covered);
+}
+
+#ifdef RASTERIZER_X86
+
+//--------------------- SSE2 ---------------------//
+
+__attribute__((target("sse2"))) static int spanSse2(const RasterSpan &span, int n, float *depth, float *shade,
+                                                    uchar *covered)
+{
+    const __m128 lanes = _mm_setr_ps(0, 1, 2, 3);
+    const __m128 zero = _mm_setzero_ps();
+    int count = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 x = _mm_add_ps(_mm_set1_ps((float)i), lanes);
+        __m128 w0 = _mm_add_ps(_mm_set1_ps(span.w0), _mm_mul_ps(x, _mm_set1_ps(span.dw0)));
+        __m128 w1 = _mm_add_ps(_mm_set1_ps(span.w1), _mm_mul_ps(x, _mm_set1_ps(span.dw1)));
+        __m128 w2 = _mm_add_ps(_mm_set1_ps(span.w2), _mm_mul_ps(x, _mm_set1_ps(span.dw2)));
+        __m128 z = _mm_add_ps(_mm_set1_ps(span.depth), _mm_mul_ps(x, _mm_set1_ps(span.dDepth)));
+        __m128 current = _mm_loadu_ps(depth + i);
+
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)),
+                                   _mm_and_ps(_mm_cmpge_ps(w2, zero), _mm_cmpgt_ps(z, current)));
+        int mask = _mm_movemask_ps(inside);
+        covered[i] = mask & 1;
+        covered[i + 1] = (mask >> 1) & 1;
+        covered[i + 2] = (mask >> 2) & 1;
+        covered[i + 3] = (mask >> 3) & 1;
+        if (mask)
+        {
+            _mm_storeu_ps(depth + i, _mm_or_ps(_mm_and_ps(inside, z), _mm_andnot_ps(inside, current)));
+            _mm_storeu_ps(shade + i, _mm_add_ps(_mm_set1_ps(span.shade), _mm_mul_ps(x, _mm_set1_ps(span.dShade))));
+            count += __builtin_popcount(mask);
+        }
+    }
+    return count + spanRangeScalar(span, i, n, depth, shade, covered);
+}
+
+//--------------------- AVX2 ---------------------//
+
+__attribute__((target("avx2"))) static int spanAvx2(const RasterSpan &span, int n, float *depth, float *shade,
+                                                    uchar *covered)
+{
+    const __m256 lanes = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 zero = _mm256_setzero_ps();
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 x = _mm256_add_ps(_mm256_set1_ps((float)i), lanes);
+        __m256 w0 = _mm256_add_ps(_mm256_set1_ps(span.w0), _mm256_mul_ps(x, _mm256_set1_ps(span.dw0)));
+        __m256 w1 = _mm256_add_ps(_mm256_set1_ps(span.w1), _mm256_mul_ps(x, _mm256_set1_ps(span.dw1)));
+        __m256 w2 = _mm256_add_ps(_mm256_set1_ps(span.w2), _mm256_mul_ps(x, _mm256_set1_ps(span.dw2)));
+        __m256 z = _mm256_add_ps(_mm256_set1_ps(span.depth), _mm256_mul_ps(x, _mm256_set1_ps(span.dDepth)));
+        __m256 current = _mm256_loadu_ps(depth + i);
+
+        __m256 inside =
+            _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(w0, zero, _CMP_GE_OQ), _mm256_cmp_ps(w1, zero, _CMP_GE_OQ)),
+                          _mm256_and_ps(_mm256_cmp_ps(w2, zero, _CMP_GE_OQ), _mm256_cmp_ps(z, current, _CMP_GT_OQ)));
+        int mask = _mm256_movemask_ps(inside);
+        for (int lane = 0; lane < 8; lane++)
+        {
+            covered[i + lane] = (mask >> lane) & 1;
+        }
+        if (mask)
+        {
+            _mm256_storeu_ps(depth + i, _mm256_blendv_ps(current, z, inside));
+            _mm256_storeu_ps(shade + i,
+                             _mm256_add_ps(_mm256_set1_ps(span.shade), _mm256_mul_ps(x, _mm256_set1_ps(span.dShade))));
+            count += __builtin_popcount(mask);
+        }
+    }
+    return count + spanRangeScalar(span, i, n, depth, shade, covered);
+}
+
+#endif
+
+//--------------------- Dispatch ---------------------//
+
+/**
+ * @brief Picks the span kernel for the requested instruction set, falling back to what the CPU supports
+ */
+static RasterSpanKernel selectSpanKernel(RasterizerIsa isa, const char **name = 0)
+{
+#ifdef RASTERIZER_X86
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    static const bool hasSse2 = __builtin_cpu_supports("sse2");
+    if ((isa == RASTER_ISA_AUTO || isa == RASTER_ISA_AVX2) && hasAvx2)
+    {
+        if (name)
+        {
+            *name = "avx2";
+        }
+        return spanAvx2;
+    }
+    if ((isa == RASTER_ISA_AUTO || isa == RASTER_ISA_AVX2 || isa == RASTER_ISA_SSE2) && hasSse2)
+    {
+        if (name)
+        {
+            *name = "sse2";
+        }
+        return spanSse2;
+    }
+#else
+    (void)isa;
+#endif
+    if (name)
+    {
+        *name = "scalar";
+    }
+    return spanScalar;
+}
+
+const char *SoftwareRasterizer::isaName(RasterizerIsa isa)
+{
+    const char *name = "scalar";
+    selectSpanKernel(isa, &name);
+    return name;
+}
+
+/**
+ * @brief Prints how many triangles were drawn and culled and what setup and rasterization cost
+ */
+void RasterizerStats::report() const
+{
+    LOG_INFO("Rasterizer: " << triangles << " triangles over " << frames << " draw calls, " << culledTriangles
+             << " culled (" << (triangles > 0 ? culledTriangles * 100.0 / triangles : 0.0) << "%), "
+             << binnedTriangles << " triangle/tile pairs");
+    LOG_INFO("Mean cost per draw: setup " << (frames > 0 ? setupMs / frames : 0.0) << " ms, rasterization "
+             << (frames > 0 ? rasterMs / frames : 0.0) << " ms");
+}
+
+SoftwareRasterizer::SoftwareRasterizer(RasterizerIsa isa) : isa(isa), tilesX(0), tilesY(0)
+{
+}
+
+void SoftwareRasterizer::beginFrame(const Size &frameSize)
+{
+    depthBuffer.create(frameSize, CV_32F);
+    // Depth holds 1/z, so 0 is infinitely far away
+    depthBuffer.setTo(Scalar::all(0));
+    tilesX = (frameSize.width + tileSize - 1) / tileSize;
+    tilesY = (frameSize.height + tileSize - 1) / tileSize;
+    bins.resize(tilesX * tilesY);
+}
+
+/**
+ * @brief Headlight intensity of a surface point with unit normal n at camera-space position p
+ */
+static float headlightIntensity(const Point3f &n, const Point3f &p)
+{
+    float distance = (float)norm(p);
+    float facing = distance > 0 ? -n.dot(p) / distance : 0;
+    return ambientLight + diffuseLight * max(0.0f, facing);
+}
+
+bool SoftwareRasterizer::setupTriangle(int a, int b, int c, RasterShading shading, const Rect &imageRect,
+                                       Setup &setup) const
+{
+    int index[3] = {a, b, c};
+    float minX = rasterMaxCoordinate, minY = rasterMaxCoordinate;
+    float maxX = -rasterMaxCoordinate, maxY = -rasterMaxCoordinate;
+    for (int v = 0; v < 3; v++)
+    {
+        const Point2f &point = projectedPoints[index[v]];
+        if (cameraPoints[index[v]].z < rasterNearPlane ||
+            !(fabs(point.x) < rasterMaxCoordinate && fabs(point.y) < rasterMaxCoordinate))
+        {
+            return false;
+        }
+        minX = min(minX, point.x);
+        minY = min(minY, point.y);
+        maxX = max(maxX, point.x);
+        maxY = max(maxY, point.y);
+    }
+
+    // The camera sits at the origin, so a triangle faces it when its normal points back along the view ray
+    const Point3f &pa = cameraPoints[a];
+    Point3f normal = (cameraPoints[b] - pa).cross(cameraPoints[c] - pa);
+    if (normal.dot(pa) >= 0)
+    {
+        return false;
+    }
+
+    setup.minX = max(imageRect.x, cvCeil(minX));
+    setup.minY = max(imageRect.y, cvCeil(minY));
+    setup.maxX = min(imageRect.x + imageRect.width - 1, cvFloor(maxX));
+    setup.maxY = min(imageRect.y + imageRect.height - 1, cvFloor(maxY));
+    if (setup.minX > setup.maxX || setup.minY > setup.maxY)
+    {
+        return false;
+    }
+
+    // Planes are evaluated relative to the bounding box corner to keep the float edge functions precise
+    setup.originX = (float)setup.minX;
+    setup.originY = (float)setup.minY;
+    Point2f p[3];
+    for (int v = 0; v < 3; v++)
+    {
+        p[v] = projectedPoints[index[v]] - Point2f(setup.originX, setup.originY);
+    }
+    float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x);
+    if (fabs(area) < 1e-6f)
+    {
+        return false;
+    }
+    // Wind the triangle so that all edge functions are positive inside
+    if (area < 0)
+    {
+        swap(index[1], index[2]);
+        swap(p[1], p[2]);
+        area = -area;
+    }
+
+    // Edge i is opposite vertex i; E(x, y) = (q - s) x ((x, y) - s) for the edge from s to q
+    for (int e = 0; e < 3; e++)
+    {
+        const Point2f &from = p[(e + 1) % 3];
+        const Point2f &to = p[(e + 2) % 3];
+        setup.edgeA[e] = -(to.y - from.y);
+        setup.edgeB[e] = to.x - from.x;
+        setup.edgeC[e] = (to.y - from.y) * from.x - (to.x - from.x) * from.y;
+    }
+
+    float depth[3], shade[3];
+    float flatShade = 0;
+    if (shading == SHADING_FLAT || vertexShade.empty())
+    {
+        float length = (float)norm(normal);
+        Point3f centroid = (pa + cameraPoints[b] + cameraPoints[c]) * (1.0f / 3);
+        flatShade = headlightIntensity(length > 0 ? normal * (1.0f / length) : Point3f(0, 0, -1), centroid);
+    }
+    for (int v = 0; v < 3; v++)
+    {
+        depth[v] = 1.0f / cameraPoints[index[v]].z;
+        shade[v] = (shading == SHADING_FLAT || vertexShade.empty()) ? flatShade : vertexShade[index[v]];
+    }
+
+    // An attribute f interpolates as (E0 * f0 + E1 * f1 + E2 * f2) / area, which is again a plane
+    float inverseArea = 1.0f / area;
+    setup.depthA = (setup.edgeA[0] * depth[0] + setup.edgeA[1] * depth[1] + setup.edgeA[2] * depth[2]) * inverseArea;
+    setup.depthB = (setup.edgeB[0] * depth[0] + setup.edgeB[1] * depth[1] + setup.edgeB[2] * depth[2]) * inverseArea;
+    setup.depthC = (setup.edgeC[0] * depth[0] + setup.edgeC[1] * depth[1] + setup.edgeC[2] * depth[2]) * inverseArea;
+    setup.shadeA = (setup.edgeA[0] * shade[0] + setup.edgeA[1] * shade[1] + setup.edgeA[2] * shade[2]) * inverseArea;
+    setup.shadeB = (setup.edgeB[0] * shade[0] + setup.edgeB[1] * shade[1] + setup.edgeB[2] * shade[2]) * inverseArea;
+    setup.shadeC = (setup.edgeC[0] * shade[0] + setup.edgeC[1] * shade[1] + setup.edgeC[2] * shade[2]) * inverseArea;
+    return true;
+}
+
+void SoftwareRasterizer::rasterizeTile(int tile, Mat &image, const Vec3f &color)
+{
+    RasterSpanKernel kernel = selectSpanKernel(isa);
+    int tileX0 = (tile % tilesX) * tileSize;
+    int tileY0 = (tile / tilesX) * tileSize;
+    int tileX1 = min(tileX0 + tileSize, image.cols) - 1;
+    int tileY1 = min(tileY0 + tileSize, image.rows) - 1;
+
+    float shade[tileSize];
+    uchar covered[tileSize];
+    const vector<int> &bin = bins[tile];
+    for (size_t t = 0; t < bin.size(); t++)
+    {
+        const Setup &setup = setups[bin[t]];
+        int left = max(setup.minX, tileX0), right = min(setup.maxX, tileX1);
+        int top = max(setup.minY, tileY0), bottom = min(setup.maxY, tileY1);
+        int n = right - left + 1;
+        float dx = left - setup.originX;
+        for (int y = top; y <= bottom; y++)
+        {
+            float dy = y - setup.originY;
+            RasterSpan span;
+            span.w0 = setup.edgeA[0] * dx + setup.edgeB[0] * dy + setup.edgeC[0];
+            span.w1 = setup.edgeA[1] * dx + setup.edgeB[1] * dy + setup.edgeC[1];
+            span.w2 = setup.edgeA[2] * dx + setup.edgeB[2] * dy + setup.edgeC[2];
+            span.dw0 = setup.edgeA[0];
+            span.dw1 = setup.edgeA[1];
+            span.dw2 = setup.edgeA[2];
+            span.depth = setup.depthA * dx + setup.depthB * dy + setup.depthC;
+            span.dDepth = setup.depthA;
+            span.shade = setup.shadeA * dx + setup.shadeB * dy + setup.shadeC;
+            span.dShade = setup.shadeA;
+
+            if (kernel(span, n, depthBuffer.ptr<float>(y) + left, shade, covered) == 0)
+            {
+                continue;
+            }
+            Vec3b *pixels = image.ptr<Vec3b>(y) + left;
+            for (int i = 0; i < n; i++)
+            {
+                if (covered[i])
+                {
+                    pixels[i] = Vec3b(saturate_cast<uchar>(color[0] * shade[i]),
+                                      saturate_cast<uchar>(color[1] * shade[i]),
+                                      saturate_cast<uchar>(color[2] * shade[i]));
+                }
+            }
+        }
+    }
+}
+
+int SoftwareRasterizer::draw(Mat &image, const ObjModel &model, const Mat &rvec, const Mat &tvec,
+                             const Mat &cameraMatrix, const Mat &distCoeffs, const Scalar &color, RasterShading shading)
+{
+    CV_Assert(image.type() == CV_8UC3);
+    if (depthBuffer.size() != image.size())
+    {
+        beginFrame(image.size());
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    Mat rotationMat, translationMat;
+    Rodrigues(rvec, rotationMat);
+    rotationMat.convertTo(rotationMat, CV_32F);
+    tvec.reshape(1, 3).convertTo(translationMat, CV_32F);
+    Matx33f rotation((const float *)rotationMat.data);
+    Vec3f translation(translationMat.at<float>(0), translationMat.at<float>(1), translationMat.at<float>(2));
+
+    size_t vertexCount = model.vertices.size();
+    cameraPoints.resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        Vec3f moved = rotation * Vec3f(model.vertices[i].x, model.vertices[i].y, model.vertices[i].z) + translation;
+        cameraPoints[i] = Point3f(moved[0], moved[1], moved[2]);
+    }
+    if (vertexCount == 0)
+    {
+        return 0;
+    }
+    // One call for the whole mesh: the points are already in camera space
+    projectPoints(cameraPoints, Vec3d(0, 0, 0), Vec3d(0, 0, 0), cameraMatrix, distCoeffs, projectedPoints);
+
+    vertexShade.clear();
+    if (shading == SHADING_GOURAUD && model.normals.size() == vertexCount)
+    {
+        vertexShade.resize(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            Vec3f n = rotation * Vec3f(model.normals[i].x, model.normals[i].y, model.normals[i].z);
+            vertexShade[i] = headlightIntensity(Point3f(n[0], n[1], n[2]), cameraPoints[i]);
+        }
+    }
+
+    for (size_t i = 0; i < bins.size(); i++)
+    {
+        bins[i].clear();
+    }
+    setups.clear();
+    Rect imageRect(0, 0, image.cols, image.rows);
+    long long binned = 0;
+    for (size_t t = 0; t < model.triangles.size(); t++)
+    {
+        const Vec3i &triangle = model.triangles[t];
+        Setup setup;
+        if (!setupTriangle(triangle[0], triangle[1], triangle[2], shading, imageRect, setup))
+        {
+            continue;
+        }
+        int index = (int)setups.size();
+        setups.push_back(setup);
+        for (int ty = setup.minY / tileSize; ty <= setup.maxY / tileSize; ty++)
+        {
+            for (int tx = setup.minX / tileSize; tx <= setup.maxX / tileSize; tx++)
+            {
+                bins[ty * tilesX + tx].push_back(index);
+                binned++;
+            }
+        }
+    }
+    activeTiles.clear();
+    for (size_t i = 0; i < bins.size(); i++)
+    {
+        if (!bins[i].empty())
+        {
+            activeTiles.push_back((int)i);
+        }
+    }
+    rasterStats.setupMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    Vec3f baseColor((float)color[0], (float)color[1], (float)color[2]);
+    parallel_for_(Range(0, (int)activeTiles.size()), [&](const Range &range) {
+        for (int i = range.start; i < range.end; i++)
+        {
+            rasterizeTile(activeTiles[i], image, baseColor);
+        }
+    });
+    rasterStats.rasterMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    rasterStats.frames++;
+    rasterStats.triangles += model.triangles.size();
+    rasterStats.culledTriangles += model.triangles.size() - setups.size();
+    rasterStats.binnedTriangles += binned;
+    return (int)setups.size();
+}
+
+/**
+ * @brief Renders frames of a slowly turning model and returns the mean time per frame
+ *
+ * @param output last rendered frame
+ */
+static double timeRasterizer(SoftwareRasterizer &rasterizer, const ObjModel &model, const Mat &background,
+                             const Mat &cameraMatrix, RasterShading shading, int frames, Mat &output)
+{
+    double totalMs = 0;
+    for (int f = 0; f < frames; f++)
+    {
+        background.copyTo(output);
+        Mat rvec = (Mat_<double>(3, 1) << 0.5 + 0.2 * sin(f * 0.05), 0.02 * f, 0);
+        Mat tvec = (Mat_<double>(3, 1) << 0, 0, 400);
+        int64 start = getTickCount();
+        rasterizer.beginFrame(output.size());
+        rasterizer.draw(output, model, rvec, tvec, cameraMatrix, Mat(), Scalar(80, 180, 255), shading);
+        totalMs += (getTickCount() - start) * 1000.0 / getTickFrequency();
+    }
+    return totalMs / max(1, frames);
+}
+
+int benchmarkRasterizer(string modelFile, int frames)
+{
+    ObjModel model;
+    if (modelFile.empty())
+    {
+        model = makeSphereModel(60, 72, 73);
+    }
+    else
+    {
+        if (!loadObjModel(modelFile, model))
+        {
+            return -1;
+        }
+        placeObjModel(model, 120, Point2f(0, 0));
+    }
+    frames = max(1, frames);
+
+    Size frameSize(1920, 1080);
+    Mat background(frameSize, CV_8UC3, Scalar(60, 60, 60));
+    Mat cameraMatrix = (Mat_<double>(3, 3) << 1400, 0, frameSize.width / 2.0, 0, 1400, frameSize.height / 2.0, 0, 0,
+                        1);
+    const int threads = getNumThreads();
+    const RasterizerIsa isas[2] = {RASTER_ISA_SCALAR, RASTER_ISA_AUTO};
+    const RasterShading shadings[2] = {SHADING_FLAT, SHADING_GOURAUD};
+
+    LOG_INFO("Benchmarking the rasterizer on " << frameSize.width << "x" << frameSize.height << ", "
+             << model.triangles.size() << " triangles, " << frames << " frames per configuration");
+    LOG_INFO("shading\tisa\tthreads\tmean_ms\tfps");
+
+    int status = 0;
+    for (int s = 0; s < 2; s++)
+    {
+        Mat reference;
+        for (int i = 0; i < 2; i++)
+        {
+            SoftwareRasterizer rasterizer(isas[i]);
+            for (int run = 0; run < 2; run++)
+            {
+                int runThreads = run == 0 ? 1 : threads;
+                setNumThreads(runThreads);
+                Mat output;
+                double meanMs =
+                    timeRasterizer(rasterizer, model, background, cameraMatrix, shadings[s], frames, output);
+                LOG_INFO((shadings[s] == SHADING_FLAT ? "flat" : "gouraud") << "\t"
+                         << SoftwareRasterizer::isaName(isas[i]) << "\t" << runThreads << "\t" << meanMs << "\t"
+                         << 1000.0 / meanMs);
+
+                // Same pose and shading, so every kernel and thread count must produce the same frame
+                if (reference.empty())
+                {
+                    reference = output;
+                }
+                else
+                {
+                    Mat difference;
+                    absdiff(reference, output, difference);
+                    int differing = countNonZero(difference.reshape(1));
+                    if (differing > 0)
+                    {
+                        LOG_INFO("  mismatch: " << differing << " channel values differ from the scalar frame");
+                        status = 1;
+                    }
+                }
+            }
+            if (s == 1 && i == 1)
+            {
+                rasterizer.stats().report();
+            }
+        }
+    }
+    setNumThreads(threads);
+    return status;
+}
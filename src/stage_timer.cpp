@@ -0,0 +1,266 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Per-stage latency histograms for the stream loops (--stats)
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#include "logger.h"
+#include "stage_timer.h"
+
+using namespace std;
+
+bool stageTimingEnabled = false;
+
+// Buckets 0-7 hold 0-7 us exactly; above that every power of two is split into 8 buckets, up to 2^35 us
+static const int stageSubBuckets = 8;
+static const int stageBuckets = 34 * stageSubBuckets;
+
+/**
+ * @brief The histograms of one thread. Only the owning thread writes, with plain relaxed loads and stores; the
+ * atomics are there so the reporting thread may read them at any time.
+ */
+struct ThreadStageTimes
+{
+    atomic<long long> counts[STAGE_COUNT][stageBuckets];
+    atomic<long long> totalNs[STAGE_COUNT];
+    atomic<long long> maxNs[STAGE_COUNT];
+
+    ThreadStageTimes()
+    {
+        for (int s = 0; s < STAGE_COUNT; s++)
+        {
+            for (int b = 0; b < stageBuckets; b++)
+            {
+                counts[s][b].store(0, memory_order_relaxed);
+            }
+            totalNs[s].store(0, memory_order_relaxed);
+            maxNs[s].store(0, memory_order_relaxed);
+        }
+    }
+};
+
+// Histograms outlive their threads so the pipeline's workers can be reported after they are joined
+static mutex stageRegistryLock;
+static vector<unique_ptr<ThreadStageTimes>> stageRegistry;
+static thread_local ThreadStageTimes *threadStageTimes = 0;
+
+const char *stageName(Stage stage)
+{
+    static const char *names[STAGE_COUNT] = {"capture", "undistort", "gray",    "detect", "track", "subpix",
+                                             "pose",    "draw",      "display", "write",  "frame"};
+    return stage >= 0 && stage < STAGE_COUNT ? names[stage] : "unknown";
+}
+
+void setStageTiming(bool enabled)
+{
+    stageTimingEnabled = enabled;
+}
+
+/**
+ * @brief Log-linear bucket of a duration in microseconds
+ */
+static int stageBucket(unsigned long long micros)
+{
+    if (micros < (unsigned long long)stageSubBuckets)
+    {
+        return (int)micros;
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    int exponent = 63 - __builtin_clzll(micros);
+#else
+    int exponent = 0;
+    while (micros >> (exponent + 1))
+    {
+        exponent++;
+    }
+#endif
+    int bucket = (exponent - 2) * stageSubBuckets + (int)((micros >> (exponent - 3)) & (stageSubBuckets - 1));
+    return min(bucket, stageBuckets - 1);
+}
+
+/**
+ * @brief Middle of a bucket in microseconds
+ */
+static double stageBucketMicros(int bucket)
+{
+    if (bucket < stageSubBuckets)
+    {
+        return bucket;
+    }
+    int exponent = bucket / stageSubBuckets + 2;
+    double width = (double)(1ULL << (exponent - 3));
+    return (stageSubBuckets + bucket % stageSubBuckets) * width + width / 2;
+}
+
+/**
+ * @brief Quantile q of a bucket histogram in milliseconds, capped at the largest sample
+ */
+static double bucketQuantileMs(const long long *counts, long long samples, double q, double maxMs)
+{
+    long long rank = max(1LL, (long long)(q * samples + 0.999999));
+    long long seen = 0;
+    int b = 0;
+    while (b < stageBuckets - 1 && seen + counts[b] < rank)
+    {
+        seen += counts[b++];
+    }
+    // The bucket middle can lie above the largest sample in it
+    return min(stageBucketMicros(b) / 1000.0, maxMs);
+}
+
+LatencyHistogram::LatencyHistogram() : counts(stageBuckets, 0), sampleCount(0), totalNs(0), largestNs(0)
+{
+}
+
+void LatencyHistogram::record(long long nanoseconds)
+{
+    nanoseconds = max(0LL, nanoseconds);
+    counts[stageBucket((unsigned long long)nanoseconds / 1000)]++;
+    sampleCount++;
+    totalNs += nanoseconds;
+    largestNs = max(largestNs, nanoseconds);
+}
+
+double LatencyHistogram::quantileMs(double q) const
+{
+    return sampleCount > 0 ? bucketQuantileMs(&counts[0], sampleCount, q, maxMs()) : 0.0;
+}
+
+void recordStageTime(Stage stage, long long nanoseconds)
+{
+    if (stage < 0 || stage >= STAGE_COUNT)
+    {
+        return;
+    }
+    ThreadStageTimes *times = threadStageTimes;
+    if (!times)
+    {
+        times = new ThreadStageTimes();
+        lock_guard<mutex> guard(stageRegistryLock);
+        stageRegistry.push_back(unique_ptr<ThreadStageTimes>(times));
+        threadStageTimes = times;
+    }
+
+    nanoseconds = max(0LL, nanoseconds);
+    atomic<long long> &count = times->counts[stage][stageBucket((unsigned long long)nanoseconds / 1000)];
+    count.store(count.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    times->totalNs[stage].store(times->totalNs[stage].load(memory_order_relaxed) + nanoseconds, memory_order_relaxed);
+    if (nanoseconds > times->maxNs[stage].load(memory_order_relaxed))
+    {
+        times->maxNs[stage].store(nanoseconds, memory_order_relaxed);
+    }
+}
+
+vector<StageSummary> summarizeStageTimes()
+{
+    vector<StageSummary> summaries;
+    lock_guard<mutex> guard(stageRegistryLock);
+    vector<long long> merged(stageBuckets);
+    for (int s = 0; s < STAGE_COUNT; s++)
+    {
+        fill(merged.begin(), merged.end(), 0LL);
+        long long samples = 0, totalNs = 0, maxNs = 0;
+        for (size_t t = 0; t < stageRegistry.size(); t++)
+        {
+            const ThreadStageTimes &times = *stageRegistry[t];
+            for (int b = 0; b < stageBuckets; b++)
+            {
+                long long count = times.counts[s][b].load(memory_order_relaxed);
+                merged[b] += count;
+                samples += count;
+            }
+            totalNs += times.totalNs[s].load(memory_order_relaxed);
+            maxNs = max(maxNs, times.maxNs[s].load(memory_order_relaxed));
+        }
+        if (samples == 0)
+        {
+            continue;
+        }
+
+        StageSummary summary;
+        summary.stage = (Stage)s;
+        summary.samples = samples;
+        summary.meanMs = totalNs / 1e6 / samples;
+        summary.maxMs = maxNs / 1e6;
+        const double quantiles[3] = {0.50, 0.95, 0.99};
+        double *targets[3] = {&summary.p50Ms, &summary.p95Ms, &summary.p99Ms};
+        for (int q = 0; q < 3; q++)
+        {
+            *targets[q] = bucketQuantileMs(&merged[0], samples, quantiles[q], summary.maxMs);
+        }
+        summaries.push_back(summary);
+    }
+    return summaries;
+}
+
+void reportStageTimes(const string &label)
+{
+    vector<StageSummary> summaries = summarizeStageTimes();
+    LOG_INFO(label << " stage times (ms):");
+    LOG_INFO("  " << left << setw(10) << "stage" << right << setw(9) << "samples" << setw(9) << "mean" << setw(9)
+             << "p50" << setw(9) << "p95" << setw(9) << "p99" << setw(9) << "max");
+    for (size_t i = 0; i < summaries.size(); i++)
+    {
+        const StageSummary &s = summaries[i];
+        LOG_INFO("  " << left << setw(10) << stageName(s.stage) << right << setw(9) << s.samples << fixed
+                 << setprecision(3) << setw(9) << s.meanMs << setw(9) << s.p50Ms << setw(9) << s.p95Ms << setw(9)
+                 << s.p99Ms << setw(9) << s.maxMs);
+    }
+}
+
+bool writeStageTimes(const string &filename, const string &label)
+{
+    ofstream file(filename.c_str());
+    if (!file.is_open())
+    {
+        LOG_ERROR("Could not write stage times to " << filename);
+        return false;
+    }
+
+    vector<StageSummary> summaries = summarizeStageTimes();
+    bool json = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".json") == 0;
+    file << fixed << setprecision(4);
+    if (json)
+    {
+        file << "{\n  \"label\": \"" << label << "\",\n  \"stages\": [";
+        for (size_t i = 0; i < summaries.size(); i++)
+        {
+            const StageSummary &s = summaries[i];
+            file << (i ? "," : "") << "\n    {\"stage\": \"" << stageName(s.stage) << "\", \"samples\": " << s.samples
+                 << ", \"mean_ms\": " << s.meanMs << ", \"p50_ms\": " << s.p50Ms << ", \"p95_ms\": " << s.p95Ms
+                 << ", \"p99_ms\": " << s.p99Ms << ", \"max_ms\": " << s.maxMs << "}";
+        }
+        file << "\n  ]\n}\n";
+    }
+    else
+    {
+        file << "stage,samples,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+        for (size_t i = 0; i < summaries.size(); i++)
+        {
+            const StageSummary &s = summaries[i];
+            file << stageName(s.stage) << "," << s.samples << "," << s.meanMs << "," << s.p50Ms << "," << s.p95Ms
+                 << "," << s.p99Ms << "," << s.maxMs << "\n";
+        }
+    }
+    LOG_INFO("Stage times written to " << filename);
+    return true;
+}
+
+void finishStageTimes(const string &label, const string &statsFile)
+{
+    if (!stageTimingEnabled)
+    {
+        return;
+    }
+    reportStageTimes(label);
+    if (!statsFile.empty())
+    {
+        writeStageTimes(statsFile, label);
+    }
+}
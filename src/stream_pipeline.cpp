@@ -0,0 +1,205 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Multi-threaded capture -> detect -> render pipeline for the stream loops
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <thread>
+
+#include "logger.h"
+#include "ring_buffer.h"
+#include "stage_timer.h"
+#include "stream_pipeline.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief Prints the pipeline counters and latency summary
+ *
+ * @param label name of the stream
+ */
+void PipelineStats::report(const string &label) const
+{
+    double fps = elapsedSeconds > 0 ? processed / elapsedSeconds : 0.0;
+    LOG_INFO(label << ": " << processed << " frames in " << elapsedSeconds << " s (" << fps << " fps), captured "
+             << captured << ", dropped " << dropped);
+    LOG_INFO("Latency (capture -> render): mean " << meanLatencyMs << " ms, p95 " << p95LatencyMs << " ms, max "
+             << maxLatencyMs << " ms");
+}
+
+/**
+ * @brief Backs off a spinning stage without giving up the core for long
+ *
+ * @param idleRounds number of consecutive rounds without work
+ */
+static void backOff(int idleRounds)
+{
+    if (idleRounds < 64)
+    {
+        this_thread::yield();
+    }
+    else
+    {
+        this_thread::sleep_for(chrono::microseconds(200));
+    }
+}
+
+/**
+ * @brief Pushes a frame into the render queue, waiting for room. Results are never dropped here, only raw frames.
+ */
+static void pushResult(RingBuffer<PipelineFrame> &results, PipelineFrame &frame)
+{
+    int idleRounds = 0;
+    while (!results.tryPush(frame))
+    {
+        backOff(idleRounds++);
+    }
+}
+
+PipelineStats runStreamPipeline(FrameSource &source, int workers, size_t queueCapacity, int maxFrames,
+                                const DetectStage &detect, const RenderStage &render)
+{
+    workers = max(1, workers);
+    queueCapacity = max((size_t)2, queueCapacity);
+
+    RingBuffer<PipelineFrame> pending(queueCapacity);
+    // Large enough to hold every frame that can be in flight, so capture never waits on render for a drop marker
+    RingBuffer<PipelineFrame> results(queueCapacity * 2 + workers * 2);
+
+    atomic<bool> stopRequested(false);
+    atomic<bool> captureFinished(false);
+    atomic<long long> totalCaptured(0);
+    atomic<long long> droppedFrames(0);
+    atomic<int> activeWorkers(workers);
+
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+    // Capture stage: reads as fast as the source delivers and evicts the oldest queued frame when workers fall behind
+    thread captureThread([&]() {
+        long long sequence = 0;
+        while (!stopRequested.load(memory_order_relaxed) && (maxFrames <= 0 || sequence < maxFrames))
+        {
+            PipelineFrame frame;
+            ScopedStageTimer captureTimer(STAGE_CAPTURE);
+            if (!source.read(frame.image))
+            {
+                break;
+            }
+            captureTimer.stop();
+            frame.sequence = sequence++;
+            frame.captureTime = chrono::steady_clock::now();
+
+            while (!pending.tryPush(frame))
+            {
+                PipelineFrame stale;
+                if (pending.tryPop(stale))
+                {
+                    stale.dropped = true;
+                    stale.image.release();
+                    droppedFrames++;
+                    pushResult(results, stale);
+                }
+            }
+            totalCaptured.store(sequence, memory_order_release);
+        }
+        captureFinished.store(true, memory_order_release);
+    });
+
+    // Detection stage
+    vector<thread> workerThreads;
+    for (int w = 0; w < workers; w++)
+    {
+        workerThreads.push_back(thread([&, w]() {
+            int idleRounds = 0;
+            PipelineFrame frame;
+            while (true)
+            {
+                if (pending.tryPop(frame))
+                {
+                    idleRounds = 0;
+                    detect(w, frame);
+                    pushResult(results, frame);
+                }
+                else if (captureFinished.load(memory_order_acquire) && pending.size() == 0)
+                {
+                    break;
+                }
+                else
+                {
+                    backOff(idleRounds++);
+                }
+            }
+            activeWorkers--;
+        }));
+    }
+
+    // Render stage: reorders results by sequence number so frames come out in capture order
+    map<long long, PipelineFrame> reorder;
+    // Fixed-size, so a stream that runs for days does not grow with every rendered frame
+    LatencyHistogram latencies;
+    long long nextSequence = 0;
+    int idleRounds = 0;
+    bool keepRendering = true;
+    PipelineStats stats;
+
+    while (true)
+    {
+        PipelineFrame frame;
+        bool gotResult = results.tryPop(frame);
+        if (gotResult)
+        {
+            idleRounds = 0;
+            long long sequence = frame.sequence;
+            reorder[sequence] = frame;
+        }
+
+        while (!reorder.empty() && reorder.begin()->first == nextSequence)
+        {
+            PipelineFrame &ready = reorder.begin()->second;
+            if (!ready.dropped && keepRendering)
+            {
+                long long latencyNs =
+                    chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - ready.captureTime)
+                        .count();
+                latencies.record(latencyNs);
+                double latencyMs = latencyNs / 1e6;
+                stats.processed++;
+                if (!render(ready, latencyMs))
+                {
+                    keepRendering = false;
+                    stopRequested.store(true, memory_order_relaxed);
+                }
+            }
+            reorder.erase(reorder.begin());
+            nextSequence++;
+        }
+
+        bool everythingRendered = captureFinished.load(memory_order_acquire) &&
+                                  nextSequence >= totalCaptured.load(memory_order_acquire);
+        if (everythingRendered)
+        {
+            break;
+        }
+        if (!gotResult)
+        {
+            backOff(idleRounds++);
+        }
+    }
+
+    captureThread.join();
+    for (size_t i = 0; i < workerThreads.size(); i++)
+    {
+        workerThreads[i].join();
+    }
+
+    stats.elapsedSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    stats.captured = totalCaptured.load();
+    stats.dropped = droppedFrames.load();
+    stats.meanLatencyMs = latencies.meanMs();
+    stats.p95LatencyMs = latencies.quantileMs(0.95);
+    stats.maxLatencyMs = latencies.maxMs();
+    return stats;
+}
@@ -0,0 +1,329 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Per-stream detection sessions and the multi-stream mode that runs many of them on one thread pool
+
+#include <algorithm>
+#include <csignal>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+
+#include "calibration_file.h"
+#include "detector_tuning.h"
+#include "logger.h"
+#include "stage_timer.h"
+#include "stream_session.h"
+#include "thread_pool.h"
+
+using namespace std;
+using namespace cv;
+
+void StreamSessionStats::report(const string &label, double elapsedSeconds) const
+{
+    ostringstream line;
+    line << label << ": " << frames << " frames in " << elapsedSeconds << " s ("
+         << (elapsedSeconds > 0 ? frames / elapsedSeconds : 0.0) << " fps), " << detectedFrames << " detected, "
+         << posedFrames << " with a pose";
+    if (latency.samples() > 0)
+    {
+        line << ", latency mean " << latency.meanMs() << " ms, p95 " << latency.quantileMs(0.95) << " ms, max "
+             << latency.maxMs() << " ms";
+    }
+    LOG_INFO(line.str());
+}
+
+StreamSession::StreamSession(const Ptr<FrameSource> &source, const Mat &cameraMatrix, const Mat &distCoeffs,
+                             const StreamOptions &options)
+    : source(source), poses(options.poseHistory > 0 ? options.poseHistory : defaultPoseHistoryCapacity),
+      cameraMatrix(cameraMatrix.clone()), distCoeffs(distCoeffs.clone()),
+      undistort(options.undistort && !cameraMatrix.empty()), maxFrames(options.maxFrames)
+{
+}
+
+bool StreamSession::processNextFrame()
+{
+    if (maxFrames > 0 && sessionStats.frames >= maxFrames)
+    {
+        return false;
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    ScopedStageTimer frameTimer(STAGE_FRAME);
+    ScopedStageTimer captureTimer(STAGE_CAPTURE);
+    if (!source->read(frame))
+    {
+        return false;
+    }
+    captureTimer.stop();
+
+    if (undistort)
+    {
+        // Sessions share the calibration but not the cache file, so the maps are built in memory
+        if (!undistortMaps || !undistortMaps->matches(cameraMatrix, distCoeffs, frame.size()))
+        {
+            undistortMaps = loadOrBuildUndistortMaps(cameraMatrix, distCoeffs, frame.size(), "");
+        }
+        ScopedStageTimer undistortTimer(STAGE_UNDISTORT);
+        undistortMaps->apply(frame, undistorted);
+        swap(frame, undistorted);
+    }
+
+    context.reset(frame);
+    ScopedStageTimer detectTimer(STAGE_DETECT);
+    bool detected = detect(context);
+    detectTimer.stop();
+    sessionStats.detectedFrames += detected ? 1 : 0;
+
+    if (detected && !cameraMatrix.empty())
+    {
+        ScopedStageTimer poseTimer(STAGE_POSE);
+        if (estimatePose(cameraMatrix, undistort ? Mat() : distCoeffs, rvec, tvec))
+        {
+            poses.push(sessionStats.frames, rvec, tvec);
+            sessionStats.posedFrames++;
+        }
+    }
+
+    long long latencyNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    sessionStats.latency.record(latencyNs);
+    sessionStats.busyMs += latencyNs / 1e6;
+    sessionStats.frames++;
+    return true;
+}
+
+ArucoStreamSession::ArucoStreamSession(const Ptr<FrameSource> &source, const Mat &cameraMatrix, const Mat &distCoeffs,
+                                       const StreamOptions &options, const aruco::DetectorParameters &detectorParams)
+    : StreamSession(source, cameraMatrix, distCoeffs, options)
+{
+    tracker.setDetectorParameters(detectorParams);
+    tracker.setRoiTracking(options.roiTracking, options.fullSearchInterval);
+}
+
+bool ArucoStreamSession::detect(FrameContext &context)
+{
+    return tracker.detect(context.image()) > 0;
+}
+
+bool ArucoStreamSession::estimatePose(const Mat &cameraMatrix, const Mat &distCoeffs, Mat &rvec, Mat &tvec)
+{
+    return estimator.estimateBoard(tracker.board(), tracker.corners(), tracker.ids(), cameraMatrix, distCoeffs, rvec,
+                                   tvec);
+}
+
+// Same board as the single-stream chessboard loop
+static const Size streamChessboardPattern(9, 6);
+static const float streamChessboardSquareSize = 25; // in mm
+
+ChessboardStreamSession::ChessboardStreamSession(const Ptr<FrameSource> &source, const Mat &cameraMatrix,
+                                                 const Mat &distCoeffs, const StreamOptions &options)
+    : StreamSession(source, cameraMatrix, distCoeffs, options),
+      tracker(streamChessboardPattern, options.chessboardRedetectInterval)
+{
+    for (int i = 0; i < streamChessboardPattern.height; i++)
+    {
+        for (int j = 0; j < streamChessboardPattern.width; j++)
+        {
+            boardPoints.push_back(Point3f(j * streamChessboardSquareSize, i * streamChessboardSquareSize, 0));
+        }
+    }
+}
+
+bool ChessboardStreamSession::detect(FrameContext &context)
+{
+    return tracker.process(context, corners);
+}
+
+bool ChessboardStreamSession::estimatePose(const Mat &cameraMatrix, const Mat &distCoeffs, Mat &rvec, Mat &tvec)
+{
+    return estimator.estimate(boardPoints, corners, cameraMatrix, distCoeffs, rvec, tvec);
+}
+
+HarrisStreamSession::HarrisStreamSession(const Ptr<FrameSource> &source, const Mat &cameraMatrix,
+                                         const Mat &distCoeffs, const StreamOptions &options)
+    : StreamSession(source, cameraMatrix, distCoeffs, options)
+{
+}
+
+bool HarrisStreamSession::detect(FrameContext &context)
+{
+    extractor.detect(context.gray(), frameKeypoints);
+    return !frameKeypoints.empty();
+}
+
+Ptr<StreamSession> createStreamSession(const Ptr<FrameSource> &source, const Mat &cameraMatrix,
+                                       const Mat &distCoeffs, const StreamOptions &options,
+                                       const aruco::DetectorParameters &detectorParams)
+{
+    if (options.detector == "aruco")
+    {
+        return makePtr<ArucoStreamSession>(source, cameraMatrix, distCoeffs, options, detectorParams);
+    }
+    if (options.detector == "chessboard")
+    {
+        return makePtr<ChessboardStreamSession>(source, cameraMatrix, distCoeffs, options);
+    }
+    if (options.detector == "harris")
+    {
+        return makePtr<HarrisStreamSession>(source, cameraMatrix, distCoeffs, options);
+    }
+    return Ptr<StreamSession>();
+}
+
+// Set by Ctrl+C during a multi-stream run, so camera streams that never run out can still be stopped and reported
+static atomic<bool> multiStreamStopRequested(false);
+
+static void requestMultiStreamStop(int)
+{
+    multiStreamStopRequested = true;
+    // A second Ctrl+C terminates as usual, in case a source blocks in read()
+    signal(SIGINT, SIG_DFL);
+}
+
+/**
+ * @brief "poses.csv" -> "poses_2.csv"
+ */
+static string streamFileName(const string &filename, size_t index)
+{
+    size_t dot = filename.find_last_of('.');
+    size_t slash = filename.find_last_of("/\\");
+    if (dot == string::npos || (slash != string::npos && dot < slash))
+    {
+        dot = filename.size();
+    }
+    return filename.substr(0, dot) + "_" + to_string(index) + filename.substr(dot);
+}
+
+double runStreamSessions(const vector<Ptr<StreamSession>> &sessions, ThreadPool &pool, const atomic<bool> &stop,
+                         vector<double> &finishedSeconds)
+{
+    // Sessions waiting for their next frame, longest waiting first. Every index in the queue has exactly one turn
+    // task submitted for it and a turn always runs the front session, so the sessions take frames round-robin however
+    // the pool orders the tasks (a worker's own deque is LIFO, which would otherwise keep re-running one session)
+    mutex readyLock;
+    deque<size_t> ready;
+    finishedSeconds.assign(sessions.size(), 0);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    function<void()> takeTurn = [&]() {
+        size_t index;
+        {
+            lock_guard<mutex> guard(readyLock);
+            index = ready.front();
+            ready.pop_front();
+        }
+        if (!stop.load() && sessions[index]->processNextFrame())
+        {
+            {
+                lock_guard<mutex> guard(readyLock);
+                ready.push_back(index);
+            }
+            pool.submit([&takeTurn]() { takeTurn(); });
+        }
+        else
+        {
+            finishedSeconds[index] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+    };
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        {
+            lock_guard<mutex> guard(readyLock);
+            ready.push_back(i);
+        }
+        pool.submit([&takeTurn]() { takeTurn(); });
+    }
+    pool.wait();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int multiStreamDetection(const vector<string> &sources, const StreamOptions &options)
+{
+    if (sources.empty())
+    {
+        LOG_ERROR("No sources given for the multi-stream mode");
+        return -1;
+    }
+
+    CalibrationData calibration;
+    if (!options.calibrationFile.empty() && !loadCalibration(options.calibrationFile, calibration))
+    {
+        return -1;
+    }
+
+    // Loaded once and copied into every session's tracker
+    aruco::DetectorParameters detectorParams;
+    if (!options.detectorParamsFile.empty())
+    {
+        if (options.detector != "aruco")
+        {
+            LOG_WARN("--detector-params only applies to --detector aruco; ignored");
+        }
+        else if (!loadDetectorParameters(options.detectorParamsFile, detectorParams))
+        {
+            return -1;
+        }
+        else
+        {
+            LOG_INFO("Utilizing detector parameters file: " << options.detectorParamsFile);
+        }
+    }
+
+    vector<Ptr<StreamSession>> sessions;
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        Ptr<FrameSource> source = openFrameSource(sources[i]);
+        if (!source->isOpened())
+        {
+            LOG_ERROR("Error opening frame source: " << source->describe());
+            return -1;
+        }
+        Ptr<StreamSession> session = createStreamSession(source, calibration.cameraMatrix, calibration.distCoeffs,
+                                                         options, detectorParams);
+        if (!session)
+        {
+            LOG_ERROR("Unknown detector for the multi-stream mode: " << options.detector);
+            return -1;
+        }
+        sessions.push_back(session);
+        if (!options.poseLog.empty() && !sessions.back()->streamPosesTo(streamFileName(options.poseLog, i)))
+        {
+            return -1;
+        }
+    }
+
+    ThreadPool pool(options.workers, options.pinThreads);
+    // The streams are the parallelism; OpenCV's own threads would only compete with the pool for the same cores
+    int openCvThreads = getNumThreads();
+    setNumThreads(1);
+    LOG_INFO("Running " << sessions.size() << " " << options.detector << " streams on " << pool.size() << " workers"
+             << (options.pinThreads ? " pinned to cores" : "") << "; Ctrl+C stops and reports");
+
+    multiStreamStopRequested = false;
+    void (*previousHandler)(int) = signal(SIGINT, requestMultiStreamStop);
+    vector<double> finishedSeconds;
+    double elapsedSeconds = runStreamSessions(sessions, pool, multiStreamStopRequested, finishedSeconds);
+    signal(SIGINT, previousHandler == SIG_ERR ? SIG_DFL : previousHandler);
+    setNumThreads(openCvThreads);
+    if (multiStreamStopRequested)
+    {
+        LOG_INFO("Stopped by Ctrl+C after the frames in progress finished");
+    }
+
+    long long totalFrames = 0;
+    double totalBusyMs = 0;
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        const StreamSession &session = *sessions[i];
+        session.stats().report("Stream " + to_string(i) + " (" + session.frameSource().describe() + ")",
+                               finishedSeconds[i]);
+        totalFrames += session.stats().frames;
+        totalBusyMs += session.stats().busyMs;
+    }
+    // Busy time over wall time: how many cores the streams kept busy on average
+    LOG_INFO("All streams: " << totalFrames << " frames in " << elapsedSeconds << " s ("
+             << (elapsedSeconds > 0 ? totalFrames / elapsedSeconds : 0.0) << " fps), "
+             << (elapsedSeconds > 0 ? totalBusyMs / 1000.0 / elapsedSeconds : 0.0) << " of " << pool.size()
+             << " workers busy on average");
+    reportSessionMemory();
+    finishStageTimes("Multi-stream detection", options.statsFile);
+    return 0;
+}
@@ -0,0 +1,177 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Work-stealing thread pool for batch jobs (one task queue per worker, idle workers steal)
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <exception>
+
+#include "logger.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+// Pool and worker index of the calling thread, so submit() can use the worker's own deque
+static thread_local const ThreadPool *currentPool = 0;
+static thread_local int currentIndex = -1;
+
+ThreadPool::ThreadPool(int threads, bool pinThreads) : queued(0), pending(0), stolen(0), nextQueue(0), stopping(false)
+{
+    if (threads <= 0)
+    {
+        threads = max(1, (int)thread::hardware_concurrency());
+    }
+    for (int i = 0; i < threads; i++)
+    {
+        queues.push_back(unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    for (int i = 0; i < threads; i++)
+    {
+        workers.push_back(thread(&ThreadPool::workerLoop, this, i));
+        if (pinThreads)
+        {
+            pinWorker(i);
+        }
+    }
+}
+
+void ThreadPool::pinWorker(int index)
+{
+#ifdef __linux__
+    int cores = max(1, (int)thread::hardware_concurrency());
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(index % cores, &cpus);
+    if (pthread_setaffinity_np(workers[index].native_handle(), sizeof(cpus), &cpus) != 0)
+    {
+        LOG_WARN("Could not pin worker " << index << " to core " << index % cores);
+    }
+#else
+    if (index == 0)
+    {
+        LOG_WARN("Thread pinning is only supported on Linux; workers are not pinned");
+    }
+#endif
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+}
+
+int ThreadPool::currentWorker() const
+{
+    return currentPool == this ? currentIndex : -1;
+}
+
+void ThreadPool::submit(const function<void()> &task)
+{
+    int target = currentWorker();
+    if (target < 0)
+    {
+        target = (int)(nextQueue++ % queues.size());
+    }
+
+    pending++;
+    {
+        lock_guard<mutex> guard(queues[target]->lock);
+        queues[target]->tasks.push_back(task);
+    }
+    queued++;
+
+    // Taking the sleep lock orders this notify after a worker's check of queued, so the wake-up cannot be missed
+    {
+        lock_guard<mutex> guard(sleepLock);
+    }
+    wakeUp.notify_one();
+}
+
+bool ThreadPool::takeTask(int worker, function<void()> &task)
+{
+    {
+        WorkerQueue &own = *queues[worker];
+        lock_guard<mutex> guard(own.lock);
+        if (!own.tasks.empty())
+        {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < queues.size(); offset++)
+    {
+        WorkerQueue &victim = *queues[(worker + offset) % queues.size()];
+        lock_guard<mutex> guard(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            queued--;
+            stolen++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(int index)
+{
+    currentPool = this;
+    currentIndex = index;
+
+    function<void()> task;
+    while (true)
+    {
+        if (takeTask(index, task))
+        {
+            // A throwing task (e.g. a cv::Exception on a corrupt image) must neither kill the worker nor leave
+            // pending counted, or wait() would never return
+            try
+            {
+                task();
+            }
+            catch (const exception &e)
+            {
+                LOG_ERROR("Thread pool task failed: " << e.what());
+            }
+            catch (...)
+            {
+                LOG_ERROR("Thread pool task failed with an unknown exception");
+            }
+            task = function<void()>();
+            if (--pending == 0)
+            {
+                lock_guard<mutex> guard(sleepLock);
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        unique_lock<mutex> guard(sleepLock);
+        wakeUp.wait(guard, [this]() { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0)
+        {
+            return;
+        }
+    }
+}
+
+void ThreadPool::wait()
+{
+    unique_lock<mutex> guard(sleepLock);
+    allDone.wait(guard, [this]() { return pending.load() == 0; });
+}
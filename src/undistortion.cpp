@@ -0,0 +1,234 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Cached fixed-point undistortion maps, built once per calibration and frame size and applied in parallel
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#include "logger.h"
+#include "undistortion.h"
+
+using namespace std;
+using namespace cv;
+
+static const char undistortMagic[8] = {'A', 'R', 'U', 'N', 'D', 'I', 'S', 'T'};
+static const uint32_t undistortCacheVersion = 1;
+
+/**
+ * @brief Fixed header of a map cache file, followed by the raw map1 and map2 rows
+ */
+struct UndistortCacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    uint32_t reserved;
+    uint64_t fingerprint;
+};
+
+/**
+ * @brief Milliseconds elapsed since start
+ */
+static double millisecondsSince(const chrono::steady_clock::time_point &start)
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief FNV-1a over bytes, continuing from hash
+ */
+static uint64_t hashBytes(uint64_t hash, const void *bytes, size_t count)
+{
+    const unsigned char *data = (const unsigned char *)bytes;
+    for (size_t i = 0; i < count; i++)
+    {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Identifies a calibration and frame size, so maps are never reused for another one
+ */
+static uint64_t calibrationFingerprint(const Mat &cameraMatrix, const Mat &distCoeffs, const Size &imageSize)
+{
+    Mat matrix, distortion;
+    cameraMatrix.convertTo(matrix, CV_64F);
+    uint64_t hash = 14695981039346656037ULL;
+    hash = hashBytes(hash, matrix.reshape(1, 1).clone().ptr(), 9 * sizeof(double));
+    if (!distCoeffs.empty())
+    {
+        distCoeffs.convertTo(distortion, CV_64F);
+        distortion = distortion.reshape(1, 1).clone();
+        hash = hashBytes(hash, distortion.ptr(), distortion.total() * sizeof(double));
+    }
+    hash = hashBytes(hash, &imageSize.width, sizeof(imageSize.width));
+    hash = hashBytes(hash, &imageSize.height, sizeof(imageSize.height));
+    return hash;
+}
+
+UndistortMaps::UndistortMaps() : fingerprint(0)
+{
+}
+
+void UndistortMaps::build(const Mat &cameraMatrix, const Mat &distCoeffs, const Size &imageSize)
+{
+    initUndistortRectifyMap(cameraMatrix, distCoeffs, Mat(), cameraMatrix, imageSize, CV_16SC2, map1, map2);
+    cameraMatrix.convertTo(mapCameraMatrix, CV_64F);
+    distCoeffs.convertTo(mapDistCoeffs, CV_64F);
+    this->imageSize = imageSize;
+    fingerprint = calibrationFingerprint(cameraMatrix, distCoeffs, imageSize);
+}
+
+bool UndistortMaps::matches(const Mat &cameraMatrix, const Mat &distCoeffs, const Size &imageSize) const
+{
+    return !empty() && this->imageSize == imageSize &&
+           fingerprint == calibrationFingerprint(cameraMatrix, distCoeffs, imageSize);
+}
+
+bool UndistortMaps::load(const string &filename, const Mat &cameraMatrix, const Mat &distCoeffs,
+                         const Size &imageSize)
+{
+    ifstream file(filename.c_str(), ios::binary);
+    UndistortCacheHeader header;
+    if (!file.read((char *)&header, sizeof(header)))
+    {
+        return false;
+    }
+    uint64_t expected = calibrationFingerprint(cameraMatrix, distCoeffs, imageSize);
+    if (memcmp(header.magic, undistortMagic, sizeof(undistortMagic)) != 0 || header.version != undistortCacheVersion ||
+        header.width != imageSize.width || header.height != imageSize.height || header.fingerprint != expected)
+    {
+        return false;
+    }
+
+    Mat loadedMap1(imageSize, CV_16SC2), loadedMap2(imageSize, CV_16UC1);
+    if (!file.read((char *)loadedMap1.ptr(), loadedMap1.total() * loadedMap1.elemSize()) ||
+        !file.read((char *)loadedMap2.ptr(), loadedMap2.total() * loadedMap2.elemSize()))
+    {
+        return false;
+    }
+    map1 = loadedMap1;
+    map2 = loadedMap2;
+    cameraMatrix.convertTo(mapCameraMatrix, CV_64F);
+    distCoeffs.convertTo(mapDistCoeffs, CV_64F);
+    this->imageSize = imageSize;
+    fingerprint = expected;
+    return true;
+}
+
+void UndistortMaps::distortPoints(const vector<Point2f> &undistorted, vector<Point2f> &raw) const
+{
+    raw.clear();
+    if (undistorted.empty() || mapCameraMatrix.empty())
+    {
+        raw = undistorted;
+        return;
+    }
+    // The undistorted frame keeps the camera matrix, so K^-1 gives the ideal ray and projectPoints re-applies the
+    // same lens model the maps were built from
+    Matx33d inverse = Matx33d(mapCameraMatrix).inv();
+    vector<Point3d> rays;
+    rays.reserve(undistorted.size());
+    for (size_t i = 0; i < undistorted.size(); i++)
+    {
+        Vec3d ray = inverse * Vec3d(undistorted[i].x, undistorted[i].y, 1);
+        rays.push_back(Point3d(ray[0] / ray[2], ray[1] / ray[2], 1));
+    }
+    vector<Point2d> projected;
+    projectPoints(rays, Vec3d(0, 0, 0), Vec3d(0, 0, 0), mapCameraMatrix, mapDistCoeffs, projected);
+    raw.reserve(projected.size());
+    for (size_t i = 0; i < projected.size(); i++)
+    {
+        raw.push_back(Point2f((float)projected[i].x, (float)projected[i].y));
+    }
+}
+
+bool UndistortMaps::save(const string &filename) const
+{
+    if (empty())
+    {
+        return false;
+    }
+    UndistortCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, undistortMagic, sizeof(undistortMagic));
+    header.version = undistortCacheVersion;
+    header.width = imageSize.width;
+    header.height = imageSize.height;
+    header.fingerprint = fingerprint;
+
+    // initUndistortRectifyMap allocates continuous maps, so each is written in one block
+    ofstream file(filename.c_str(), ios::binary | ios::trunc);
+    file.write((const char *)&header, sizeof(header));
+    file.write((const char *)map1.ptr(), map1.total() * map1.elemSize());
+    file.write((const char *)map2.ptr(), map2.total() * map2.elemSize());
+    return (bool)file;
+}
+
+void UndistortMaps::apply(const Mat &frame, Mat &undistorted) const
+{
+    CV_Assert(frame.size() == imageSize);
+    undistorted.create(frame.size(), frame.type());
+
+    // Each band reads anywhere in the source but writes only its own rows
+    int bands = max(1, getNumThreads());
+    int rows = imageSize.height;
+    parallel_for_(Range(0, bands), [&](const Range &range) {
+        for (int band = range.start; band < range.end; band++)
+        {
+            int first = rows * band / bands;
+            int last = rows * (band + 1) / bands;
+            if (last <= first)
+            {
+                continue;
+            }
+            Mat output = undistorted.rowRange(first, last);
+            remap(frame, output, map1.rowRange(first, last), map2.rowRange(first, last), INTER_LINEAR,
+                  BORDER_CONSTANT);
+        }
+    });
+}
+
+string undistortCachePath(const string &calibrationFile, const Size &imageSize)
+{
+    return calibrationFile + ".undistort-" + to_string(imageSize.width) + "x" + to_string(imageSize.height) + ".bin";
+}
+
+Ptr<UndistortMaps> loadOrBuildUndistortMaps(const Mat &cameraMatrix, const Mat &distCoeffs, const Size &imageSize,
+                                            const string &calibrationFile)
+{
+    Ptr<UndistortMaps> maps = makePtr<UndistortMaps>();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    string cacheFile = calibrationFile.empty() ? "" : undistortCachePath(calibrationFile, imageSize);
+    if (!cacheFile.empty() && maps->load(cacheFile, cameraMatrix, distCoeffs, imageSize))
+    {
+        LOG_INFO("Undistortion maps loaded from " << cacheFile << " in " << millisecondsSince(start) << " ms");
+        return maps;
+    }
+
+    maps->build(cameraMatrix, distCoeffs, imageSize);
+    LOG_INFO("Undistortion maps built for " << imageSize << " in " << millisecondsSince(start) << " ms");
+    if (!cacheFile.empty() && maps->save(cacheFile))
+    {
+        LOG_INFO("Undistortion maps cached in " << cacheFile);
+    }
+    return maps;
+}
+
+/**
+ * @brief Prints the mean and worst undistortion cost per frame
+ */
+void UndistortTiming::report() const
+{
+    if (frames == 0)
+    {
+        return;
+    }
+    LOG_INFO("Undistortion: " << frames << " frames, mean " << totalMs / frames << " ms, max " << maxMs
+             << " ms per frame");
+}
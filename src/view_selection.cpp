@@ -0,0 +1,164 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Picks a bounded, pose-diverse subset of calibration views so solve time does not grow with capture count
+
+#include <algorithm>
+#include <cfloat>
+#include <opencv2/opencv.hpp>
+
+#include "view_selection.h"
+
+using namespace std;
+using namespace cv;
+
+static const int coverageGrid = 8;
+
+// Tilt is what constrains the focal length, so it counts double in the pose distance
+static const float tiltWeight = 2.0f;
+
+// A view that covers every cell nobody covers yet is worth as much as this much pose distance
+static const float coverageWeight = 0.5f;
+
+/**
+ * @brief Number of set bits
+ */
+static int countBits(unsigned long long bits)
+{
+    int count = 0;
+    while (bits)
+    {
+        bits &= bits - 1;
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Weighted distance between the poses of two views
+ */
+static float poseDistance(const ViewFeatures &a, const ViewFeatures &b)
+{
+    Point2f center = a.center - b.center;
+    Point2f tilt = (a.tilt - b.tilt) * tiltWeight;
+    float scale = a.scale - b.scale;
+    return sqrt(center.dot(center) + tilt.dot(tilt) + scale * scale);
+}
+
+ViewFeatures measureView(const vector<Point3f> &objectPoints, const vector<Point2f> &imagePoints,
+                         const Size &imageSize)
+{
+    ViewFeatures features;
+    if (objectPoints.size() < 4 || objectPoints.size() != imagePoints.size() || imageSize.area() == 0)
+    {
+        return features;
+    }
+
+    vector<Point2f> planePoints(objectPoints.size());
+    Point2f planeMin(FLT_MAX, FLT_MAX), planeMax(-FLT_MAX, -FLT_MAX);
+    for (size_t i = 0; i < objectPoints.size(); i++)
+    {
+        planePoints[i] = Point2f(objectPoints[i].x, objectPoints[i].y);
+        planeMin.x = min(planeMin.x, planePoints[i].x);
+        planeMin.y = min(planeMin.y, planePoints[i].y);
+        planeMax.x = max(planeMax.x, planePoints[i].x);
+        planeMax.y = max(planeMax.y, planePoints[i].y);
+    }
+
+    Mat homography = findHomography(planePoints, imagePoints, 0);
+    if (homography.empty() || fabs(homography.at<double>(2, 2)) < DBL_EPSILON)
+    {
+        return features;
+    }
+
+    // H ~ K [r1 r2 t]: its last row is (r1.z, r2.z, t.z), so row / t.z times the board size is the relative depth
+    // change across the board, independent of the intrinsics
+    double depth = homography.at<double>(2, 2);
+    features.tilt = Point2f((float)(homography.at<double>(2, 0) / depth * (planeMax.x - planeMin.x)),
+                            (float)(homography.at<double>(2, 1) / depth * (planeMax.y - planeMin.y)));
+
+    vector<Point2f> hull;
+    convexHull(imagePoints, hull);
+    features.scale = (float)sqrt(contourArea(hull) / imageSize.area());
+
+    Point2f sum(0, 0);
+    for (size_t i = 0; i < imagePoints.size(); i++)
+    {
+        sum += imagePoints[i];
+        int cellX = min(coverageGrid - 1, max(0, (int)(imagePoints[i].x * coverageGrid / imageSize.width)));
+        int cellY = min(coverageGrid - 1, max(0, (int)(imagePoints[i].y * coverageGrid / imageSize.height)));
+        features.coverage |= 1ULL << (cellY * coverageGrid + cellX);
+    }
+    float count = (float)imagePoints.size();
+    features.center = Point2f(sum.x / count / imageSize.width, sum.y / count / imageSize.height);
+    features.valid = true;
+    return features;
+}
+
+vector<int> selectDiverseViews(const vector<vector<Point3f>> &objectPoints, const vector<vector<Point2f>> &imagePoints,
+                               const Size &imageSize, int maxViews)
+{
+    int viewCount = (int)min(objectPoints.size(), imagePoints.size());
+    vector<int> selected;
+    if (maxViews <= 0 || viewCount <= maxViews)
+    {
+        for (int i = 0; i < viewCount; i++)
+        {
+            selected.push_back(i);
+        }
+        return selected;
+    }
+
+    vector<ViewFeatures> features(viewCount);
+    int first = -1;
+    int firstCells = -1;
+    for (int i = 0; i < viewCount; i++)
+    {
+        features[i] = measureView(objectPoints[i], imagePoints[i], imageSize);
+        int cells = countBits(features[i].coverage);
+        if (features[i].valid && cells > firstCells)
+        {
+            first = i;
+            firstCells = cells;
+        }
+    }
+    if (first < 0)
+    {
+        return selected;
+    }
+
+    vector<float> nearest(viewCount, FLT_MAX);
+    vector<bool> taken(viewCount, false);
+    unsigned long long covered = 0;
+    int next = first;
+    while (next >= 0)
+    {
+        selected.push_back(next);
+        taken[next] = true;
+        covered |= features[next].coverage;
+        if ((int)selected.size() == maxViews)
+        {
+            break;
+        }
+
+        next = -1;
+        float bestScore = -1;
+        for (int i = 0; i < viewCount; i++)
+        {
+            if (taken[i] || !features[i].valid)
+            {
+                continue;
+            }
+            nearest[i] = min(nearest[i], poseDistance(features[i], features[selected.back()]));
+            int newCells = countBits(features[i].coverage & ~covered);
+            float score = nearest[i] + coverageWeight * newCells / (coverageGrid * coverageGrid);
+            if (score > bestScore)
+            {
+                bestScore = score;
+                next = i;
+            }
+        }
+    }
+
+    sort(selected.begin(), selected.end());
+    return selected;
+}
@@ -0,0 +1,141 @@
+// Author: Kevin Heleodoro
+// Date: October 16, 2026
+// Purpose: Correctness checks for the multi-stream scheduler (make test)
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#include "../include/frame_source.h"
+#include "../include/stream_session.h"
+#include "../include/thread_pool.h"
+
+using namespace std;
+using namespace cv;
+
+/**
+ * @brief In-memory frames that raise a shared flag once they run out, so a run can be stopped the moment the first
+ * stream is exhausted
+ */
+class StopAtEndFrameSource : public FrameSource
+{
+  public:
+    StopAtEndFrameSource(const vector<Mat> &frames, atomic<bool> &exhausted)
+        : frames(frames), exhausted(exhausted), nextIndex(0)
+    {
+    }
+
+    bool read(Mat &frame)
+    {
+        if (nextIndex >= frames.size())
+        {
+            exhausted = true;
+            return false;
+        }
+        frame = frames[nextIndex++];
+        return true;
+    }
+
+    bool isOpened() const
+    {
+        return !frames.empty();
+    }
+
+    string describe() const
+    {
+        return "memory (" + to_string(frames.size()) + " frames)";
+    }
+
+  private:
+    vector<Mat> frames;
+    atomic<bool> &exhausted;
+    size_t nextIndex;
+};
+
+/**
+ * @brief Decodes the ArUco calibration images of the repo's img directory
+ */
+static vector<Mat> loadArucoImages(const string &imageRoot)
+{
+    ImageDirectoryFrameSource listing(imageRoot + "/CameraCalibration");
+    vector<Mat> images;
+    for (size_t i = 0; i < listing.files().size(); i++)
+    {
+        const string &file = listing.files()[i];
+        if (file.find("_calibration_image") == string::npos)
+        {
+            continue;
+        }
+        Mat image = imread(file, IMREAD_COLOR);
+        if (!image.empty())
+        {
+            images.push_back(image);
+        }
+    }
+    return images;
+}
+
+/**
+ * @brief Runs more multi-stream sessions than pool workers over equally long sources and stops when the first one
+ * runs out. With fair scheduling every other stream is then close to the end as well; a starved stream is not.
+ *
+ * @return false if a stream made less than half the progress of the first one to finish
+ */
+static bool checkMultiStreamFairness(const vector<Mat> &images)
+{
+    const int workers = 2, streams = 6;
+    atomic<bool> exhausted(false);
+    vector<Ptr<StreamSession>> sessions;
+    for (int i = 0; i < streams; i++)
+    {
+        sessions.push_back(makePtr<ArucoStreamSession>(makePtr<StopAtEndFrameSource>(images, exhausted), Mat(), Mat(),
+                                                       StreamOptions()));
+    }
+    ThreadPool pool(workers);
+    vector<double> finishedSeconds;
+    runStreamSessions(sessions, pool, exhausted, finishedSeconds);
+
+    long long fewest = sessions[0]->stats().frames;
+    for (size_t i = 1; i < sessions.size(); i++)
+    {
+        fewest = min(fewest, sessions[i]->stats().frames);
+    }
+    bool fair = fewest * 2 >= (long long)images.size();
+    cout << "Multi-stream fairness (" << streams << " streams on " << workers << " workers, " << images.size()
+         << " frames each): slowest stream at frame " << fewest << (fair ? "" : "  STARVED") << endl;
+    return fair;
+}
+
+int main(int argc, char *argv[])
+{
+    string imageRoot = "img";
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--img" && i + 1 < argc)
+        {
+            imageRoot = argv[++i];
+        }
+        else
+        {
+            cout << "Usage: stream_session_test.exe [--img <dir>]" << endl;
+            return -1;
+        }
+    }
+
+    vector<Mat> images = loadArucoImages(imageRoot);
+    if (images.empty())
+    {
+        cerr << "No ArUco images under " << imageRoot << "/CameraCalibration" << endl;
+        return -1;
+    }
+
+    int failures = 0;
+    if (!checkMultiStreamFairness(images))
+    {
+        failures++;
+    }
+    cout << (failures ? to_string(failures) + " check(s) failed" : string("All checks passed")) << endl;
+    return failures ? 1 : 0;
+}